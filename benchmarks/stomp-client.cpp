@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <cstdint>
+#include <network-monitor/stomp-client.hpp>
+#include <network-monitor/stomp-frame-builder.hpp>
+#include <string>
+
+#include "websocket-client-mock.hpp"
+
+using NetworkMonitor::StompClient;
+using NetworkMonitor::StompClientError;
+using NetworkMonitor::WebSocketClientMock;
+using NetworkMonitor::WebSocketClientMockForStomp;
+
+// Arguments: body size. Each iteration dispatches a batch of MESSAGE frames, from the
+// mocked WebSocket client to the subscriber callback.
+static void StompClientDispatchMessages(benchmark::State& state)
+{
+    constexpr std::size_t messages_per_batch{64};
+
+    WebSocketClientMock::connect_error_code = {};
+    WebSocketClientMock::send_error_code = {};
+    WebSocketClientMock::close_error_code = {};
+    WebSocketClientMock::message_queue = {};
+    WebSocketClientMock::trigger_disconnection = false;
+    WebSocketClientMockForStomp::username = "username";
+    WebSocketClientMockForStomp::password = "password";
+    WebSocketClientMockForStomp::endpoint = "/passengers";
+    WebSocketClientMockForStomp::heart_beat = {};
+
+    boost::asio::io_context io_context{};
+    boost::asio::ssl::context tls_context{boost::asio::ssl::context::tlsv12_client};
+    StompClient<WebSocketClientMockForStomp> client{
+        "ltnm.learncppthroughprojects.com", "/network-events", "443", io_context,
+        tls_context};
+
+    bool subscribed{false};
+    std::string subscription_id{};
+    std::size_t received{0};
+    client.Connect("username", "password", [&](auto result) {
+        if (result != StompClientError::Ok) {
+            return;
+        }
+        subscription_id = client.Subscribe(
+            "/passengers",
+            [&subscribed](auto result, auto&& id) {
+                subscribed = result == StompClientError::Ok;
+            },
+            [&received](auto result, auto&& message) { ++received; });
+    });
+
+    // The mocked connection polls its message queue for as long as it is open, so the
+    // loop only runs out of work if the connection failed.
+    const auto run_until{[&io_context](const auto& done) {
+        while (!done()) {
+            if (io_context.run_one() == 0) {
+                return false;
+            }
+        }
+        return true;
+    }};
+    if (!run_until([&subscribed]() { return subscribed; })) {
+        state.SkipWithError("Could not subscribe");
+        return;
+    }
+
+    const auto message{NetworkMonitor::stomp_frame::MakeMessageFrame(
+                           "/passengers", "1", subscription_id, "",
+                           std::string(static_cast<std::size_t>(state.range(0)), 'x'), "",
+                           "application/json")
+                           .ToString()};
+    for (auto _ : state) {
+        for (std::size_t index = 0; index < messages_per_batch; index++) {
+            WebSocketClientMock::message_queue.push(message);
+        }
+        const auto expected{received + messages_per_batch};
+        if (!run_until([&received, expected]() { return received == expected; })) {
+            state.SkipWithError("Connection lost");
+            break;
+        }
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                            static_cast<std::int64_t>(messages_per_batch));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                            static_cast<std::int64_t>(messages_per_batch) *
+                            static_cast<std::int64_t>(message.size()));
+
+    client.Close();
+    io_context.run();
+}
+BENCHMARK(StompClientDispatchMessages)->Arg(92)->Arg(4 << 10)->UseRealTime();
@@ -0,0 +1,148 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <network-monitor/stomp-frame-builder.hpp>
+#include <network-monitor/stomp-frame-pool.hpp>
+#include <network-monitor/stomp-frame.hpp>
+#include <string>
+
+using NetworkMonitor::StompCommand;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompFramePool;
+using NetworkMonitor::StompHeader;
+
+using namespace std::string_literals;
+
+namespace {
+
+// A typical frame pushed by the live network feed.
+const std::string& GetMessageFrame()
+{
+    static const auto frame{
+        "MESSAGE\n"
+        "subscription:0\n"
+        "message-id:a1b2c3d4-0001\n"
+        "destination:/passengers\n"
+        "content-type:application/json\n"
+        "content-length:92\n"
+        "\n"
+        "{\"datetime\":\"2020-11-01T07:18:50.234000Z\",\"passenger_event\":\"in\","
+        "\"station_id\":\"station_211\"}\0"s};
+    return frame;
+}
+
+// A MESSAGE frame with a body of `body_size` bytes, with or without content-length.
+std::string MakeMessageFrame(std::size_t body_size, bool with_content_length)
+{
+    std::string frame{
+        "MESSAGE\n"
+        "subscription:0\n"
+        "message-id:a1b2c3d4-0001\n"
+        "destination:/passengers\n"
+        "content-type:application/json\n"};
+    if (with_content_length) {
+        frame += "content-length:" + std::to_string(body_size) + "\n";
+    }
+    frame += "\n";
+    frame.append(body_size, 'x');
+    frame.push_back('\0');
+    return frame;
+}
+
+}  // namespace
+
+static void ParseStompFrame(benchmark::State& state)
+{
+    const auto& plain{GetMessageFrame()};
+    for (auto _ : state) {
+        StompError error{};
+        StompFrame frame{error, plain};
+        benchmark::DoNotOptimize(frame);
+    }
+}
+BENCHMARK(ParseStompFrame);
+
+static void ParseBorrowedStompFrame(benchmark::State& state)
+{
+    const auto& plain{GetMessageFrame()};
+    for (auto _ : state) {
+        StompError error{};
+        StompFrame frame{error, plain, StompFrame::borrowed_content};
+        benchmark::DoNotOptimize(frame);
+    }
+}
+BENCHMARK(ParseBorrowedStompFrame);
+
+// Arguments: body size, whether the frame has a content-length header.
+static void ParseBorrowedStompFrameBySize(benchmark::State& state)
+{
+    const auto plain{MakeMessageFrame(static_cast<std::size_t>(state.range(0)),
+                                      static_cast<bool>(state.range(1)))};
+    for (auto _ : state) {
+        StompError error{};
+        StompFrame frame{error, plain, StompFrame::borrowed_content};
+        benchmark::DoNotOptimize(frame);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                            static_cast<std::int64_t>(plain.size()));
+}
+BENCHMARK(ParseBorrowedStompFrameBySize)
+    ->ArgsProduct({benchmark::CreateRange(64, 64 << 10, 16), {0, 1}});
+
+static void BuildStompFrame(benchmark::State& state)
+{
+    const std::string destination{"/passengers"};
+    const std::string id{"a1b2c3d4-0001"};
+    const std::string body(static_cast<std::size_t>(state.range(0)), 'x');
+    for (auto _ : state) {
+        NetworkMonitor::stomp_frame::BuildParameters parameters{StompCommand::Send};
+        parameters.headers.emplace(StompHeader::Destination, destination);
+        parameters.headers.emplace(StompHeader::Receipt, id);
+        parameters.body = body;
+        StompError error{};
+        auto frame{NetworkMonitor::stomp_frame::Build(error, parameters)};
+        benchmark::DoNotOptimize(frame);
+    }
+}
+BENCHMARK(BuildStompFrame)->Arg(64)->Arg(4 << 10);
+
+static void StompFrameToString(benchmark::State& state)
+{
+    StompError error{};
+    const StompFrame frame{error, GetMessageFrame()};
+    for (auto _ : state) {
+        auto text{frame.ToString()};
+        benchmark::DoNotOptimize(text);
+    }
+}
+BENCHMARK(StompFrameToString);
+
+// Arguments: body size.
+static void StompFrameToStringBySize(benchmark::State& state)
+{
+    StompError error{};
+    const StompFrame frame{
+        error, MakeMessageFrame(static_cast<std::size_t>(state.range(0)), true)};
+    for (auto _ : state) {
+        auto text{frame.ToString()};
+        benchmark::DoNotOptimize(text);
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) *
+                            static_cast<std::int64_t>(frame.ToString().size()));
+}
+BENCHMARK(StompFrameToStringBySize)->RangeMultiplier(16)->Range(64, 64 << 10);
+
+static void AcquirePooledStompFrame(benchmark::State& state)
+{
+    StompFramePool pool{};
+    StompError error{};
+    const StompFrame frame{error, GetMessageFrame(), StompFrame::borrowed_content};
+    for (auto _ : state) {
+        auto pooled_frame{pool.Acquire(frame)};
+        benchmark::DoNotOptimize(pooled_frame);
+    }
+    const auto stats{pool.GetStats()};
+    state.counters["misses"] = static_cast<double>(stats.misses);
+}
+BENCHMARK(AcquirePooledStompFrame);
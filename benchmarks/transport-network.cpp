@@ -0,0 +1,262 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <network-monitor/file-downloader.hpp>
+#include <network-monitor/transport-network.hpp>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using NetworkMonitor::Id;
+using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::TransportNetwork;
+
+namespace {
+
+// The network layout is loaded once and shared by all benchmarks.
+const TransportNetwork& GetNetworkLayout()
+{
+    static const auto network{[]() {
+        TransportNetwork network{};
+        network.FromJson(NetworkMonitor::ParseJsonFile(BENCHMARKS_NETWORK_LAYOUT_JSON));
+        return network;
+    }()};
+    return network;
+}
+
+// A fixed, pseudo-random set of station pairs from the network layout.
+const std::vector<std::pair<Id, Id>>& GetStationPairs()
+{
+    static const auto station_pairs{[]() {
+        std::vector<Id> stations{};
+        const auto layout =
+            NetworkMonitor::ParseJsonFile(BENCHMARKS_NETWORK_LAYOUT_JSON);
+        for (const auto& station : layout.at("stations")) {
+            stations.push_back(station.at("station_id").get<Id>());
+        }
+
+        std::mt19937 generator{42};
+        std::uniform_int_distribution<std::size_t> distribution{0, stations.size() - 1};
+        std::vector<std::pair<Id, Id>> pairs{};
+        for (std::size_t index = 0; index < 1024; index++) {
+            pairs.emplace_back(stations[distribution(generator)],
+                               stations[distribution(generator)]);
+        }
+        return pairs;
+    }()};
+    return station_pairs;
+}
+
+// A burst of events from a few stations, as sent in a single STOMP message.
+const std::vector<PassengerEvent>& GetPassengerEventBurst()
+{
+    static const auto events{[]() {
+        const auto& station_pairs{GetStationPairs()};
+        std::mt19937 generator{42};
+        std::uniform_int_distribution<std::size_t> distribution{0, 15};
+        std::vector<PassengerEvent> events{};
+        for (std::size_t index = 0; index < 256; index++) {
+            const auto& [station_a, station_b] = station_pairs[distribution(generator)];
+            events.push_back({index % 2 == 0 ? station_a : station_b,
+                              index % 3 == 0 ? PassengerEvent::Type::Out
+                                             : PassengerEvent::Type::In});
+        }
+        return events;
+    }()};
+    return events;
+}
+
+// Two stops of a route, with the line and the route serving them.
+struct RouteStops {
+    Id line{};
+    Id route{};
+    Id station_a{};
+    Id station_b{};
+};
+
+// A fixed, pseudo-random set of stops along the routes of the network layout.
+const std::vector<RouteStops>& GetRouteStops()
+{
+    static const auto route_stops{[]() {
+        std::vector<RouteStops> routes{};
+        const auto layout =
+            NetworkMonitor::ParseJsonFile(BENCHMARKS_NETWORK_LAYOUT_JSON);
+        std::mt19937 generator{42};
+        for (const auto& line : layout.at("lines")) {
+            for (const auto& route : line.at("routes")) {
+                const auto& stops{route.at("route_stops")};
+                std::uniform_int_distribution<std::size_t> distribution{0,
+                                                                        stops.size() - 1};
+                for (std::size_t index = 0; index < 16; index++) {
+                    auto stop_a{distribution(generator)};
+                    auto stop_b{distribution(generator)};
+                    if (stop_b < stop_a) {
+                        std::swap(stop_a, stop_b);
+                    }
+                    routes.push_back({line.at("line_id").get<Id>(),
+                                      route.at("route_id").get<Id>(),
+                                      stops.at(stop_a).get<Id>(),
+                                      stops.at(stop_b).get<Id>()});
+                }
+            }
+        }
+        return routes;
+    }()};
+    return route_stops;
+}
+
+}  // namespace
+
+static void TransportNetworkGetFastestTravelRoute(benchmark::State& state)
+{
+    const auto& network{GetNetworkLayout()};
+    const auto& station_pairs{GetStationPairs()};
+    const auto line_change_penalty{static_cast<unsigned int>(state.range(0))};
+
+    std::size_t index{0};
+    for (auto _ : state) {
+        const auto& [station_a, station_b] =
+            station_pairs[index++ % station_pairs.size()];
+        benchmark::DoNotOptimize(
+            network.GetFastestTravelRoute(station_a, station_b, line_change_penalty));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TransportNetworkGetFastestTravelRoute)->Arg(0)->Arg(5);
+
+static void TransportNetworkFromJson(benchmark::State& state)
+{
+    for (auto _ : state) {
+        TransportNetwork network{};
+        benchmark::DoNotOptimize(network.FromJson(
+            NetworkMonitor::ParseJsonFile(BENCHMARKS_NETWORK_LAYOUT_JSON)));
+    }
+}
+BENCHMARK(TransportNetworkFromJson)->Unit(benchmark::kMillisecond);
+
+static void TransportNetworkFromJsonFile(benchmark::State& state)
+{
+    for (auto _ : state) {
+        TransportNetwork network{};
+        benchmark::DoNotOptimize(network.FromJsonFile(BENCHMARKS_NETWORK_LAYOUT_JSON));
+    }
+}
+BENCHMARK(TransportNetworkFromJsonFile)->Unit(benchmark::kMillisecond);
+
+static void TransportNetworkLoadSnapshot(benchmark::State& state)
+{
+    const auto snapshot{std::filesystem::temp_directory_path() /
+                        "network-layout-benchmark.snapshot"};
+    if (!GetNetworkLayout().SaveSnapshot(snapshot)) {
+        state.SkipWithError("Could not save the snapshot");
+        return;
+    }
+    for (auto _ : state) {
+        TransportNetwork network{};
+        benchmark::DoNotOptimize(network.LoadSnapshot(snapshot));
+    }
+    std::filesystem::remove(snapshot);
+}
+BENCHMARK(TransportNetworkLoadSnapshot)->Unit(benchmark::kMillisecond);
+
+// Passengers enter and leave stations of a network shared by all benchmark threads.
+static void TransportNetworkRecordPassengerEvent(benchmark::State& state)
+{
+    static TransportNetwork network{GetNetworkLayout()};
+    const auto& station_pairs{GetStationPairs()};
+    std::vector<TransportNetwork::StationHandle> stations{};
+    for (const auto& [station_a, station_b] : station_pairs) {
+        stations.push_back(network.GetStationHandle(station_a));
+        stations.push_back(network.GetStationHandle(station_b));
+    }
+
+    // Each thread starts from a different station.
+    std::size_t index{static_cast<std::size_t>(state.thread_index()) * 97};
+    for (auto _ : state) {
+        const auto station{stations[index++ % stations.size()]};
+        benchmark::DoNotOptimize(
+            network.RecordPassengerEvent(station, PassengerEvent::Type::In));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TransportNetworkRecordPassengerEvent)->ThreadRange(1, 8)->UseRealTime();
+
+static void TransportNetworkRecordPassengerEventBurst(benchmark::State& state)
+{
+    TransportNetwork network{GetNetworkLayout()};
+    const auto& events{GetPassengerEventBurst()};
+    for (auto _ : state) {
+        for (const auto& event : events) {
+            benchmark::DoNotOptimize(network.RecordPassengerEvent(event));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * events.size());
+}
+BENCHMARK(TransportNetworkRecordPassengerEventBurst);
+
+static void TransportNetworkRecordPassengerEvents(benchmark::State& state)
+{
+    TransportNetwork network{GetNetworkLayout()};
+    const auto& events{GetPassengerEventBurst()};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(network.RecordPassengerEvents(events));
+    }
+    state.SetItemsProcessed(state.iterations() * events.size());
+}
+BENCHMARK(TransportNetworkRecordPassengerEvents);
+
+static void TransportNetworkCopy(benchmark::State& state)
+{
+    const auto& network{GetNetworkLayout()};
+    for (auto _ : state) {
+        TransportNetwork copy{network};
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(TransportNetworkCopy);
+
+static void TransportNetworkGetTravelTime(benchmark::State& state)
+{
+    const auto& network{GetNetworkLayout()};
+    const auto& station_pairs{GetStationPairs()};
+
+    std::size_t index{0};
+    for (auto _ : state) {
+        const auto& [station_a, station_b] =
+            station_pairs[index++ % station_pairs.size()];
+        benchmark::DoNotOptimize(network.GetTravelTime(station_a, station_b));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TransportNetworkGetTravelTime);
+
+static void TransportNetworkGetRouteTravelTime(benchmark::State& state)
+{
+    const auto& network{GetNetworkLayout()};
+    const auto& route_stops{GetRouteStops()};
+
+    std::size_t index{0};
+    for (auto _ : state) {
+        const auto& [line, route, station_a, station_b] =
+            route_stops[index++ % route_stops.size()];
+        benchmark::DoNotOptimize(
+            network.GetTravelTime(line, route, station_a, station_b));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TransportNetworkGetRouteTravelTime);
+
+static void TransportNetworkGetRoutesServingStation(benchmark::State& state)
+{
+    const auto& network{GetNetworkLayout()};
+    const auto& station_pairs{GetStationPairs()};
+
+    std::size_t index{0};
+    for (auto _ : state) {
+        const auto& station{station_pairs[index++ % station_pairs.size()].first};
+        benchmark::DoNotOptimize(network.GetRoutesServingStation(station));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(TransportNetworkGetRoutesServingStation);
@@ -7,6 +7,10 @@ class ConanPackage(ConanFile):
 
     generators = 'cmake_find_package'
 
+    options = {
+        'benchmarks': [True, False],
+    }
+
     requires = [
         ('boost/1.80.0'),
         ('libcurl/7.85.0'),
@@ -16,5 +20,11 @@ class ConanPackage(ConanFile):
     ]
 
     default_options = (
+        'benchmarks=False',
         'boost:shared=False',
     )
+
+    def requirements(self):
+        # Only the benchmarks executable needs Google Benchmark.
+        if self.options.benchmarks:
+            self.requires('benchmark/1.7.1')
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief Array of values split in fixed-size chunks that copies of the array share.
+ *
+ *  Copying the array only copies one pointer per chunk. A shared chunk is copied the
+ *  first time one of the arrays changes a value in it, so changing a few values of a
+ *  copy only costs the chunks that hold them.
+ *
+ *  Reads can run concurrently with each other, and with changes to other copies of
+ *  the array. Changes to values of chunks that are not shared can run concurrently
+ *  with each other if `T` allows it, e.g. for atomics. A change to a shared chunk
+ *  must not run concurrently with any other access to the same array.
+ *
+ *  `T` must be default-constructible and copy-assignable.
+ */
+template <typename T>
+class CopyOnWriteChunks {
+   public:
+    /*! \brief Number of values in each chunk.
+     */
+    static constexpr std::size_t chunk_size{256};
+
+    /*! \brief Default constructor
+     */
+    CopyOnWriteChunks() = default;
+
+    /*! \brief Copy constructor
+     *
+     *  The copy shares all the chunks of the original.
+     */
+    CopyOnWriteChunks(const CopyOnWriteChunks& copied) = default;
+
+    /*! \brief Move constructor
+     *
+     *  The moved array is left empty.
+     */
+    CopyOnWriteChunks(CopyOnWriteChunks&& moved)
+        : chunks_{std::exchange(moved.chunks_, {})},
+          size_{std::exchange(moved.size_, 0)}
+    {
+    }
+
+    /*! \brief Copy assignment operator
+     */
+    CopyOnWriteChunks& operator=(const CopyOnWriteChunks& copied) = default;
+
+    /*! \brief Move assignment operator
+     *
+     *  The moved array is left empty.
+     */
+    CopyOnWriteChunks& operator=(CopyOnWriteChunks&& moved)
+    {
+        if (this != &moved) {
+            chunks_ = std::exchange(moved.chunks_, {});
+            size_ = std::exchange(moved.size_, 0);
+        }
+        return *this;
+    }
+
+    /*! \brief Get the number of values in the array.
+     */
+    std::size_t Size() const { return size_; }
+
+    /*! \brief Read a value.
+     */
+    const T& operator[](std::size_t index) const
+    {
+        return (*chunks_[index / chunk_size])[index % chunk_size];
+    }
+
+    /*! \brief Get a value to change it.
+     *
+     *  The chunk of the value is copied first if another array shares it.
+     */
+    T& Mutable(std::size_t index)
+    {
+        return MutableChunk(index / chunk_size)[index % chunk_size];
+    }
+
+    /*! \brief Add a value at the end of the array.
+     */
+    template <typename... Args>
+    void EmplaceBack(Args&&... args)
+    {
+        if (size_ % chunk_size == 0) {
+            chunks_.push_back(std::make_shared<Chunk>());
+        }
+        MutableChunk(chunks_.size() - 1)[size_ % chunk_size] =
+            T(std::forward<Args>(args)...);
+        size_++;
+    }
+
+    /*! \brief Add `count` copies of `value` at the end of the array.
+     */
+    void Append(std::size_t count, const T& value)
+    {
+        for (std::size_t added = 0; added < count; added++) {
+            EmplaceBack(value);
+        }
+    }
+
+    /*! \brief Copy all the chunks that another array shares.
+     *
+     *  Afterwards, changes to the array never copy a chunk.
+     */
+    void Unshare()
+    {
+        for (std::size_t chunk = 0; chunk < chunks_.size(); chunk++) {
+            MutableChunk(chunk);
+        }
+    }
+
+   private:
+    // The values past the end of the array are default-constructed.
+    using Chunk = std::array<T, chunk_size>;
+
+    Chunk& MutableChunk(std::size_t chunk)
+    {
+        auto& shared_chunk{chunks_[chunk]};
+        if (shared_chunk.use_count() > 1) {
+            shared_chunk = std::make_shared<Chunk>(*shared_chunk);
+        }
+        return *shared_chunk;
+    }
+
+    std::vector<std::shared_ptr<Chunk>> chunks_{};
+    std::size_t size_{0};
+};
+
+}  // namespace NetworkMonitor
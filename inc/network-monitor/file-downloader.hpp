@@ -1,12 +1,104 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
+#include <memory>
 #include <nlohmann/json.hpp>
+#include <ostream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace NetworkMonitor {
 
+/*! \brief Outcome of a file download.
+ */
+enum class DownloadResult {
+    Downloaded,
+    NotModified,
+    Failed,
+};
+
+/*! \brief Print operator for the `DownloadResult` class.
+ */
+std::ostream& operator<<(std::ostream& os, const DownloadResult& result);
+
+/*! \brief Remote file to download and the path of its local copy.
+ */
+struct DownloadRequest {
+    std::string file_url{};
+    std::filesystem::path destination{};
+};
+
+/*! \brief Downloader of remote files, reusing its connections between downloads.
+ *
+ *  The downloader keeps its curl handles alive and shares DNS results, connections and
+ *  TLS sessions between them, so repeated downloads from the same host skip most of the
+ *  connection setup. Responses are requested compressed, with any encoding supported by
+ *  the libcurl build.
+ *
+ *  Downloads are conditional: once a file has been downloaded, the next download to the
+ *  same destination sends its `ETag` and modification time, and the local copy is left
+ *  untouched if the remote file has not changed. The local copy is only replaced once a
+ *  download is complete.
+ *
+ *  A downloader must only be used from one thread at a time.
+ */
+class FileDownloader {
+   public:
+    /*! \brief Handler for each chunk of a streamed download.
+     *
+     *  \returns false to abort the download.
+     */
+    using ChunkHandler = std::function<bool(std::string_view chunk)>;
+
+    /*! \brief Construct a downloader.
+     *
+     *  \param ca_cert_file  The path to a cacert.pem file to perform certificate
+     *                       verification in an HTTPS connection.
+     */
+    explicit FileDownloader(const std::filesystem::path& ca_cert_file = {});
+
+    ~FileDownloader();
+
+    FileDownloader(const FileDownloader&) = delete;
+    FileDownloader& operator=(const FileDownloader&) = delete;
+
+    /*! \brief Download a file, unless the local copy is up to date.
+     *
+     *  \param destination   The full path and filename of the output file. The path
+     *                       to the file must exist.
+     */
+    DownloadResult Download(const std::string& file_url,
+                            const std::filesystem::path& destination);
+
+    /*! \brief Download several files in parallel.
+     *
+     *  \returns The result of each request, in the order of the requests.
+     */
+    std::vector<DownloadResult> DownloadAll(const std::vector<DownloadRequest>& requests);
+
+    /*! \brief Download a file, passing its content to a handler as it arrives.
+     *
+     *  The handler is called on the calling thread, during the download.
+     *
+     *  \param cache If set, the content is also saved to this path, and the download
+     *               is conditional as with Download: nothing is passed to the handler
+     *               if the saved copy is up to date.
+     */
+    DownloadResult Stream(const std::string& file_url,
+                          const ChunkHandler& on_chunk,
+                          const std::filesystem::path& cache = {});
+
+   private:
+    struct State;
+
+    std::unique_ptr<State> state_;
+};
+
 /*! \brief Download a file from a remote HTTPS URL.
+ *
+ *  Each call sets up a new connection. Use a `FileDownloader` to reuse it.
  *
  *  \param destination   The full path and filename of the output file. The path
  *                       to the file must exist.
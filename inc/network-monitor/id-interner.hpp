@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace NetworkMonitor {
+
+/*! \brief Table of interned string IDs.
+ *
+ *  Every ID added to the table gets a small integer handle. Handles are dense and
+ *  assigned in insertion order, starting from 0, and they never change for the
+ *  lifetime of the table.
+ *
+ *  Lookups take a `std::string_view`, so resolving an ID never needs a temporary
+ *  `std::string`. The table is an open-addressing hash table with linear probing.
+ */
+class IdInterner {
+   public:
+    using Handle = std::uint32_t;
+
+    /*! \brief Handle returned by lookups of IDs that are not in the table.
+     */
+    static constexpr Handle invalid_handle{std::numeric_limits<Handle>::max()};
+
+    /*! \brief Add an ID to the table.
+     *
+     *  \returns The handle of the ID. If the ID is already in the table, its existing
+     *           handle is returned.
+     */
+    Handle Intern(std::string_view id);
+
+    /*! \brief Get the handle of an ID.
+     *
+     *  \returns `invalid_handle` if the ID is not in the table.
+     */
+    Handle Find(std::string_view id) const;
+
+    /*! \brief Check if an ID is in the table.
+     */
+    bool Contains(std::string_view id) const;
+
+    /*! \brief Get the ID of a handle.
+     *
+     *  The handle must have been returned by this table. The returned reference stays
+     *  valid for the lifetime of the table.
+     */
+    const std::string& GetId(Handle handle) const;
+
+    /*! \brief Get the number of IDs in the table.
+     */
+    std::size_t Size() const;
+
+   private:
+    void Grow();
+
+    std::deque<std::string> ids_{};
+    std::vector<std::size_t> hashes_{};
+    std::vector<Handle> slots_{};
+};
+
+}  // namespace NetworkMonitor
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace NetworkMonitor {
+
+/*! \brief Pool of recycled string buffers for received messages.
+ *
+ *  A pooled buffer is handed out with unique ownership. When it is dropped, its string
+ *  goes back to the pool and keeps its capacity, so a pool in steady state fills
+ *  buffers without allocating.
+ *
+ *  The pool and its buffers can be used from any thread. Buffers can outlive the pool.
+ */
+class MessageBufferPool {
+   private:
+    struct State;
+
+   public:
+    /*! \brief Default number of released buffers kept for reuse.
+     */
+    static constexpr std::size_t default_max_free_buffers{16};
+
+    /*! \brief Move-only owner of a pooled string.
+     */
+    class Buffer {
+       public:
+        Buffer() = default;
+        Buffer(const Buffer& other) = delete;
+        Buffer(Buffer&& other) noexcept = default;
+        Buffer& operator=(const Buffer& other) = delete;
+        Buffer& operator=(Buffer&& other) noexcept;
+        ~Buffer();
+
+        std::string& operator*();
+        const std::string& operator*() const;
+        std::string* operator->();
+        const std::string* operator->() const;
+
+        /*! \brief Take the string out of the pool.
+         *
+         *  The buffer is left empty and no longer returns to the pool.
+         */
+        std::string Release();
+
+       private:
+        friend class MessageBufferPool;
+
+        Buffer(std::string&& data, std::shared_ptr<State> state);
+        void Recycle();
+
+        std::string data_{};
+        std::shared_ptr<State> state_{};
+    };
+
+    /*! \brief Pool usage counters.
+     */
+    struct Stats {
+        // Buffers served from a released buffer.
+        std::uint64_t hits{0};
+        // Buffers that needed a new string.
+        std::uint64_t misses{0};
+        // Released buffers currently waiting for reuse.
+        std::size_t free_buffers{0};
+    };
+
+    /*! \brief Construct a pool keeping up to `max_free_buffers` released buffers.
+     */
+    explicit MessageBufferPool(std::size_t max_free_buffers = default_max_free_buffers);
+
+    /*! \brief Get a pooled buffer holding a copy of `content`.
+     */
+    Buffer Acquire(std::string_view content);
+
+    /*! \brief Get the pool usage counters.
+     */
+    Stats GetStats() const;
+
+   private:
+    std::shared_ptr<State> state_;
+};
+
+}  // namespace NetworkMonitor
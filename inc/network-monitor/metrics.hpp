@@ -0,0 +1,274 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <network-monitor/stomp-client-error.hpp>
+#include <network-monitor/stomp-frame.hpp>
+#include <string>
+
+namespace NetworkMonitor {
+
+/*! \brief Whether the metrics are recorded.
+ *
+ *  Defining `NETWORK_MONITOR_NO_METRICS` (CMake option `NETWORK_MONITOR_METRICS=OFF`)
+ *  compiles the recording out: the metrics stay at zero and the clock is never read.
+ */
+#ifdef NETWORK_MONITOR_NO_METRICS
+inline constexpr bool metrics_enabled{false};
+#else
+inline constexpr bool metrics_enabled{true};
+#endif
+
+/*! \brief Clock of the latency metrics.
+ */
+struct MetricsClock {
+    using time_point = std::chrono::steady_clock::time_point;
+
+    /*! \brief Get the current time, or the epoch if the metrics are compiled out.
+     */
+    static time_point Now()
+    {
+        if constexpr (metrics_enabled) {
+            return std::chrono::steady_clock::now();
+        } else {
+            return {};
+        }
+    }
+};
+
+/*! \brief Monotonic counter, updated without locks.
+ *
+ *  The count is split across a few cache lines, and each thread adds to one of them,
+ *  so threads counting the same event do not contend.
+ */
+class MetricCounter {
+   public:
+    void Add(std::uint64_t value = 1)
+    {
+        if constexpr (metrics_enabled) {
+            shards_[GetThreadShard()].value.fetch_add(value, std::memory_order_relaxed);
+        }
+    }
+
+    std::uint64_t Get() const
+    {
+        std::uint64_t total{0};
+        for (const auto& shard : shards_) {
+            total += shard.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+   private:
+    static constexpr std::size_t shard_count{8};
+
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> value{0};
+    };
+
+    static std::size_t GetThreadShard()
+    {
+        static std::atomic<std::size_t> next_shard{0};
+        thread_local const std::size_t shard{
+            next_shard.fetch_add(1, std::memory_order_relaxed) % shard_count};
+        return shard;
+    }
+
+    std::array<Shard, shard_count> shards_{};
+};
+
+/*! \brief One counter for each value of an error code enumeration.
+ *
+ *  `Size` is the number of values of the enumeration, starting from 0.
+ */
+template <typename Error, std::size_t Size>
+class ErrorCounters {
+   public:
+    static constexpr std::size_t size{Size};
+
+    void Add(Error error)
+    {
+        const auto index{static_cast<std::size_t>(error)};
+        if (index < Size) {
+            counters_[index].Add();
+        }
+    }
+
+    std::uint64_t Get(Error error) const
+    {
+        const auto index{static_cast<std::size_t>(error)};
+        return index < Size ? counters_[index].Get() : 0;
+    }
+
+    std::array<std::uint64_t, Size> GetAll() const
+    {
+        std::array<std::uint64_t, Size> counts{};
+        for (std::size_t index{0}; index < Size; ++index) {
+            counts[index] = counters_[index].Get();
+        }
+        return counts;
+    }
+
+   private:
+    std::array<MetricCounter, Size> counters_{};
+};
+
+/*! \brief Histogram of latencies, in nanoseconds, updated without locks.
+ *
+ *  As in HDR histograms, each power-of-two range of values is split into
+ *  `sub_bucket_count` linear buckets: a recorded value is known to within 1/8 of
+ *  itself, and the buckets cover the whole 64-bit range in a fixed amount of memory.
+ */
+class LatencyHistogram {
+   public:
+    static constexpr std::size_t sub_bucket_bits{3};
+    static constexpr std::size_t sub_bucket_count{std::size_t{1} << sub_bucket_bits};
+    static constexpr std::size_t bucket_count{(65 - sub_bucket_bits) * sub_bucket_count};
+
+    /*! \brief Copy of the histogram at one point in time.
+     */
+    struct Snapshot {
+        std::array<std::uint64_t, bucket_count> buckets{};
+        std::uint64_t count{0};
+        std::uint64_t sum_ns{0};
+
+        /*! \brief Get the latency, in nanoseconds, under which `percentile` percent
+         *         of the recorded values are.
+         *
+         *  The result is the upper bound of the bucket holding that value, or 0 if the
+         *  histogram is empty.
+         */
+        std::uint64_t GetPercentile(double percentile) const;
+    };
+
+    void Record(std::chrono::nanoseconds latency)
+    {
+        if constexpr (metrics_enabled) {
+            const auto value{
+                latency.count() > 0 ? static_cast<std::uint64_t>(latency.count()) : 0};
+            buckets_[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            sum_ns_.fetch_add(value, std::memory_order_relaxed);
+        }
+    }
+
+    void RecordSince(MetricsClock::time_point start)
+    {
+        if constexpr (metrics_enabled) {
+            Record(MetricsClock::Now() - start);
+        }
+    }
+
+    Snapshot GetSnapshot() const;
+
+    static std::size_t GetBucketIndex(std::uint64_t value)
+    {
+        if (value < 2 * sub_bucket_count) {
+            return static_cast<std::size_t>(value);
+        }
+        const auto highest_bit{GetHighestBit(value)};
+        const auto shift{highest_bit - sub_bucket_bits};
+        return (shift + 1) * sub_bucket_count +
+               static_cast<std::size_t>(value >> shift) - sub_bucket_count;
+    }
+
+    /*! \brief Get the highest value, in nanoseconds, counted in a bucket.
+     */
+    static std::uint64_t GetBucketUpperBound(std::size_t index);
+
+   private:
+    static std::size_t GetHighestBit(std::uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - static_cast<std::size_t>(__builtin_clzll(value));
+#else
+        std::size_t highest_bit{0};
+        while (value >>= 1) {
+            ++highest_bit;
+        }
+        return highest_bit;
+#endif
+    }
+
+    std::array<std::atomic<std::uint64_t>, bucket_count> buckets_{};
+    std::atomic<std::uint64_t> sum_ns_{0};
+};
+
+/*! \brief Number of `StompError` values.
+ */
+inline constexpr std::size_t stomp_error_count{
+    static_cast<std::size_t>(StompError::NoHeaderName) + 1};
+
+/*! \brief Number of `StompClientError` values.
+ */
+inline constexpr std::size_t stomp_client_error_count{
+    static_cast<std::size_t>(StompClientError::UndefinedError) + 1};
+
+/*! \brief Metrics of the hot paths, shared by all the clients of the process.
+ */
+struct Metrics {
+    // Messages and payload bytes of all the WebSocket clients.
+    MetricCounter websocket_messages_received{};
+    MetricCounter websocket_bytes_received{};
+    MetricCounter websocket_messages_sent{};
+    MetricCounter websocket_bytes_sent{};
+
+    // Time to parse each received STOMP frame, and the result of each parsing.
+    LatencyHistogram stomp_frame_parse_time{};
+    ErrorCounters<StompError, stomp_error_count> stomp_frame_results{};
+
+    // Errors reported by the STOMP clients to their callbacks.
+    ErrorCounters<StompClientError, stomp_client_error_count> stomp_client_errors{};
+
+    // Time from the reception of a MESSAGE frame to the call of its subscribers.
+    LatencyHistogram stomp_dispatch_delay{};
+
+    MetricCounter stomp_reconnect_attempts{};
+    MetricCounter stomp_reconnections{};
+
+    // Passenger events recorded in, or rejected by, the transport networks.
+    MetricCounter passenger_events_recorded{};
+    MetricCounter passenger_events_rejected{};
+};
+
+/*! \brief Get the metrics of the process.
+ */
+inline Metrics& GetMetrics()
+{
+    // Constant-initialized, so it is usable from any static initializer.
+    static Metrics metrics{};
+    return metrics;
+}
+
+/*! \brief Copy of all the metrics at one point in time.
+ *
+ *  Each metric is read atomically, but the metrics are not read all at once.
+ */
+struct MetricsSnapshot {
+    std::uint64_t websocket_messages_received{0};
+    std::uint64_t websocket_bytes_received{0};
+    std::uint64_t websocket_messages_sent{0};
+    std::uint64_t websocket_bytes_sent{0};
+    LatencyHistogram::Snapshot stomp_frame_parse_time{};
+    std::array<std::uint64_t, stomp_error_count> stomp_frame_results{};
+    std::array<std::uint64_t, stomp_client_error_count> stomp_client_errors{};
+    LatencyHistogram::Snapshot stomp_dispatch_delay{};
+    std::uint64_t stomp_reconnect_attempts{0};
+    std::uint64_t stomp_reconnections{0};
+    std::uint64_t passenger_events_recorded{0};
+    std::uint64_t passenger_events_rejected{0};
+};
+
+/*! \brief Take a snapshot of the metrics.
+ */
+MetricsSnapshot GetMetricsSnapshot(const Metrics& metrics = GetMetrics());
+
+/*! \brief Format a snapshot in the Prometheus text exposition format.
+ *
+ *  Latencies are exported in seconds, as histograms with power-of-two buckets.
+ */
+std::string ToPrometheusText(const MetricsSnapshot& snapshot);
+
+}  // namespace NetworkMonitor
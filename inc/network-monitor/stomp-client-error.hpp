@@ -0,0 +1,66 @@
+#pragma once
+
+#include <boost/bimap.hpp>
+#include <initializer_list>
+#include <ostream>
+#include <string_view>
+
+namespace NetworkMonitor {
+
+/*! \brief Error codes for the STOMP client.
+ */
+enum class StompClientError {
+    Ok = 0,
+    CouldNotConnectToWebSocketServer,
+    UnexpectedCouldNotCreateValidFrame,
+    CouldNotSendConnectFrame,
+    CouldNotParseMessageAsStompFrame,
+    CouldNotCloseWebSocketConnection,
+    WebSocketServerDisconnected,
+    CouldNotSendSubscribeFrame,
+    UndefinedError
+    // TODO
+};
+
+// TODO: move it to the common space with stomp-frame.cpp
+template <typename L, typename R>
+boost::bimap<L, R> MakeBimap(
+    std::initializer_list<typename boost::bimap<L, R>::value_type> list)
+{
+    return boost::bimap<L, R>(list.begin(), list.end());
+}
+
+static const auto stomp_client_error_strings{
+    // clang-format off
+    MakeBimap<StompClientError, std::string_view>({
+        {StompClientError::Ok,                                    "Ok"                                    },
+        {StompClientError::CouldNotConnectToWebSocketServer,      "CouldNotConnectToWebSocketServer"      },
+        {StompClientError::UnexpectedCouldNotCreateValidFrame,    "UnexpectedCouldNotCreateValidFrame"    },
+        {StompClientError::CouldNotSendConnectFrame,              "CouldNotSendConnectFrame"              },
+        {StompClientError::CouldNotParseMessageAsStompFrame,      "CouldNotParseMessageAsStompFrame"      },
+        {StompClientError::CouldNotCloseWebSocketConnection,      "CouldNotCloseWebSocketConnection"      },
+        {StompClientError::WebSocketServerDisconnected,           "WebSocketServerDisconnected"           },
+        {StompClientError::CouldNotSendSubscribeFrame,            "CouldNotSendSubscribeFrame"            },
+        {StompClientError::UndefinedError,                        "UndefinedError"                        }
+    })
+    // clang-format on
+};
+
+inline std::string_view ToStringView(const StompClientError& command)
+{
+    const auto string_representation{stomp_client_error_strings.left.find(command)};
+    if (string_representation == stomp_client_error_strings.left.end()) {
+        return stomp_client_error_strings.left.find(StompClientError::UndefinedError)
+            ->second;
+    } else {
+        return string_representation->second;
+    }
+}
+
+inline std::ostream& operator<<(std::ostream& os, const StompClientError& error)
+{
+    os << ToStringView(error);
+    return os;
+}
+
+}  // namespace NetworkMonitor
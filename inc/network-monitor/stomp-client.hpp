@@ -2,85 +2,158 @@
 
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
-#include <boost/bimap.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <network-monitor/metrics.hpp>
+#include <network-monitor/stomp-client-error.hpp>
 #include <network-monitor/stomp-frame-builder.hpp>
+#include <network-monitor/stomp-frame-decoder.hpp>
+#include <network-monitor/stomp-frame-pool.hpp>
 #include <network-monitor/stomp-frame.hpp>
+#include <optional>
+#include <random>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace NetworkMonitor {
 
-/*! \brief Error codes for the STOMP client.
+/*! \brief Reconnection policy of a StompClient.
+ *
+ *  The n-th attempt waits `initial_delay * multiplier^n`, capped to `max_delay`, minus
+ *  a random part of up to `jitter` of that delay. The randomization spreads the
+ *  clients dropped by the same broker failover.
  */
-enum class StompClientError {
-    Ok = 0,
-    CouldNotConnectToWebSocketServer,
-    UnexpectedCouldNotCreateValidFrame,
-    CouldNotSendConnectFrame,
-    CouldNotParseMessageAsStompFrame,
-    CouldNotCloseWebSocketConnection,
-    WebSocketServerDisconnected,
-    CouldNotSendSubscribeFrame,
-    UndefinedError
-    // TODO
+struct StompReconnectOptions {
+    /*! \brief Reconnect automatically when the connection is lost.
+     */
+    bool enabled{false};
+
+    std::chrono::milliseconds initial_delay{50};
+    std::chrono::milliseconds max_delay{5000};
+    double multiplier{2.0};
+
+    /*! \brief Randomized fraction of each delay, from 0 to 1.
+     */
+    double jitter{0.5};
+
+    /*! \brief Consecutive failed attempts before giving up. Zero retries forever.
+     */
+    std::size_t max_attempts{0};
 };
 
-// TODO: move it to the common space with stomp-frame.cpp
-template <typename L, typename R>
-boost::bimap<L, R> MakeBimap(
-    std::initializer_list<typename boost::bimap<L, R>::value_type> list)
-{
-    return boost::bimap<L, R>(list.begin(), list.end());
-}
-
-// TODO: move it to stomp-client.cpp
-static const auto stomp_client_error_strings{
-    // clang-format off
-    MakeBimap<StompClientError, std::string_view>({
-        {StompClientError::Ok,                                    "Ok"                                    },
-        {StompClientError::CouldNotConnectToWebSocketServer,      "CouldNotConnectToWebSocketServer"      },
-        {StompClientError::UnexpectedCouldNotCreateValidFrame,    "UnexpectedCouldNotCreateValidFrame"    },
-        {StompClientError::CouldNotSendConnectFrame,              "CouldNotSendConnectFrame"              },
-        {StompClientError::CouldNotParseMessageAsStompFrame,      "CouldNotParseMessageAsStompFrame"      },
-        {StompClientError::CouldNotCloseWebSocketConnection,      "CouldNotCloseWebSocketConnection"      },
-        {StompClientError::WebSocketServerDisconnected,           "WebSocketServerDisconnected"           },
-        {StompClientError::CouldNotSendSubscribeFrame,            "CouldNotSendSubscribeFrame"            },
-        {StompClientError::UndefinedError,                        "UndefinedError"                        }
-    })
-    // clang-format on
+/*! \brief STOMP heart-beating wished by a StompClient.
+ *
+ *  The intervals are negotiated with the server in the CONNECT and CONNECTED frames:
+ *  each side beats at the slower of what it offers and what the other side wants.
+ *  Zero disables a direction.
+ */
+struct StompHeartBeatOptions {
+    /*! \brief Smallest interval at which the client can send heart-beats.
+     */
+    std::chrono::milliseconds outgoing{0};
+
+    /*! \brief Interval at which the client wants to receive heart-beats.
+     */
+    std::chrono::milliseconds incoming{0};
+
+    /*! \brief Missed intervals after which the connection is considered lost.
+     */
+    double tolerance{2.0};
 };
 
-std::string_view ToStringView(const StompClientError& command)
-{
-    const auto string_representation{stomp_client_error_strings.left.find(command)};
-    if (string_representation == stomp_client_error_strings.left.end()) {
-        return stomp_client_error_strings.left.find(StompClientError::UndefinedError)
-            ->second;
-    } else {
-        return string_representation->second;
-    }
-}
+/*! \brief Acknowledgement mode of a STOMP subscription.
+ */
+enum class StompAckMode {
+    // The server considers messages acknowledged once sent.
+    Auto,
+    // An ACK acknowledges its message and all the previous ones of the subscription.
+    Client,
+    // An ACK only acknowledges its own message.
+    ClientIndividual,
+};
 
-std::ostream& operator<<(std::ostream& os, const StompClientError& error)
-{
-    os << ToStringView(error);
-    return os;
-}
+/*! \brief Batching of the acknowledgements sent by a StompClient.
+ *
+ *  A message is acknowledged once all its handlers have returned. The pending ACKs of
+ *  a subscription are sent when `batch_size` messages are pending, or `batch_delay`
+ *  after the first pending one. In `Client` mode a batch is a single cumulative ACK;
+ *  in `ClientIndividual` mode the ACK frames of a batch are packed into a single
+ *  WebSocket message.
+ */
+struct StompAckOptions {
+    std::size_t batch_size{32};
+    std::chrono::milliseconds batch_delay{100};
+
+    /*! \brief Received messages a subscription can leave unacknowledged.
+     *
+     *  When the handlers fall behind and this many messages are in flight, each
+     *  handled message is acknowledged right away. Brokers only deliver a bounded
+     *  number of unacknowledged messages, so the acknowledgements pace the broker to
+     *  the handlers. Keep it at most at the broker prefetch window.
+     */
+    std::size_t max_in_flight{256};
+};
+
+/*! \brief Settings of a StompClient.
+ */
+struct StompClientOptions {
+    StompReconnectOptions reconnect{};
+    StompHeartBeatOptions heart_beat{};
+    StompAckOptions ack{};
+
+    /*! \brief Frames a coroutine `FrameStream` queues until they are pulled.
+     *
+     *  Once it is full, the oldest queued frame is dropped. The queued frames are not
+     *  acknowledged, so with an acknowledgement mode the broker stops delivering once
+     *  its prefetch window is queued: keep it at least at this window.
+     */
+    std::size_t frame_stream_capacity{1024};
+
+    /*! \brief Executor running the user handlers. Defaults to the client io_context.
+     *
+     *  A separate executor, such as a boost::asio::thread_pool, keeps slow handlers
+     *  from delaying the network I/O.
+     */
+    boost::asio::any_io_executor callback_executor{};
+};
 
 /*! \brief STOMP client implementing the subset of commands needed by the network-events
  *         service.
  *
+ *  Threading model: the network I/O, the frame parsing, the timers and the connection
+ *  state of a client all run on the strand of its WebSocket client. Many clients can
+ *  share an io_context run by a pool of threads. The public methods can be called from
+ *  any thread. The user handlers are posted to a strand over the callback executor, so
+ *  they are never called concurrently with each other, and a slow handler on its own
+ *  executor never stalls the socket.
+ *
  *  \param WebSocketClient      WebSocket client class. This type must have the same
  *                              interface of WebSocketClient.
  */
 template <typename WebSocketClient>
 class StompClient {
    public:
+    /*! \brief Handler for a message body viewed in the shared copy of the message.
+     *
+     *  The view is only valid during the call.
+     */
+    using MessageViewCallback = std::function<void(StompClientError, std::string_view)>;
+
     /*! \brief Construct a STOMP client connecting to a remote URL/port through a secure
      *         WebSocket connection.
      *
@@ -93,12 +166,14 @@ class StompClient {
      *  \param io_context   The io_context object. The user takes care of calling
      *                      io_context.run().
      *  \param tls_context  The TLS context to setup a TLS socket stream.
+     *  \param options      Settings of the client, like the reconnection policy.
      */
     StompClient(const std::string& url,
                 const std::string& endpoint,
                 const std::string& port,
                 boost::asio::io_context& io_context,
-                boost::asio::ssl::context& tls_context);
+                boost::asio::ssl::context& tls_context,
+                StompClientOptions options = {});
 
     /*! \brief Connect to the STOMP server.
      *
@@ -113,7 +188,13 @@ class StompClient {
      *  \param on_disconnect    This handler is called when the STOMP or the WebSocket
      *                          connection is suddenly closed. In the STOMP protocol,
      *                          this may happen also in response to bad inputs
-     *                          (authentication, subscription).
+     *                          (authentication, subscription). With reconnection
+     *                          enabled, it is only called once reconnecting gives up.
+     *
+     *  A connection whose server stops sending negotiated heart-beats is considered
+     *  lost. When the connection is lost and reconnection is enabled, the client connects
+     *  again, resuming the TLS session, and subscribes again to all its destinations
+     *  with the same subscription IDs. `on_connect` is not called for reconnections.
      *
      *  All handlers run in a separate I/O execution context from the WebSocket one.
      */
@@ -148,37 +229,203 @@ class StompClient {
      *  \param on_message_callback      Called on every new message from the subscription
      *                                  destination. It is assumed that the message is
      *                                  received with application/json content type.
+     *  \param ack_mode                 How the messages are acknowledged. Outside of
+     *                                  `Auto` mode, messages are acknowledged in
+     *                                  batches once handled, as set by the client
+     *                                  options.
+     *
+     *  Subscribing again to a destination does not subscribe again on the server: the
+     *  new handlers share the existing subscription, its ID and its acknowledgement
+     *  mode, and all the handlers of a destination share a single pooled copy of each
+     *  message.
+     *
+     *  `on_message_callback` receives its own copy of the message body, allocated for
+     *  each call. Use `SubscribeWithMessageViews` or `SubscribeToFrames` to read the
+     *  shared copy instead.
      *
      *  All handlers run in a separate I/O execution context from the WebSocket one.
      */
     std::string Subscribe(
         const std::string& destination,
         std::function<void(StompClientError, std::string&&)> on_subscribed_callback,
-        std::function<void(StompClientError, std::string&&)> on_message_callback);
+        std::function<void(StompClientError, std::string&&)> on_message_callback,
+        StompAckMode ack_mode = StompAckMode::Auto);
+
+    /*! \brief Subscribe to a STOMP endpoint, viewing the message bodies.
+     *
+     *  Same as `Subscribe`, but `on_message_callback` receives a view of the body in
+     *  the shared copy of the message instead of a copy of its own. The view is only
+     *  valid during the call.
+     */
+    std::string SubscribeWithMessageViews(
+        const std::string& destination,
+        std::function<void(StompClientError, std::string&&)> on_subscribed_callback,
+        MessageViewCallback on_message_callback,
+        StompAckMode ack_mode = StompAckMode::Auto);
+
+    /*! \brief Subscribe to a STOMP endpoint, receiving the pooled message frames.
+     *
+     *  Same as `Subscribe`, but `on_frame_callback` receives a handle to the whole
+     *  MESSAGE frame instead of a copy of its body. The frame goes back to the client
+     *  pool when the last copy of the handle is dropped, so keeping the handle is how
+     *  the frame is kept. No allocation happens per message once the pool is warm.
+     */
+    std::string SubscribeToFrames(
+        const std::string& destination,
+        std::function<void(StompClientError, std::string&&)> on_subscribed_callback,
+        std::function<void(StompClientError, StompFramePool::Handle)> on_frame_callback,
+        StompAckMode ack_mode = StompAckMode::Auto);
+
+    /*! \brief Get the usage counters of the pool of received frames.
+     */
+    StompFramePool::Stats GetFramePoolStats() const;
+
+    /*! \brief Get the number of successful reconnections.
+     */
+    std::uint64_t GetReconnectionsCount() const;
+
+#ifdef NETWORK_MONITOR_COROUTINES
+    /*! \brief MESSAGE frames of a subscription, pulled by a coroutine.
+     *
+     *  Frames are queued from the subscription on, until they are pulled, up to
+     *  `StompClientOptions::frame_stream_capacity` of them. With an acknowledgement
+     *  mode, a frame is acknowledged once pulled. Frames are no longer queued once the
+     *  last copy of the stream is dropped.
+     */
+    class FrameStream {
+       public:
+        /*! \brief Get the subscription ID.
+         */
+        const std::string& GetSubscriptionId() const;
+
+        /*! \brief Wait for the next frame of the subscription.
+         *
+         *  \returns The next frame, or an empty handle once the client is closed or
+         *           disconnected for good.
+         */
+        boost::asio::awaitable<StompFramePool::Handle> Next();
+
+       private:
+        friend class StompClient;
+        struct State;
+
+        static boost::asio::awaitable<StompFramePool::Handle> NextOnStrand(
+            std::shared_ptr<State> state);
+
+        std::shared_ptr<State> state_{};
+    };
+
+    /*! \brief Connect to the STOMP server, for a coroutine.
+     *
+     *  Same as `Connect`, waiting for the result of the connection.
+     */
+    boost::asio::awaitable<StompClientError> AsyncConnect(
+        const std::string& user_name,
+        const std::string& user_password,
+        std::function<void(StompClientError)> on_disconnected_callback = nullptr);
+
+    /*! \brief Subscribe to a STOMP endpoint, for a coroutine.
+     *
+     *  Same as `SubscribeToFrames`, waiting for the subscription to be set up.
+     *
+     *  \returns The result of the subscription, and the stream of its frames.
+     */
+    boost::asio::awaitable<std::pair<StompClientError, FrameStream>> AsyncSubscribe(
+        const std::string& destination, StompAckMode ack_mode = StompAckMode::Auto);
+#endif
 
    private:
     using OnSubscribeCallback = std::function<void(StompClientError, std::string&&)>;
     using OnMessageCallback = std::function<void(StompClientError, std::string&&)>;
+    using OnFrameCallback = std::function<void(StompClientError, StompFramePool::Handle)>;
+
+    // Kept by the listeners that hold on to a frame after their call: the message is
+    // acknowledged once the last copy is dropped.
+    using AckToken = std::shared_ptr<void>;
+    using OnQueuedFrameCallback = std::function<void(StompFramePool::Handle, AckToken)>;
+
+    struct Listener {
+        OnMessageCallback on_message_callback{nullptr};
+        OnFrameCallback on_frame_callback{nullptr};
+        MessageViewCallback on_message_view_callback{nullptr};
+        OnQueuedFrameCallback on_queued_frame_callback{nullptr};
+    };
+    using Listeners = std::vector<Listener>;
 
+    // Acknowledgements held for a subscription. Only used on `connection_`.
+    struct AckBatch {
+        explicit AckBatch(
+            const boost::asio::strand<boost::asio::io_context::executor_type>& executor,
+            StompAckMode mode)
+            : mode{mode}, timer{executor}
+        {
+        }
+
+        const StompAckMode mode;
+        // The last ACK ID in `Client` mode, all of them in `ClientIndividual` mode.
+        std::vector<std::string> ack_ids{};
+        std::size_t pending{0};
+        std::size_t in_flight{0};
+        boost::asio::steady_timer timer;
+        bool timer_armed{false};
+    };
+
+    // One server subscription per destination, shared by all its listeners.
     struct Subscription {
+        std::string id{};
         std::string destination{};
-        OnSubscribeCallback on_subscribe_callback{nullptr};
-        OnMessageCallback on_message_callback{nullptr};
+        // Replaced, never modified, when a listener is added: messages being handled
+        // keep the list they were dispatched to.
+        std::shared_ptr<const Listeners> listeners{};
+        std::vector<OnSubscribeCallback> pending_on_subscribe_callbacks{};
+        bool confirmed{false};
+        // Null in `Auto` mode.
+        std::shared_ptr<AckBatch> ack_batch{};
     };
 
+    std::string SubscribeInternal(const std::string& destination,
+                                  OnSubscribeCallback&& on_subscribe_callback,
+                                  Listener&& listener,
+                                  StompAckMode ack_mode);
+    void ConnectWebSocket();
+    void ScheduleReconnect();
+    std::chrono::milliseconds GetReconnectDelay(std::size_t attempt);
+    void Resubscribe();
+    std::string MakeSubscribeFrame(const Subscription& subscription) const;
+    void CloseFrameStreams();
+
+    void OnMessageHandled(const std::shared_ptr<AckBatch>& ack_batch,
+                          const StompFrame& frame,
+                          std::uint64_t generation);
+    void SendAcks(AckBatch& ack_batch);
+    void DropAcks();
+    void SendToWebSocket(
+        std::string message,
+        std::function<void(boost::system::error_code)> on_sent = nullptr);
+
+    void StartHeartBeat(std::chrono::milliseconds send_interval,
+                        std::chrono::milliseconds receive_timeout);
+    void StopHeartBeat();
+    void ArmHeartBeatTimer(std::uint64_t generation);
+    void OnHeartBeatTimer(std::uint64_t generation);
+    void OnHeartBeatMissed();
+
+    static std::pair<std::chrono::milliseconds, std::chrono::milliseconds>
+    ParseHeartBeat(std::string_view heart_beat);
+
     void OnWebSocketConnected(boost::system::error_code result);
     void OnWebSocketConnectMessageSent(boost::system::error_code result);
     void OnWebSocketMessageReceived(boost::system::error_code result,
-                                    std::string&& message);
+                                    std::string_view message);
     void OnWebSocketMessageSent(boost::system::error_code result);
     void OnWebSocketDisconnected(boost::system::error_code result);
     void OnWebSocketClosed(
         boost::system::error_code result,
         std::function<void(StompClientError)> on_close_callback = nullptr);
     void OnWebSocketSentSubscribe(boost::system::error_code result,
-                                  std::string& subscription_id,
-                                  Subscription&& subscription);
+                                  const std::string& subscription_id);
 
+    void HandleStompFrame(StompError error, StompFrame&& frame);
     void HandleStompConnected(StompFrame&& frame);
     void HandleStompReceipt(StompFrame&& frame);
     void HandleStompMessage(StompFrame&& frame);
@@ -195,22 +442,114 @@ class StompClient {
     std::string user_name_;
     std::string user_password_;
 
-    std::unordered_map<std::string, Subscription> subscriptions_{};
+    // Keys are views of the `id` and `destination` of their own subscription, so
+    // lookups from frame headers need no string.
+    std::unordered_map<std::string_view, std::unique_ptr<Subscription>>
+        subscriptions_{};
+    std::unordered_map<std::string_view, Subscription*> destinations_{};
+    // Subscriptions are used on `connection_`, but added by `Subscribe` from the caller
+    // thread, which gets the subscription ID right away.
+    std::mutex subscriptions_mutex_{};
+
+    StompFrameDecoder frame_decoder_{};
+    StompFramePool frame_pool_{};
 
     WebSocketClient websocket_client_;
-    boost::asio::strand<boost::asio::io_context::executor_type> async_context_;
+    // The WebSocket client strand, on which all the connection state lives.
+    boost::asio::strand<boost::asio::io_context::executor_type> connection_;
+    // Runs the user handlers.
+    boost::asio::strand<boost::asio::any_io_executor> async_context_;
 
     bool websocket_connected_{false};
+
+    const StompClientOptions options_;
+    boost::asio::steady_timer reconnect_timer_;
+    std::mt19937 random_engine_{std::random_device{}()};
+    bool closing_{false};
+    bool reconnecting_{false};
+    std::size_t reconnect_attempts_{0};
+    std::atomic<std::uint64_t> reconnections_{0};
+    // Bumped when the acknowledgements are dropped: the messages of older connections
+    // are no longer acknowledged once handled.
+    std::uint64_t connection_generation_{0};
+
+    // A single timer serves both heart-beat directions: messages only record when they
+    // pass, and the timer wakes up at the nearest deadline. The timestamps are also
+    // written by `Subscribe`.
+    boost::asio::steady_timer heart_beat_timer_;
+    std::uint64_t heart_beat_generation_{0};
+    std::chrono::milliseconds heart_beat_send_interval_{0};
+    std::chrono::milliseconds heart_beat_receive_timeout_{0};
+    std::atomic<std::chrono::steady_clock::rep> last_sent_time_{0};
+    std::atomic<std::chrono::steady_clock::rep> last_received_time_{0};
+
+    // When the WebSocket message being decoded was received, for the dispatch delay.
+    MetricsClock::time_point message_received_time_{};
+
+#ifdef NETWORK_MONITOR_COROUTINES
+    // Result of a callback, awaited by a coroutine on `async_context_`.
+    template <typename Result>
+    struct AwaitedResult {
+        explicit AwaitedResult(
+            const boost::asio::strand<boost::asio::any_io_executor>& executor)
+            : signal{executor, boost::asio::steady_timer::time_point::max()}
+        {
+        }
+
+        std::optional<Result> result{};
+        // Never expires: cancelled to wake up the coroutine.
+        boost::asio::steady_timer signal;
+    };
+
+    boost::asio::awaitable<StompClientError> ConnectOnCallbackStrand(
+        std::string user_name,
+        std::string user_password,
+        std::function<void(StompClientError)> on_disconnected_callback);
+    boost::asio::awaitable<std::pair<StompClientError, FrameStream>>
+    SubscribeOnCallbackStrand(std::string destination, StompAckMode ack_mode);
+
+    // Only used on `async_context_`.
+    std::vector<std::weak_ptr<typename FrameStream::State>> frame_streams_{};
+#endif
+};
+
+#ifdef NETWORK_MONITOR_COROUTINES
+template <typename WebSocketClient>
+struct StompClient<WebSocketClient>::FrameStream::State {
+    explicit State(const boost::asio::strand<boost::asio::any_io_executor>& executor)
+        : signal{executor, boost::asio::steady_timer::time_point::max()}
+    {
+    }
+
+    struct QueuedFrame {
+        StompFramePool::Handle frame{};
+        AckToken ack{};
+    };
+
+    std::string subscription_id{};
+    std::deque<QueuedFrame> frames{};
+    bool closed{false};
+    // Never expires: cancelled to wake up the coroutine waiting for a frame.
+    boost::asio::steady_timer signal;
 };
+#endif
 
 template <typename WebSocketClient>
 StompClient<WebSocketClient>::StompClient(const std::string& url,
                                           const std::string& endpoint,
                                           const std::string& port,
                                           boost::asio::io_context& io_context,
-                                          boost::asio::ssl::context& tls_context)
+                                          boost::asio::ssl::context& tls_context,
+                                          StompClientOptions options)
     : websocket_client_{url, endpoint, port, io_context, tls_context},
-      async_context_{boost::asio::make_strand(io_context)}
+      connection_{websocket_client_.GetExecutor()},
+      async_context_{boost::asio::make_strand(
+          options.callback_executor
+              ? options.callback_executor
+              : boost::asio::any_io_executor{io_context.get_executor()})},
+      options_{options},
+      reconnect_timer_{connection_},
+      heart_beat_timer_{connection_}
 {
 }
 
@@ -222,16 +561,32 @@ void StompClient<WebSocketClient>::Connect(
     std::function<void(StompClientError)> on_disconnected_callback)
 {
     // TODO: add log StompClient: Connecting to STOMP server
-    user_name_ = user_name;
-    user_password_ = user_password;
-    on_connected_callback_ = std::move(on_connected_callback);
-    on_disconnected_callback_ = std::move(on_disconnected_callback);
+    boost::asio::post(connection_, [this, user_name, user_password,
+                                    on_connected = std::move(on_connected_callback),
+                                    on_disconnected =
+                                        std::move(on_disconnected_callback)]() mutable {
+        user_name_ = std::move(user_name);
+        user_password_ = std::move(user_password);
+        on_connected_callback_ = std::move(on_connected);
+        on_disconnected_callback_ = std::move(on_disconnected);
+        closing_ = false;
+        reconnecting_ = false;
+        reconnect_attempts_ = 0;
+
+        ConnectWebSocket();
+    });
+}
 
-    websocket_client_.Connect([this](auto result) { OnWebSocketConnected(result); },
-                              [this](auto result, auto&& message) {
-                                  OnWebSocketMessageReceived(result, std::move(message));
-                              },
-                              [this](auto result) { OnWebSocketDisconnected(result); });
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::ConnectWebSocket()
+{
+    // The frame decoder copies what it keeps, so messages are viewed in place.
+    websocket_client_.ConnectWithMessageViews(
+        [this](auto result) { OnWebSocketConnected(result); },
+        [this](auto result, auto message) {
+            OnWebSocketMessageReceived(result, message);
+        },
+        [this](auto result) { OnWebSocketDisconnected(result); });
 }
 
 template <typename WebSocketClient>
@@ -239,34 +594,118 @@ void StompClient<WebSocketClient>::Close(std::function<void(StompClientError)> o
 {
     // TODO: log StompClient: Closing connection to STOMP server
     // TODO: clear subscriptions
-    websocket_client_.Close(
-        [this, on_closed](auto result) { OnWebSocketClosed(result, on_closed); });
+    boost::asio::post(connection_, [this, on_closed = std::move(on_closed)]() {
+        closing_ = true;
+        reconnect_timer_.cancel();
+        StopHeartBeat();
+        DropAcks();
+        CloseFrameStreams();
+        websocket_client_.Close(
+            [this, on_closed](auto result) { OnWebSocketClosed(result, on_closed); });
+    });
 }
 
 template <typename WebSocketClient>
 std::string StompClient<WebSocketClient>::Subscribe(
     const std::string& destination,
     std::function<void(StompClientError, std::string&&)> on_subscribed_callback,
-    std::function<void(StompClientError, std::string&&)> on_message_callback)
+    std::function<void(StompClientError, std::string&&)> on_message_callback,
+    StompAckMode ack_mode)
 {
-    // TODO: add log StompClient: Subscribing to {destination}
+    return SubscribeInternal(destination, std::move(on_subscribed_callback),
+                             {std::move(on_message_callback), nullptr}, ack_mode);
+}
 
-    auto subscription_id{GenerateSubscriptionId()};
+template <typename WebSocketClient>
+std::string StompClient<WebSocketClient>::SubscribeWithMessageViews(
+    const std::string& destination,
+    std::function<void(StompClientError, std::string&&)> on_subscribed_callback,
+    MessageViewCallback on_message_callback,
+    StompAckMode ack_mode)
+{
+    return SubscribeInternal(destination, std::move(on_subscribed_callback),
+                             {nullptr, nullptr, std::move(on_message_callback)},
+                             ack_mode);
+}
 
-    // TODO: handle error ocurred when creating a frame
-    auto stomp_frame{stomp_frame::MakeSubscribeFrame(destination, subscription_id, "auto",
-                                                     subscription_id)};
+template <typename WebSocketClient>
+std::string StompClient<WebSocketClient>::SubscribeToFrames(
+    const std::string& destination,
+    std::function<void(StompClientError, std::string&&)> on_subscribed_callback,
+    std::function<void(StompClientError, StompFramePool::Handle)> on_frame_callback,
+    StompAckMode ack_mode)
+{
+    return SubscribeInternal(destination, std::move(on_subscribed_callback),
+                             {nullptr, std::move(on_frame_callback)}, ack_mode);
+}
+
+template <typename WebSocketClient>
+StompFramePool::Stats StompClient<WebSocketClient>::GetFramePoolStats() const
+{
+    return frame_pool_.GetStats();
+}
 
-    Subscription subscription{destination, on_subscribed_callback, on_message_callback};
+template <typename WebSocketClient>
+std::uint64_t StompClient<WebSocketClient>::GetReconnectionsCount() const
+{
+    return reconnections_;
+}
 
-    // TODO: why mutable? why assign operator instead of just std::move?
-    auto on_websocket_sent_callback = [this, subscription_id,
-                                       subscription =
-                                           std::move(subscription)](auto result) mutable {
-        OnWebSocketSentSubscribe(result, subscription_id, std::move(subscription));
-    };
+template <typename WebSocketClient>
+std::string StompClient<WebSocketClient>::SubscribeInternal(
+    const std::string& destination,
+    OnSubscribeCallback&& on_subscribe_callback,
+    Listener&& listener,
+    StompAckMode ack_mode)
+{
+    std::string subscription_id{};
+    std::string stomp_frame{};
+    {
+        std::lock_guard<std::mutex> lock{subscriptions_mutex_};
+        auto destination_iterator{destinations_.find(destination)};
+        if (destination_iterator != destinations_.end()) {
+            // TODO: add log StompClient: Adding listener to {destination}
+            auto& subscription{*destination_iterator->second};
+            auto listeners{std::make_shared<Listeners>(*subscription.listeners)};
+            listeners->push_back(std::move(listener));
+            subscription.listeners = std::move(listeners);
+            if (on_subscribe_callback && subscription.confirmed) {
+                boost::asio::post(async_context_,
+                                  [on_subscribe = std::move(on_subscribe_callback),
+                                   subscription_id = subscription.id]() mutable {
+                                      on_subscribe(StompClientError::Ok,
+                                                   std::move(subscription_id));
+                                  });
+            } else if (on_subscribe_callback) {
+                subscription.pending_on_subscribe_callbacks.push_back(
+                    std::move(on_subscribe_callback));
+            }
+            return subscription.id;
+        }
+
+        // TODO: add log StompClient: Subscribing to {destination}
+        auto subscription{std::make_unique<Subscription>()};
+        subscription->id = GenerateSubscriptionId();
+        subscription->destination = destination;
+        subscription->listeners =
+            std::make_shared<const Listeners>(1, std::move(listener));
+        if (on_subscribe_callback) {
+            subscription->pending_on_subscribe_callbacks.push_back(
+                std::move(on_subscribe_callback));
+        }
+        if (ack_mode != StompAckMode::Auto) {
+            subscription->ack_batch =
+                std::make_shared<AckBatch>(connection_, ack_mode);
+        }
+        stomp_frame = MakeSubscribeFrame(*subscription);
+        subscription_id = subscription->id;
+        destinations_.emplace(subscription->destination, subscription.get());
+        subscriptions_.emplace(subscription->id, std::move(subscription));
+    }
 
-    websocket_client_.Send(stomp_frame.ToString(), on_websocket_sent_callback);
+    SendToWebSocket(std::move(stomp_frame), [this, subscription_id](auto result) {
+        OnWebSocketSentSubscribe(result, subscription_id);
+    });
 
     return subscription_id;
 }
@@ -276,12 +715,17 @@ void StompClient<WebSocketClient>::OnWebSocketConnected(boost::system::error_cod
 {
     if (result.failed()) {
         // TODO: put a log "StompClient: Could not connect to server: {result.message()}"
+        if (reconnecting_) {
+            ScheduleReconnect();
+            return;
+        }
         CallOnConnectedCallbackWithErrorIfValid(
             StompClientError::CouldNotConnectToWebSocketServer);
         return;
     }
 
     websocket_connected_ = true;
+    frame_decoder_.Reset();
 
     // TODO: use stomp_frame::MakeConnectFrame
     stomp_frame::BuildParameters parameters(StompCommand::Connect);
@@ -289,6 +733,14 @@ void StompClient<WebSocketClient>::OnWebSocketConnected(boost::system::error_cod
     parameters.headers.emplace(StompHeader::Host, websocket_client_.GetServerUrl());
     parameters.headers.emplace(StompHeader::Login, user_name_);
     parameters.headers.emplace(StompHeader::Passcode, user_password_);
+    // The headers only refer to their values: this one must outlive the build.
+    const auto& heart_beat{options_.heart_beat};
+    std::string heart_beat_value{};
+    if (heart_beat.outgoing.count() > 0 || heart_beat.incoming.count() > 0) {
+        heart_beat_value = std::to_string(heart_beat.outgoing.count()) + ',' +
+                           std::to_string(heart_beat.incoming.count());
+        parameters.headers.emplace(StompHeader::HeartBeat, heart_beat_value);
+    }
 
     StompError error;
     StompFrame frame = stomp_frame::Build(error, parameters);
@@ -299,8 +751,8 @@ void StompClient<WebSocketClient>::OnWebSocketConnected(boost::system::error_cod
         return;
     }
 
-    websocket_client_.Send(
-        frame.ToString(), [this](auto result) { OnWebSocketConnectMessageSent(result); });
+    SendToWebSocket(frame.ToString(),
+                    [this](auto result) { OnWebSocketConnectMessageSent(result); });
 }
 
 template <typename WebSocketClient>
@@ -316,15 +768,28 @@ void StompClient<WebSocketClient>::OnWebSocketConnectMessageSent(
 
 template <typename WebSocketClient>
 void StompClient<WebSocketClient>::OnWebSocketMessageReceived(
-    boost::system::error_code result, std::string&& message)
+    boost::system::error_code result, std::string_view message)
 {
     if (result.failed()) {
         // TODO: handle
         return;
     }
 
-    StompError stomp_error{};
-    StompFrame frame{stomp_error, std::move(message)};
+    // Any message, heart-beat or frame, shows that the server is alive.
+    last_received_time_.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                              std::memory_order_relaxed);
+    message_received_time_ = MetricsClock::Now();
+
+    // A WebSocket message may carry several STOMP frames, or only a part of one.
+    frame_decoder_.Push(message, [this](auto stomp_error, auto&& frame) {
+        HandleStompFrame(stomp_error, std::move(frame));
+    });
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::HandleStompFrame(StompError stomp_error,
+                                                    StompFrame&& frame)
+{
     if (stomp_error != StompError::Ok) {
         // TODO: log StompClient: Could not parse message as STOMP frame: {stomp_error}
         CallOnConnectedCallbackWithErrorIfValid(
@@ -363,11 +828,25 @@ void StompClient<WebSocketClient>::OnWebSocketDisconnected(
 {
     // TODO: log: StompClient: WebSocket connection disconnected: {result.message()}
     websocket_connected_ = false;
+    StopHeartBeat();
+    DropAcks();
+    if (options_.reconnect.enabled && !closing_) {
+        reconnecting_ = true;
+        ScheduleReconnect();
+        return;
+    }
+    CloseFrameStreams();
+    if (result) {
+        GetMetrics().stomp_client_errors.Add(
+            StompClientError::WebSocketServerDisconnected);
+    }
     if (on_disconnected_callback_) {
         auto error{result ? StompClientError::WebSocketServerDisconnected
                           : StompClientError::Ok};
         boost::asio::post(async_context_,
-                          [this, error]() { on_disconnected_callback_(error); });
+                          [on_disconnected = on_disconnected_callback_, error]() {
+                              on_disconnected(error);
+                          });
     }
 }
 
@@ -376,6 +855,10 @@ void StompClient<WebSocketClient>::OnWebSocketClosed(
     boost::system::error_code result,
     std::function<void(StompClientError)> on_close_callback)
 {
+    if (result.failed()) {
+        GetMetrics().stomp_client_errors.Add(
+            StompClientError::CouldNotCloseWebSocketConnection);
+    }
     if (on_close_callback) {
         auto error{result.failed() ? StompClientError::CouldNotCloseWebSocketConnection
                                    : StompClientError::Ok};
@@ -386,51 +869,388 @@ void StompClient<WebSocketClient>::OnWebSocketClosed(
 
 template <typename WebSocketClient>
 void StompClient<WebSocketClient>::OnWebSocketSentSubscribe(
-    boost::system::error_code result,
-    std::string& subscription_id,
-    Subscription&& subscription)
+    boost::system::error_code result, const std::string& subscription_id)
 {
-    if (result.failed()) {
-        // TODO: log StompClient: Could not subscribe to {subscribtion.destination}:
-        // {result.message}
-        if (subscription.on_subscribe_callback) {
-            boost::asio::post(
-                async_context_, [on_subscribe = subscription.on_subscribe_callback]() {
-                    on_subscribe(StompClientError::CouldNotSendSubscribeFrame, {});
-                });
-        }
+    if (!result.failed()) {
         return;
     }
 
-    subscriptions_.emplace(subscription_id, std::move(subscription));
+    // TODO: log StompClient: Could not subscribe to {subscription_id}: {result.message}
+    GetMetrics().stomp_client_errors.Add(StompClientError::CouldNotSendSubscribeFrame);
+    std::unique_ptr<Subscription> subscription{};
+    {
+        std::lock_guard<std::mutex> lock{subscriptions_mutex_};
+        auto subscription_iterator{subscriptions_.find(subscription_id)};
+        if (subscription_iterator == subscriptions_.end()) {
+            return;
+        }
+        subscription = std::move(subscription_iterator->second);
+        destinations_.erase(subscription->destination);
+        subscriptions_.erase(subscription_iterator);
+    }
+    if (!subscription->pending_on_subscribe_callbacks.empty()) {
+        boost::asio::post(async_context_, [subscription = std::move(subscription)]() {
+            for (const auto& on_subscribe :
+                 subscription->pending_on_subscribe_callbacks) {
+                on_subscribe(StompClientError::CouldNotSendSubscribeFrame, {});
+            }
+        });
+    }
 }
 
 template <typename WebSocketClient>
 void StompClient<WebSocketClient>::HandleStompConnected(StompFrame&& frame)
 {
     // TODO: log StompClient: Successfully connected to STOMP server
+    // Each side beats at the slower of what it can do and what the other side wants.
+    const auto& heart_beat{options_.heart_beat};
+    const auto [server_outgoing, server_incoming]{
+        ParseHeartBeat(frame.GetHeaderValue(StompHeader::HeartBeat))};
+    const std::chrono::milliseconds send_interval{
+        heart_beat.outgoing.count() > 0 && server_incoming.count() > 0
+            ? std::max(heart_beat.outgoing, server_incoming)
+            : std::chrono::milliseconds{0}};
+    const std::chrono::milliseconds receive_interval{
+        heart_beat.incoming.count() > 0 && server_outgoing.count() > 0
+            ? std::max(heart_beat.incoming, server_outgoing)
+            : std::chrono::milliseconds{0}};
+    StartHeartBeat(send_interval,
+                   std::chrono::duration_cast<std::chrono::milliseconds>(
+                       receive_interval * heart_beat.tolerance));
+
+    if (reconnecting_) {
+        reconnecting_ = false;
+        reconnect_attempts_ = 0;
+        ++reconnections_;
+        GetMetrics().stomp_reconnections.Add();
+        Resubscribe();
+        return;
+    }
     CallOnConnectedCallbackWithErrorIfValid(StompClientError::Ok);
 }
 
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::ScheduleReconnect()
+{
+    const auto& reconnect{options_.reconnect};
+    if (reconnect.max_attempts > 0 && reconnect_attempts_ >= reconnect.max_attempts) {
+        // TODO: log StompClient: Giving up reconnecting
+        reconnecting_ = false;
+        GetMetrics().stomp_client_errors.Add(
+            StompClientError::WebSocketServerDisconnected);
+        CloseFrameStreams();
+        if (on_disconnected_callback_) {
+            boost::asio::post(async_context_,
+                              [on_disconnected = on_disconnected_callback_]() {
+                                  on_disconnected(
+                                      StompClientError::WebSocketServerDisconnected);
+                              });
+        }
+        return;
+    }
+
+    GetMetrics().stomp_reconnect_attempts.Add();
+    reconnect_timer_.expires_after(GetReconnectDelay(reconnect_attempts_++));
+    reconnect_timer_.async_wait([this](auto error) {
+        if (error || closing_) {
+            return;
+        }
+        ConnectWebSocket();
+    });
+}
+
+template <typename WebSocketClient>
+std::chrono::milliseconds StompClient<WebSocketClient>::GetReconnectDelay(
+    std::size_t attempt)
+{
+    const auto& reconnect{options_.reconnect};
+    const auto max_delay{static_cast<double>(reconnect.max_delay.count())};
+    const auto delay{std::min(max_delay, reconnect.initial_delay.count() *
+                                             std::pow(reconnect.multiplier, attempt))};
+    std::uniform_real_distribution<double> jitter{1.0 - reconnect.jitter, 1.0};
+    return std::chrono::milliseconds{
+        static_cast<std::chrono::milliseconds::rep>(delay * jitter(random_engine_))};
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::Resubscribe()
+{
+    std::vector<std::string> frames{};
+    {
+        std::lock_guard<std::mutex> lock{subscriptions_mutex_};
+        frames.reserve(subscriptions_.size());
+        for (const auto& [subscription_id, subscription] : subscriptions_) {
+            // TODO: add log StompClient: Subscribing again to {destination}
+            frames.push_back(MakeSubscribeFrame(*subscription));
+        }
+    }
+    for (auto& frame : frames) {
+        // A failure drops the connection, which is handled by reconnecting again.
+        SendToWebSocket(std::move(frame));
+    }
+}
+
+template <typename WebSocketClient>
+std::string StompClient<WebSocketClient>::MakeSubscribeFrame(
+    const Subscription& subscription) const
+{
+    std::string ack_mode{"auto"};
+    if (subscription.ack_batch && subscription.ack_batch->mode == StompAckMode::Client) {
+        ack_mode = "client";
+    } else if (subscription.ack_batch) {
+        ack_mode = "client-individual";
+    }
+    // TODO: handle error ocurred when creating a frame
+    return stomp_frame::MakeSubscribeFrame(subscription.destination, subscription.id,
+                                           ack_mode, subscription.id)
+        .ToString();
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::CloseFrameStreams()
+{
+#ifdef NETWORK_MONITOR_COROUTINES
+    boost::asio::post(async_context_, [this]() {
+        for (const auto& frame_stream : frame_streams_) {
+            if (auto state{frame_stream.lock()}) {
+                // The acknowledgements were only valid on the connection.
+                for (auto& queued_frame : state->frames) {
+                    queued_frame.ack.reset();
+                }
+                state->closed = true;
+                state->signal.cancel();
+            }
+        }
+        frame_streams_.clear();
+    });
+#endif
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::OnMessageHandled(
+    const std::shared_ptr<AckBatch>& ack_batch,
+    const StompFrame& frame,
+    std::uint64_t generation)
+{
+    // The broker rejects the ACK IDs of another connection.
+    if (generation != connection_generation_) {
+        --ack_batch->in_flight;
+        return;
+    }
+
+    // STOMP 1.2 servers give the ACK ID in the `ack` header, older ones expect the
+    // message ID.
+    auto ack_id{frame.GetHeaderValue(StompHeader::Ack)};
+    if (ack_id.empty()) {
+        ack_id = frame.GetHeaderValue(StompHeader::MessageId);
+    }
+    if (ack_batch->mode == StompAckMode::Client && !ack_batch->ack_ids.empty()) {
+        ack_batch->ack_ids.back().assign(ack_id.data(), ack_id.size());
+    } else {
+        ack_batch->ack_ids.emplace_back(ack_id);
+    }
+    ++ack_batch->pending;
+
+    const auto& ack{options_.ack};
+    if (ack_batch->pending >= ack.batch_size ||
+        ack_batch->in_flight >= ack.max_in_flight) {
+        SendAcks(*ack_batch);
+        return;
+    }
+    if (!ack_batch->timer_armed) {
+        ack_batch->timer_armed = true;
+        ack_batch->timer.expires_after(ack.batch_delay);
+        ack_batch->timer.async_wait([this, ack_batch](auto result) {
+            // A cancelled wait means the batch was already sent or dropped.
+            if (result != boost::asio::error::operation_aborted &&
+                ack_batch->timer_armed) {
+                SendAcks(*ack_batch);
+            }
+        });
+    }
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::SendAcks(AckBatch& ack_batch)
+{
+    std::vector<StompFrame> frames{};
+    frames.reserve(ack_batch.ack_ids.size());
+    std::size_t message_size{0};
+    for (const auto& ack_id : ack_batch.ack_ids) {
+        frames.push_back(stomp_frame::MakeAckFrame(ack_id));
+        message_size += frames.back().GetSerializedSize();
+    }
+    std::string message{};
+    message.reserve(message_size);
+    for (const auto& frame : frames) {
+        frame.SerializeTo(message);
+    }
+    ack_batch.in_flight -= ack_batch.pending;
+    ack_batch.pending = 0;
+    ack_batch.ack_ids.clear();
+    ack_batch.timer_armed = false;
+    ack_batch.timer.cancel();
+    // A failure drops the connection, and the broker delivers the messages again.
+    SendToWebSocket(std::move(message));
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::DropAcks()
+{
+    // Acknowledgements are only valid on the connection that received the messages.
+    ++connection_generation_;
+    std::lock_guard<std::mutex> lock{subscriptions_mutex_};
+    for (const auto& [subscription_id, subscription] : subscriptions_) {
+        if (auto& ack_batch{subscription->ack_batch}) {
+            ack_batch->in_flight -= ack_batch->pending;
+            ack_batch->pending = 0;
+            ack_batch->ack_ids.clear();
+            ack_batch->timer_armed = false;
+            ack_batch->timer.cancel();
+        }
+    }
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::SendToWebSocket(
+    std::string message, std::function<void(boost::system::error_code)> on_sent)
+{
+    last_sent_time_.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                          std::memory_order_relaxed);
+    websocket_client_.Send(std::move(message), std::move(on_sent));
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::StartHeartBeat(
+    std::chrono::milliseconds send_interval, std::chrono::milliseconds receive_timeout)
+{
+    const auto now{std::chrono::steady_clock::now().time_since_epoch().count()};
+    last_received_time_.store(now, std::memory_order_relaxed);
+    last_sent_time_.store(now, std::memory_order_relaxed);
+
+    // A new generation leaves the wake-ups of the previous connection behind.
+    const auto generation{++heart_beat_generation_};
+    heart_beat_send_interval_ = send_interval;
+    heart_beat_receive_timeout_ = receive_timeout;
+    if (send_interval.count() > 0 || receive_timeout.count() > 0) {
+        ArmHeartBeatTimer(generation);
+    }
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::StopHeartBeat()
+{
+    ++heart_beat_generation_;
+    heart_beat_timer_.cancel();
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::ArmHeartBeatTimer(std::uint64_t generation)
+{
+    using Clock = std::chrono::steady_clock;
+    auto next_time{Clock::time_point::max()};
+    if (heart_beat_send_interval_.count() > 0) {
+        next_time = std::min(next_time, Clock::time_point{Clock::duration{
+                                            last_sent_time_.load()}} +
+                                            heart_beat_send_interval_);
+    }
+    if (heart_beat_receive_timeout_.count() > 0) {
+        next_time = std::min(next_time, Clock::time_point{Clock::duration{
+                                            last_received_time_.load()}} +
+                                            heart_beat_receive_timeout_);
+    }
+
+    heart_beat_timer_.expires_at(next_time);
+    heart_beat_timer_.async_wait([this, generation](auto error) {
+        if (error || generation != heart_beat_generation_) {
+            return;
+        }
+        OnHeartBeatTimer(generation);
+    });
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::OnHeartBeatTimer(std::uint64_t generation)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto now{Clock::now()};
+    const Clock::time_point last_received{Clock::duration{last_received_time_.load()}};
+    if (heart_beat_receive_timeout_.count() > 0 &&
+        now - last_received >= heart_beat_receive_timeout_) {
+        OnHeartBeatMissed();
+        return;
+    }
+
+    const Clock::time_point last_sent{Clock::duration{last_sent_time_.load()}};
+    if (heart_beat_send_interval_.count() > 0 &&
+        now - last_sent >= heart_beat_send_interval_) {
+        // A STOMP heart-beat is a single end-of-line.
+        SendToWebSocket("\n");
+    }
+    ArmHeartBeatTimer(generation);
+}
+
+template <typename WebSocketClient>
+void StompClient<WebSocketClient>::OnHeartBeatMissed()
+{
+    // TODO: log StompClient: Server heart-beat missed
+    // The connection is likely half-open, so its closing handshake is not awaited.
+    ++heart_beat_generation_;
+    websocket_client_.Close();
+    OnWebSocketDisconnected(boost::asio::error::timed_out);
+}
+
+template <typename WebSocketClient>
+std::pair<std::chrono::milliseconds, std::chrono::milliseconds>
+StompClient<WebSocketClient>::ParseHeartBeat(std::string_view heart_beat)
+{
+    // Format: "<outgoing>,<incoming>". A missing or malformed header means no beats.
+    const auto comma{heart_beat.find(',')};
+    if (comma == std::string_view::npos) {
+        return {};
+    }
+    const auto parse{[](std::string_view value) {
+        std::chrono::milliseconds::rep milliseconds{0};
+        const auto [end, error]{
+            std::from_chars(value.data(), value.data() + value.size(), milliseconds)};
+        if (error != std::errc{} || end != value.data() + value.size()) {
+            return std::chrono::milliseconds{0};
+        }
+        return std::chrono::milliseconds{milliseconds};
+    }};
+    return {parse(heart_beat.substr(0, comma)), parse(heart_beat.substr(comma + 1))};
+}
+
 template <typename WebSocketClient>
 void StompClient<WebSocketClient>::HandleStompReceipt(StompFrame&& frame)
 {
     // Supports only SUBSCRIBE frame.
     auto subscription_id{frame.GetHeaderValue(StompHeader::ReceiptId)};
-    auto subscription_iterator{subscriptions_.find(std::string(subscription_id))};
-    if (subscription_iterator == subscriptions_.end()) {
-        // TODO: log error StompClient:: Cannot find subscription {subscription_id}
-        return;
-    }
-    const auto& subscription{subscription_iterator->second};
+    std::vector<OnSubscribeCallback> on_subscribe_callbacks{};
+    {
+        std::lock_guard<std::mutex> lock{subscriptions_mutex_};
+        auto subscription_iterator{subscriptions_.find(subscription_id)};
+        if (subscription_iterator == subscriptions_.end()) {
+            // TODO: log error StompClient:: Cannot find subscription {subscription_id}
+            return;
+        }
+        auto& subscription{*subscription_iterator->second};
 
-    // TODO: add log StompClient: Successfully subscribed to {subscription_id}
-    if (subscription.on_subscribe_callback) {
-        boost::asio::post(
-            async_context_, [on_subscribe = subscription.on_subscribe_callback,
-                             subscription_id = std::string(subscription_id)]() mutable {
-                on_subscribe(StompClientError::Ok, std::move(subscription_id));
-            });
+        // TODO: add log StompClient: Successfully subscribed to {subscription_id}
+        // Only the first receipt is reported: later ones confirm subscriptions replayed
+        // after a reconnection.
+        subscription.confirmed = true;
+        on_subscribe_callbacks.swap(subscription.pending_on_subscribe_callbacks);
+    }
+    if (!on_subscribe_callbacks.empty()) {
+        boost::asio::post(async_context_,
+                          [on_subscribe_callbacks = std::move(on_subscribe_callbacks),
+                           subscription_id = std::string(subscription_id)]() {
+                              for (const auto& on_subscribe : on_subscribe_callbacks) {
+                                  on_subscribe(StompClientError::Ok,
+                                               std::string{subscription_id});
+                              }
+                          });
     }
 }
 
@@ -440,43 +1260,231 @@ void StompClient<WebSocketClient>::HandleStompMessage(StompFrame&& frame)
     // Find the subscription
     auto destination = frame.GetHeaderValue(StompHeader::Destination);
     auto message_id = frame.GetHeaderValue(StompHeader::MessageId);
-    auto subscription_id = std::string(frame.GetHeaderValue(StompHeader::Subscription));
+    auto subscription_id = frame.GetHeaderValue(StompHeader::Subscription);
 
     if (destination.empty() || message_id.empty() || subscription_id.empty()) {
         // TODO: add error log
         return;
     }
 
-    if (!subscriptions_.count(subscription_id)) {
-        // TODO: add error log
-        return;
+    std::shared_ptr<const Listeners> listeners{};
+    std::shared_ptr<AckBatch> ack_batch{};
+    {
+        std::lock_guard<std::mutex> lock{subscriptions_mutex_};
+        auto subscription_iterator{subscriptions_.find(subscription_id)};
+        if (subscription_iterator == subscriptions_.end()) {
+            // TODO: add error log
+            return;
+        }
+        const auto& subscription{*subscription_iterator->second};
+        if (subscription.destination != destination) {
+            // TODO: add error log
+            return;
+        }
+        listeners = subscription.listeners;
+        ack_batch = subscription.ack_batch;
     }
-    auto& subscription = subscriptions_.at(subscription_id);
-
-    if (subscription.destination != destination) {
-        // TODO: add error log
-        return;
+    if (ack_batch) {
+        ++ack_batch->in_flight;
     }
 
-    if (subscription.on_message_callback) {
-        boost::asio::post(async_context_,
-                          [on_message = subscription.on_message_callback,
-                           message_body = std::string(frame.GetBody())]() {
-                              on_message(StompClientError::Ok, std::string(message_body));
-                          });
-    }
+    // The frame borrows the WebSocket message, so keep one pooled copy that all the
+    // listeners share, and dispatch it with a single handler.
+    auto pooled_frame{frame_pool_.Acquire(frame)};
+    boost::asio::post(async_context_, [this, listeners = std::move(listeners),
+                                       ack_batch = std::move(ack_batch),
+                                       pooled_frame = std::move(pooled_frame),
+                                       received_time = message_received_time_,
+                                       generation = connection_generation_]() {
+        GetMetrics().stomp_dispatch_delay.RecordSince(received_time);
+        // The message is acknowledged once the listeners, and the frame streams that
+        // queued it, are done with it.
+        AckToken ack{};
+        if (ack_batch) {
+            const auto on_done{[this, ack_batch, pooled_frame, generation](void*) {
+                boost::asio::post(connection_,
+                                  [this, ack_batch, pooled_frame, generation]() {
+                                      OnMessageHandled(ack_batch, *pooled_frame,
+                                                       generation);
+                                  });
+            }};
+            ack = AckToken{nullptr, on_done};
+        }
+        for (const auto& listener : *listeners) {
+            if (listener.on_frame_callback) {
+                listener.on_frame_callback(StompClientError::Ok, pooled_frame);
+            }
+            if (listener.on_message_view_callback) {
+                listener.on_message_view_callback(StompClientError::Ok,
+                                                  pooled_frame->GetBody());
+            }
+            if (listener.on_message_callback) {
+                listener.on_message_callback(StompClientError::Ok,
+                                             std::string{pooled_frame->GetBody()});
+            }
+            if (listener.on_queued_frame_callback) {
+                listener.on_queued_frame_callback(pooled_frame, ack);
+            }
+        }
+    });
 }
 
 template <typename WebSocketClient>
 void StompClient<WebSocketClient>::CallOnConnectedCallbackWithErrorIfValid(
     StompClientError error)
 {
+    if (error != StompClientError::Ok) {
+        GetMetrics().stomp_client_errors.Add(error);
+    }
+    // Failures while reconnecting are retried instead of reported.
+    if (reconnecting_ && error != StompClientError::Ok) {
+        return;
+    }
     if (on_connected_callback_) {
         boost::asio::post(async_context_, [on_connected_callback = on_connected_callback_,
                                            error]() { on_connected_callback(error); });
     }
 }
 
+#ifdef NETWORK_MONITOR_COROUTINES
+template <typename WebSocketClient>
+const std::string& StompClient<WebSocketClient>::FrameStream::GetSubscriptionId() const
+{
+    return state_->subscription_id;
+}
+
+template <typename WebSocketClient>
+boost::asio::awaitable<StompFramePool::Handle>
+StompClient<WebSocketClient>::FrameStream::Next()
+{
+    // The frames are queued on the handlers strand, so they are pulled there too.
+    co_return co_await boost::asio::co_spawn(state_->signal.get_executor(),
+                                             NextOnStrand(state_),
+                                             boost::asio::use_awaitable);
+}
+
+template <typename WebSocketClient>
+boost::asio::awaitable<StompFramePool::Handle>
+StompClient<WebSocketClient>::FrameStream::NextOnStrand(std::shared_ptr<State> state)
+{
+    while (state->frames.empty() && !state->closed) {
+        boost::system::error_code error{};
+        co_await state->signal.async_wait(
+            boost::asio::redirect_error(boost::asio::use_awaitable, error));
+    }
+    if (state->frames.empty()) {
+        co_return StompFramePool::Handle{};
+    }
+    // Dropping the acknowledgement token of the frame acknowledges it.
+    auto frame{std::move(state->frames.front().frame)};
+    state->frames.pop_front();
+    co_return frame;
+}
+
+template <typename WebSocketClient>
+boost::asio::awaitable<StompClientError> StompClient<WebSocketClient>::AsyncConnect(
+    const std::string& user_name,
+    const std::string& user_password,
+    std::function<void(StompClientError)> on_disconnected_callback)
+{
+    co_return co_await boost::asio::co_spawn(
+        async_context_,
+        ConnectOnCallbackStrand(user_name, user_password,
+                                std::move(on_disconnected_callback)),
+        boost::asio::use_awaitable);
+}
+
+template <typename WebSocketClient>
+boost::asio::awaitable<
+    std::pair<StompClientError, typename StompClient<WebSocketClient>::FrameStream>>
+StompClient<WebSocketClient>::AsyncSubscribe(const std::string& destination,
+                                             StompAckMode ack_mode)
+{
+    co_return co_await boost::asio::co_spawn(
+        async_context_, SubscribeOnCallbackStrand(destination, ack_mode),
+        boost::asio::use_awaitable);
+}
+
+template <typename WebSocketClient>
+boost::asio::awaitable<StompClientError>
+StompClient<WebSocketClient>::ConnectOnCallbackStrand(
+    std::string user_name,
+    std::string user_password,
+    std::function<void(StompClientError)> on_disconnected_callback)
+{
+    // The state is shared with the handler, which may outlive the coroutine.
+    auto connected{std::make_shared<AwaitedResult<StompClientError>>(async_context_)};
+    Connect(
+        user_name, user_password,
+        [connected](auto result) {
+            connected->result = result;
+            connected->signal.cancel();
+        },
+        std::move(on_disconnected_callback));
+
+    while (!connected->result) {
+        boost::system::error_code error{};
+        co_await connected->signal.async_wait(
+            boost::asio::redirect_error(boost::asio::use_awaitable, error));
+    }
+    co_return *connected->result;
+}
+
+template <typename WebSocketClient>
+boost::asio::awaitable<
+    std::pair<StompClientError, typename StompClient<WebSocketClient>::FrameStream>>
+StompClient<WebSocketClient>::SubscribeOnCallbackStrand(std::string destination,
+                                                        StompAckMode ack_mode)
+{
+    FrameStream frame_stream{};
+    frame_stream.state_ = std::make_shared<typename FrameStream::State>(async_context_);
+    const auto is_dropped{[](const auto& stream) { return stream.expired(); }};
+    frame_streams_.erase(
+        std::remove_if(frame_streams_.begin(), frame_streams_.end(), is_dropped),
+        frame_streams_.end());
+    frame_streams_.push_back(frame_stream.state_);
+
+    // The stream signal also wakes up the coroutine for the subscription result, so
+    // that a client closed in the meantime does not leave it waiting. The handlers
+    // only keep the stream alive while its user does.
+    const auto& state{frame_stream.state_};
+    std::weak_ptr<typename FrameStream::State> weak_state{state};
+    auto subscribed{std::make_shared<std::optional<StompClientError>>()};
+    const auto capacity{std::max<std::size_t>(options_.frame_stream_capacity, 1)};
+    Listener listener{};
+    listener.on_queued_frame_callback = [weak_state, capacity](auto frame, auto ack) {
+        // The frames of a dropped stream are acknowledged without being queued.
+        const auto state{weak_state.lock()};
+        if (!state || state->closed) {
+            return;
+        }
+        if (state->frames.size() >= capacity) {
+            state->frames.pop_front();
+        }
+        state->frames.push_back({std::move(frame), std::move(ack)});
+        state->signal.cancel();
+    };
+    state->subscription_id = SubscribeInternal(
+        destination,
+        [subscribed, weak_state](auto result, auto&&) {
+            *subscribed = result;
+            if (const auto state{weak_state.lock()}) {
+                state->signal.cancel();
+            }
+        },
+        std::move(listener), ack_mode);
+
+    while (!*subscribed && !state->closed) {
+        boost::system::error_code error{};
+        co_await state->signal.async_wait(
+            boost::asio::redirect_error(boost::asio::use_awaitable, error));
+    }
+    const auto result{
+        subscribed->value_or(StompClientError::WebSocketServerDisconnected)};
+    co_return std::pair{result, std::move(frame_stream)};
+}
+#endif
+
 template <typename WebSocketClient>
 std::string StompClient<WebSocketClient>::GenerateSubscriptionId()
 {
@@ -15,12 +15,18 @@ struct BuildParameters {
     std::string body;
 };
 
-// TODO: make a version involving less copying
-// StompFrame Build(BuildParameters&& parameters);
-
 // TODO: rename to `BuildFrame` or `MakeFrame`
+/*! \brief Build a STOMP frame from its parts, serialized into a single buffer.
+ *
+ *  Empty header values are written as a pair of quotes. The result of the operation
+ *  is stored in the error code.
+ */
 StompFrame Build(StompError& error_code, const BuildParameters& parameters);
 
+/*! \brief Build a STOMP frame from its parts, reusing the body buffer for the frame.
+ */
+StompFrame Build(StompError& error_code, BuildParameters&& parameters);
+
 // Server frames.
 StompFrame MakeConnectedFrame(const std::string& version,
                               const std::string& session,
@@ -39,6 +45,7 @@ StompFrame MakeSubscribeFrame(const std::string& destination,
                               const std::string& id,
                               const std::string& ack,
                               const std::string& receipt);
+StompFrame MakeAckFrame(const std::string& id);
 
 }  // namespace stomp_frame
 }  // namespace NetworkMonitor
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <network-monitor/stomp-frame.hpp>
+#include <string>
+#include <string_view>
+
+namespace NetworkMonitor {
+
+/*! \brief Push-style decoder splitting a STOMP byte stream into frames.
+ *
+ *  The input can be cut anywhere: a chunk may hold several frames, a part of a frame,
+ *  or both. Bytes of an incomplete frame are kept until the rest arrives. The end of a
+ *  frame with a `content-length` header is found from the length, without scanning the
+ *  body. End-of-line bytes between frames (STOMP heart-beats) are skipped.
+ *
+ *  The internal buffer keeps its capacity between frames, so a decoder serving a long
+ *  lived connection stops allocating once it has seen the largest frame.
+ */
+class StompFrameDecoder {
+   public:
+    /*! \brief Handler for each decoded frame.
+     *
+     *  The frame borrows its content either from the chunk passed to `Push` or from
+     *  the decoder buffer, so it is only valid during the call. If the error is not
+     *  `StompError::Ok`, the frame bytes were delimited but could not be parsed.
+     */
+    using FrameHandler = std::function<void(StompError, StompFrame&&)>;
+
+    /*! \brief Decode a chunk of the stream.
+     *
+     *  `on_frame` is called once for each frame completed by this chunk, in order.
+     */
+    void Push(std::string_view chunk, const FrameHandler& on_frame);
+
+    /*! \brief Get the number of bytes held for the incomplete frame.
+     */
+    std::size_t GetPendingSize() const;
+
+    /*! \brief Drop the incomplete frame, if any.
+     */
+    void Reset();
+
+   private:
+    std::size_t Decode(std::string_view stream, const FrameHandler& on_frame);
+    std::size_t FindFrameSize(std::string_view pending);
+    void ResetSearch();
+
+    std::string buffer_{};
+
+    // State of the search for the end of the pending frame, in bytes from its start.
+    std::size_t scanned_{0};
+    std::size_t body_start_{std::string_view::npos};
+    std::size_t frame_size_{std::string_view::npos};
+};
+
+}  // namespace NetworkMonitor
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <network-monitor/stomp-frame.hpp>
+#include <string_view>
+
+namespace NetworkMonitor {
+
+/*! \brief Pool of recycled STOMP frames for the receive path.
+ *
+ *  Each pooled frame owns a buffer with a copy of its content and is parsed in place.
+ *  Frames are handed out through reference-counted handles. When the last handle to a
+ *  frame is dropped, the frame goes back to the pool and its buffer keeps its
+ *  capacity, so a pool in steady state serves frames without allocating.
+ *
+ *  The pool and its handles can be used from any thread. Handles can outlive the pool.
+ */
+class StompFramePool {
+   private:
+    struct Slot;
+    struct State;
+
+   public:
+    /*! \brief Default number of released frames kept for reuse.
+     */
+    static constexpr std::size_t default_max_free_slots{64};
+
+    /*! \brief Shared, read-only reference to a pooled frame.
+     *
+     *  Copying a handle only increments the reference count.
+     */
+    class Handle {
+       public:
+        Handle() = default;
+        Handle(const Handle& other);
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(const Handle& other);
+        Handle& operator=(Handle&& other) noexcept;
+        ~Handle();
+
+        const StompFrame& operator*() const;
+        const StompFrame* operator->() const;
+
+        /*! \brief Check if the handle refers to a frame.
+         */
+        explicit operator bool() const;
+
+       private:
+        friend class StompFramePool;
+
+        explicit Handle(Slot* slot);
+        void Release();
+
+        Slot* slot_{nullptr};
+    };
+
+    /*! \brief Pool usage counters.
+     */
+    struct Stats {
+        // Frames served from a released frame.
+        std::uint64_t hits{0};
+        // Frames that needed a new allocation.
+        std::uint64_t misses{0};
+        // Released frames currently waiting for reuse.
+        std::size_t free_slots{0};
+    };
+
+    /*! \brief Construct a pool keeping up to `max_free_slots` released frames.
+     */
+    explicit StompFramePool(std::size_t max_free_slots = default_max_free_slots);
+
+    /*! \brief Get a pooled frame parsed from a copy of `content`.
+     *
+     *  The result of the parsing is stored in the error code.
+     */
+    Handle Acquire(StompError& error_code, std::string_view content);
+
+    /*! \brief Get a pooled copy of a valid frame.
+     *
+     *  This is how a frame borrowing a transient buffer is kept for later use. Only the
+     *  header values and the body are copied, and the copy is not parsed again.
+     */
+    Handle Acquire(const StompFrame& frame);
+
+    /*! \brief Get the pool usage counters.
+     */
+    Stats GetStats() const;
+
+   private:
+    Slot* TakeSlot();
+
+    std::shared_ptr<State> state_;
+};
+
+}  // namespace NetworkMonitor
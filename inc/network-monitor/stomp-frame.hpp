@@ -1,8 +1,12 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <utility>
 
 namespace NetworkMonitor {
 
@@ -68,6 +72,82 @@ std::ostream& operator<<(std::ostream& os, const StompHeader& header);
  */
 std::string ToString(const StompHeader& header);
 
+/*! \brief Set of STOMP header values, indexed by `StompHeader`.
+ *
+ *  The values are stored inline in a fixed-size array, so filling the set never
+ *  allocates. The values are views: the buffer they point to must outlive the set.
+ *
+ *  The interface mirrors the subset of `std::unordered_map` used for frame headers.
+ *  Iteration visits the contained headers in the `StompHeader` declaration order.
+ */
+class StompHeaders {
+   public:
+    using value_type = std::pair<StompHeader, std::string_view>;
+
+    /*! \brief Forward iterator over the contained headers.
+     */
+    class Iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = StompHeaders::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        Iterator() = default;
+        Iterator(const StompHeaders* headers, std::size_t index);
+
+        value_type operator*() const;
+        Iterator& operator++();
+        Iterator operator++(int);
+        bool operator==(const Iterator& other) const;
+        bool operator!=(const Iterator& other) const;
+
+       private:
+        void SkipMissing();
+
+        const StompHeaders* headers_{nullptr};
+        std::size_t index_{0};
+    };
+
+    /*! \brief Insert a header value, unless the header is already in the set.
+     *
+     *  \returns true if the value was inserted.
+     */
+    bool emplace(StompHeader header, std::string_view value);
+
+    /*! \brief Get the number of occurrences of the header in the set, 0 or 1.
+     */
+    std::size_t count(StompHeader header) const;
+
+    /*! \brief Get the value of the header.
+     *
+     *  \throws std::out_of_range if the header is not in the set.
+     */
+    const std::string_view& at(StompHeader header) const;
+
+    /*! \brief Get the number of headers in the set.
+     */
+    std::size_t size() const;
+
+    /*! \brief Check if the set has no headers.
+     */
+    bool empty() const;
+
+    Iterator begin() const;
+    Iterator end() const;
+
+   private:
+    static constexpr std::size_t capacity_{
+        static_cast<std::size_t>(StompHeader::Version) + 1};
+    static_assert(capacity_ <= 32, "The header mask cannot hold all STOMP headers");
+
+    static std::size_t ToIndex(StompHeader header);
+
+    std::array<std::string_view, capacity_> values_{};
+    std::uint32_t mask_{0};
+};
+
 /*! \brief Error codes for the STOMP protocol
  */
 enum class StompError {
@@ -101,8 +181,16 @@ std::string ToString(const StompError& error);
 /* \brief STOMP frame representation, supporting STOMP v1.2.
  */
 class StompFrame {
-  public:
-    using Headers = std::unordered_map<StompHeader, std::string_view>;
+   public:
+    using Headers = StompHeaders;
+
+    /*! \brief Tag type selecting the constructor that borrows the frame content.
+     */
+    struct BorrowedContent {};
+
+    /*! \brief Tag value selecting the constructor that borrows the frame content.
+     */
+    static constexpr BorrowedContent borrowed_content{};
 
     /*! \brief Default constructor. Corresponds to an empty, invalid STOMP frame.
      */
@@ -124,13 +212,59 @@ class StompFrame {
      */
     StompFrame(StompError& error_code, std::string&& content);
 
+    /*! \brief Construct the STOMP frame from a borrowed buffer. Nothing is copied.
+     *
+     *  The command, headers and body are views into `content`, so the buffer must
+     *  outlive the frame and every copy of it. Parsing a valid frame this way does not
+     *  allocate.
+     *
+     *  The result of the operation is stored in the error code.
+     */
+    StompFrame(StompError& error_code, std::string_view content, BorrowedContent);
+
+    /*! \brief Construct the STOMP frame from its parts.
+     *
+     *  The parts are written into a single buffer allocated at the exact frame size.
+     *  The result is not parsed again: the header values are checked for newline and
+     *  null characters, then the frame is validated as a parsed one would be. The
+     *  result of the operation is stored in the error code.
+     */
+    StompFrame(StompError& error_code,
+               StompCommand command,
+               const Headers& headers,
+               std::string_view body);
+
+    /*! \brief Construct the STOMP frame from its parts, reusing the body buffer.
+     *
+     *  The command and headers are inserted in front of the body, so no allocation
+     *  happens if the body has enough spare capacity.
+     */
+    StompFrame(StompError& error_code,
+               StompCommand command,
+               const Headers& headers,
+               std::string&& body);
+
     /*! \brief Copy constructor.
+     *
+     *  The copy of a frame owning its content points into its own copy of the content.
+     *  The copy of a borrowing frame borrows the same buffer.
      */
     StompFrame(const StompFrame& other);
 
+    /*! \brief Copy a frame, making it borrow a copy of the bytes it views.
+     *
+     *  `copied_content` must be a copy of `other.GetViewedContent()`, and must outlive
+     *  the frame. The header values and the body of the copy point into it: the frame
+     *  is not parsed again.
+     */
+    StompFrame(const StompFrame& other, std::string_view copied_content, BorrowedContent);
+
     /*! \brief Move constructor.
+     *
+     *  The views move with the content, which is not copied unless it fits in the
+     *  string small buffer. The moved-from frame is left empty.
      */
-    StompFrame(StompFrame&& other);
+    StompFrame(StompFrame&& other) noexcept;
 
     /*! \brief Copy assignment operator.
      */
@@ -138,7 +272,7 @@ class StompFrame {
 
     /*! \brief Move assignment operator.
      */
-    StompFrame& operator=(StompFrame&& other);
+    StompFrame& operator=(StompFrame&& other) noexcept;
 
     /*! \brief Get the STOMP command.
      */
@@ -162,13 +296,35 @@ class StompFrame {
      */
     const std::string_view& GetBody() const;
 
+    /*! \brief Get the smallest range of bytes holding all header values and the body.
+     */
+    std::string_view GetViewedContent() const;
+
     /*! \brief Get a text representation of the frame.
      */
     std::string ToString() const;
 
+    /*! \brief Get the size of the text representation of the frame.
+     */
+    std::size_t GetSerializedSize() const;
+
+    /*! \brief Append the text representation of the frame to `output`.
+     *
+     *  The output grows at most once, to fit the frame exactly.
+     */
+    void SerializeTo(std::string& output) const;
+
    private:
-    StompError ParseFrame();
+    StompError ParseFrame(std::string_view plain_content);
+    StompError ParseContent(std::string_view plain_content, std::size_t command_end);
     StompError ValidateFrame();
+    StompError ValidateParts(StompCommand command,
+                             const Headers& headers,
+                             std::string_view body);
+    void WriteHead(StompCommand command, const Headers& headers);
+    void RebaseViews(const char* old_content,
+                     std::size_t content_size,
+                     const char* new_content);
 
     std::string plain_content_{};
     StompCommand command_{StompCommand::Invalid};
@@ -1,10 +1,17 @@
 #pragma once
 
-#include <map>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <istream>
 #include <memory>
+#include <network-monitor/copy-on-write-chunks.hpp>
+#include <network-monitor/file-downloader.hpp>
+#include <network-monitor/id-interner.hpp>
 #include <nlohmann/json.hpp>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace NetworkMonitor {
@@ -92,10 +99,56 @@ struct PassengerEvent {
     Type type{Type::In};
 };
 
+/*! \brief Outcome of recording a batch of passenger events.
+ */
+struct PassengerEventsReport {
+    // Number of events that were recorded.
+    std::size_t n_recorded{0};
+
+    // Positions, in the batch, of the events that were not recorded, in increasing
+    // order.
+    std::vector<std::size_t> rejected{};
+};
+
+/*! \brief A journey between two stations.
+ *
+ *  The journey is made of one step for each pair of adjacent stations travelled
+ *  through, in travel order.
+ */
+struct TravelRoute {
+    struct Step {
+        Id start_station_id{};
+        Id end_station_id{};
+        Id line_id{};
+        Id route_id{};
+        unsigned int travel_time{0};
+    };
+
+    Id start_station_id{};
+    Id end_station_id{};
+    unsigned int total_travel_time{0};
+    std::vector<Step> steps{};
+};
+
 /*! \brief Underground network representation
+ *
+ *  Passenger events can be recorded and passenger counts read from multiple threads
+ *  at once. All other methods, and in particular those that change the network
+ *  layout, must not run concurrently with any other method.
  */
 class TransportNetwork {
    public:
+    /*! \brief Handle to a station of the network.
+     *
+     *  A handle is resolved once from a station ID with `GetStationHandle` and can then
+     *  be passed to the handle-taking methods, which do no ID lookups at all.
+     */
+    using StationHandle = IdInterner::Handle;
+
+    /*! \brief Handle returned for stations that are not in the network.
+     */
+    static constexpr StationHandle invalid_station_handle{IdInterner::invalid_handle};
+
     /*! \brief Default constructor
      */
     TransportNetwork();
@@ -105,20 +158,29 @@ class TransportNetwork {
     ~TransportNetwork();
 
     /*! \brief Copy constructor
+     *
+     *  The copy shares the network layout with the original until either of them
+     *  adds stations or lines, and the travel times until either of them changes
+     *  them, so copying only costs the passenger counts. The two networks never see
+     *  each other's changes.
      */
     TransportNetwork(const TransportNetwork& copied);
 
     /*! \brief Move constructor
+     *
+     *  The moved network is left empty, and can still be used.
      */
     TransportNetwork(TransportNetwork&& moved);
 
     /*! \brief Copy assignment operator
      */
-    TransportNetwork& operator=(const TransportNetwork& copied) = default;
+    TransportNetwork& operator=(const TransportNetwork& copied);
 
     /*! \brief Move assignment operator
+     *
+     *  The moved network is left empty, and can still be used.
      */
-    TransportNetwork& operator=(TransportNetwork&& moved) = default;
+    TransportNetwork& operator=(TransportNetwork&& moved);
 
     /*! \brief Populate the network from a JSON object.
      *
@@ -135,6 +197,63 @@ class TransportNetwork {
      */
     bool FromJson(nlohmann::json&& source);
 
+    /*! \brief Populate the network from a JSON document read from a stream.
+     *
+     *  The document is parsed incrementally: no JSON object is built in memory and
+     *  stations, lines and travel times are added to the network as they are read.
+     *  The top-level sections may come in any order.
+     *
+     *  \returns false if stations and lines where parsed successfully, but not
+     *           the travel times.
+     *
+     *  \throws std::runtime_error This method throws if a required field is missing,
+     *                             or if there was an issue adding new stations or lines
+     *                             to the network.
+     *  \throws nlohmann::json::exception If the stream does not contain valid JSON.
+     */
+    bool FromJsonStream(std::istream& source);
+
+    /*! \brief Populate the network from a JSON file.
+     *
+     *  See FromJsonStream.
+     *
+     *  \throws std::runtime_error This method also throws if the file cannot be
+     *                             opened.
+     */
+    bool FromJsonFile(const std::filesystem::path& source);
+
+    /*! \brief Populate the network from a JSON document, parsed as it is downloaded.
+     *
+     *  The downloaded chunks are fed to the parser of FromJsonStream, which runs on
+     *  another thread, so that parsing overlaps the download.
+     *
+     *  \param cache If set, the document is also saved to this path. If the saved copy
+     *               is up to date, the network is populated from it, see FromJsonFile.
+     *
+     *  \throws std::runtime_error This method also throws if the download fails.
+     */
+    bool FromJsonDownload(FileDownloader& downloader,
+                          const std::string& file_url,
+                          const std::filesystem::path& cache = {});
+
+    /*! \brief Save the network to a binary snapshot file.
+     *
+     *  The snapshot holds the stations, lines, routes and travel times of the network
+     *  as fixed-width arrays, so that LoadSnapshot does not need to parse or validate
+     *  the layout again. Passenger counts are not saved.
+     *
+     *  \returns false if the file could not be written.
+     */
+    bool SaveSnapshot(const std::filesystem::path& destination) const;
+
+    /*! \brief Replace the network with the content of a binary snapshot file.
+     *
+     *  \returns false if the file is missing, was written by another snapshot
+     *           version, or is corrupted. The network is left untouched in that case,
+     *           so the caller can fall back to FromJson.
+     */
+    bool LoadSnapshot(const std::filesystem::path& source);
+
     /*! \brief Add a station to the network.
      *
      *  \returns false if there was an error while adding the station to the
@@ -165,25 +284,70 @@ class TransportNetwork {
      */
     bool RecordPassengerEvent(const PassengerEvent& event);
 
+    /*! \brief Record a passenger event at a station, given its handle.
+     *
+     *  \returns false if the handle does not belong to a station of the network or if
+     *           the passenger event is not reconized.
+     */
+    bool RecordPassengerEvent(StationHandle station, PassengerEvent::Type type);
+
+    /*! \brief Record a batch of passenger events.
+     *
+     *  Station IDs are resolved through a 64-entry cache that lives for the batch: a
+     *  station that recurs in the batch is resolved again only if another station has
+     *  taken its cache entry. The counter of each station is updated once for the
+     *  whole batch.
+     *
+     *  Events at unknown stations, or with an unknown type, are skipped and reported;
+     *  the other events are recorded.
+     */
+    PassengerEventsReport RecordPassengerEvents(
+        const std::vector<PassengerEvent>& events);
+
     /*! \brief Get the number of passengers currently recorded at a station.
      *
      *  The returned number can be negative: This happens if we start recording
      *  in the middle of the day and we record more exiting than entering
      *  passengers.
      *
+     *  While other threads record passenger events, the count includes the events
+     *  recorded so far; there is no ordering between the counts of different
+     *  stations.
+     *
      *  \throws std::runtime_error if the station is not in the network.
      */
     long long int GetPassengerCount(const Id& station) const;
 
+    /*! \brief Get the number of passengers currently recorded at a station, given its
+     *         handle.
+     *
+     *  \throws std::runtime_error if the handle does not belong to a station of the
+     *                             network.
+     */
+    long long int GetPassengerCount(StationHandle station) const;
+
+    /*! \brief Get the handle of a station.
+     *
+     *  \returns `invalid_station_handle` if the station is not in the network.
+     *
+     *  The handle stays valid for the lifetime of the network.
+     */
+    StationHandle GetStationHandle(std::string_view station) const;
+
     /*! \brief Get list of routes serving a given station.
      *
      *  \returns An empty vector if there was an error getting the list of
      *           routes serving the station, or if the station has legitimately
-     *           no routes serving it.
+     *           no routes serving it. Each route is listed once, in the order the
+     *           routes were added to the network.
      *
      *  The station must already be in the network.
+     *
+     *  The list is kept up to date as lines are added, so this method does not build
+     *  it. The returned reference is valid until the next change to the network
+     *  layout (new stations or lines), or until the network is destroyed.
      */
-    std::vector<Id> GetRoutesServingStation(const Id& station) const;
+    const std::vector<Id>& GetRoutesServingStation(const Id& station) const;
 
     /*! \brief Set the travel time between 2 adjacent stations.
      *
@@ -223,52 +387,83 @@ class TransportNetwork {
      *           two stations, or if station A and B are the same station.
      *
      *  The two stations must be both served by the `route`. The two stations
-     *  must already be in the network.
+     *  must already be in the network. If the route goes through a station more
+     *  than once, the shortest ride from `station_a` to `station_b` is used.
      */
     unsigned int GetTravelTime(const Id& line,
                                const Id& route,
                                const Id& station_a,
                                const Id& station_b) const;
 
-   private:
-    struct GraphNode;
-    struct GraphEdge;
-    struct RouteInternal;
-    struct LineInternal;
+    /*! \brief Get the fastest travel route between any 2 stations.
+     *
+     *  \param line_change_penalty  Time added to the journey every time it changes
+     *                              line. Changing route within the same line is free.
+     *
+     *  \returns A travel route with no steps if the two stations are not connected,
+     *           or if station A and B are the same station. The start and end station
+     *           IDs are empty if either station is not in the network.
+     *
+     *  The `total_travel_time` of the result includes the line change penalties.
+     */
+    TravelRoute GetFastestTravelRoute(const Id& station_a,
+                                      const Id& station_b,
+                                      unsigned int line_change_penalty = 0) const;
 
+   private:
+    // SAX handler used by FromJsonStream.
+    class JsonLayoutLoader;
+
+    // Publishes copies that also share the passenger counts.
+    friend class VersionedTransportNetwork;
+
+    // Stations, edges, routes and lines are stored in contiguous arrays and refer to
+    // each other through these dense indices. String IDs are only resolved at the
+    // public API boundary.
+    using StationIndex = std::uint32_t;
+    using EdgeIndex = std::uint32_t;
+    using RouteIndex = std::uint32_t;
+    using LineIndex = std::uint32_t;
+    // The position of a station within a route, numbered across all routes of the
+    // network. Route stops are the vertices of the fastest route search.
+    using StopIndex = std::uint32_t;
+
+    // The station ID is kept in `station_ids_`, under the station index.
     struct GraphNode {
         GraphNode(const Station& station);
 
-        Id id;
         std::string name;
-        long long int passenger_count{0};
-        std::vector<std::shared_ptr<GraphEdge>> edges{};
-
-        // FIXME: Possibly could be successfully turned into FindAnyEdgeToNextStation to
-        //        return only the first found match.
-        std::vector<std::shared_ptr<GraphEdge>> FindEdgesToNextStation(
-            const Id& next_station) const;
-        std::vector<std::shared_ptr<GraphEdge>> FindEdgesForRoute(
-            const std::shared_ptr<RouteInternal>& route) const;
-        // std::vector<std::shared_ptr<GraphEdge>>
-        // FindEdges(std::function<bool(const std::shared_ptr<GraphEdge>&)>) const;
     };
 
+    // Each counter has its own cache line, so that threads recording events at
+    // different stations do not contend. Copying a counter copies its current value.
+    struct alignas(64) PassengerCounter {
+        PassengerCounter() = default;
+        PassengerCounter(const PassengerCounter& copied);
+        PassengerCounter& operator=(const PassengerCounter& copied);
+
+        std::atomic<long long int> value{0};
+    };
+
+    // The travel time of an edge is in `edge_travel_times_`, under the edge index.
+    // `stop` is the route stop the edge leaves: a route can go through the same station
+    // more than once.
     struct GraphEdge {
-        GraphEdge(const std::shared_ptr<RouteInternal>& route,
-                  const std::shared_ptr<GraphNode>& next_station);
+        GraphEdge(RouteIndex route, StopIndex stop, StationIndex next_station);
 
-        std::shared_ptr<RouteInternal> route;
-        std::shared_ptr<GraphNode> next_station;
-        unsigned int travel_time{0};
+        RouteIndex route;
+        StopIndex stop;
+        StationIndex next_station;
     };
 
     struct RouteInternal {
-        RouteInternal(const Id& id, const std::shared_ptr<LineInternal>& line);
+        RouteInternal(const Id& id, LineIndex line);
 
         Id id;
-        std::shared_ptr<LineInternal> line;
-        std::vector<std::shared_ptr<GraphNode>> stations{};
+        LineIndex line;
+        // `stations[i]` is the stop `first_stop + i`.
+        StopIndex first_stop{0};
+        std::vector<StationIndex> stations{};
     };
 
     struct LineInternal {
@@ -276,21 +471,120 @@ class TransportNetwork {
 
         Id id;
         std::string name;
-        std::vector<std::shared_ptr<RouteInternal>> routes{};
+        std::vector<RouteIndex> routes{};
+    };
+
+    // An edge waiting to be merged into the adjacency arrays.
+    struct PendingEdge {
+        StationIndex station;
+        GraphEdge edge;
     };
 
     void AddStationInternal(const Station& station);
-    std::shared_ptr<LineInternal> CreateLineInternal(const Id& id,
-                                                     const std::string& name);
-    bool StationExists(const Id& station_id) const;
+    RouteIndex AddRouteInternal(RouteInternal&& route,
+                                std::vector<PendingEdge>& new_edges);
+    void AddLineInternal(LineInternal&& line);
+    void AddEdgesInternal(std::vector<PendingEdge>&& new_edges);
+    bool StationExists(std::string_view station_id) const;
     bool StationsExist(const std::vector<Route>& routes) const;
     bool StationsExist(const std::vector<Id>& stations) const;
     bool LineExists(const Line& line) const;
-    bool StationsAreAdjacend(const Id& station_a, const Id& station_b) const;
-    bool StationConnectsAnother(const Id& station_a, const Id& station_b) const;
+    bool RoutesAreUnique(const Line& line) const;
+    bool StationsAreAdjacend(StationIndex station_a, StationIndex station_b) const;
+    bool StationConnectsAnother(StationIndex station_a, StationIndex station_b) const;
+    const RouteInternal* FindRoute(const Id& line, const Id& route) const;
+    void SetEdgeTravelTime(EdgeIndex edge, unsigned int travel_time);
+
+    // Lazy, non-owning range over the edges of a station that lead to a given next
+    // station. It walks the station adjacency range when iterated, and is invalidated
+    // by any change to the network layout.
+    class EdgesToNextStation {
+       public:
+        class Iterator {
+           public:
+            EdgeIndex operator*() const;
+            Iterator& operator++();
+            bool operator==(const Iterator& other) const;
+            bool operator!=(const Iterator& other) const;
+
+           private:
+            friend class EdgesToNextStation;
+
+            Iterator(const EdgesToNextStation& range, EdgeIndex edge);
+            void SkipOtherStations();
+
+            const EdgesToNextStation* range_;
+            EdgeIndex edge_;
+        };
+
+        EdgesToNextStation(const std::vector<GraphEdge>& edges,
+                           EdgeIndex first,
+                           EdgeIndex last,
+                           StationIndex next_station);
+
+        Iterator begin() const;
+        Iterator end() const;
+        bool empty() const;
+        EdgeIndex front() const;
+
+       private:
+        const std::vector<GraphEdge>& edges_;
+        EdgeIndex first_;
+        EdgeIndex last_;
+        StationIndex next_station_;
+    };
+
+    EdgesToNextStation FindEdgesToNextStation(StationIndex station,
+                                              StationIndex next_station) const;
+
+    // The network layout: everything but the travel times and the passenger counts.
+    // Copies of the network share their layout until one of them changes it.
+    struct Layout {
+        std::vector<GraphNode> nodes{};
+        std::vector<RouteInternal> routes{};
+        std::vector<LineInternal> lines{};
+
+        // CSR adjacency: the edges leaving station `s` are
+        // `edges[edge_offsets[s]]` to `edges[edge_offsets[s + 1] - 1]`.
+        std::vector<GraphEdge> edges{};
+        std::vector<EdgeIndex> edge_offsets{0};
+
+        // Route stops: the route of each stop, and the stops of each station.
+        std::vector<RouteIndex> stop_routes{};
+        std::vector<std::vector<StopIndex>> station_stops{};
+
+        // The IDs of the routes through each station, without duplicates.
+        std::vector<std::vector<Id>> station_route_ids{};
+
+        // Station handles and station indices are the same thing: stations are
+        // interned in the order they are added to `nodes`. The same goes for lines.
+        IdInterner station_ids{};
+        IdInterner line_ids{};
+    };
+
+    // Unshare the layout before changing it.
+    Layout& MutableLayout();
+
+    // A copy that also shares the chunks of passenger counters with the original.
+    // Changing a shared counter copies its chunk, which is not thread-safe: passenger
+    // events must not be recorded on the copy from several threads at once.
+    struct SharePassengerCounts {};
+    TransportNetwork(const TransportNetwork& copied, SharePassengerCounts);
+
+    std::shared_ptr<Layout> layout_{std::make_shared<Layout>()};
+
+    // The network data that changes with updates is kept in copy-on-write chunks:
+    // copies of the network share them until either copy changes them.
+
+    // Indexed by edge.
+    CopyOnWriteChunks<unsigned int> edge_travel_times_{};
+
+    // Indexed by stop: the travel time from the first stop of the route. Kept up to
+    // date by SetTravelTime.
+    CopyOnWriteChunks<unsigned int> stop_travel_times_{};
 
-    std::map<Id, std::shared_ptr<GraphNode>> stations_{};
-    std::map<Id, std::shared_ptr<LineInternal>> lines_{};
+    // Only shared by copies made with `SharePassengerCounts`.
+    CopyOnWriteChunks<PassengerCounter> passenger_counts_{};
 };
 
 }  // namespace NetworkMonitor
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <network-monitor/transport-network.hpp>
+#include <utility>
+
+namespace NetworkMonitor {
+
+/*! \brief Transport network shared between one writer and many readers.
+ *
+ *  Readers get the current version of the network with `GetSnapshot`. A version
+ *  never changes once published, and it stays alive for as long as a reader holds a
+ *  snapshot of it, so readers can query it without any locking.
+ *
+ *  Writers apply their changes to a copy of the current version and publish the copy
+ *  as the next version. The copy shares the network layout, the travel times and the
+ *  passenger counts with the version it comes from, in copy-on-write chunks: an update
+ *  only copies the chunks it changes, and never the layout unless it adds stations or
+ *  lines.
+ */
+class VersionedTransportNetwork {
+   public:
+    /*! \brief A published version of the network.
+     */
+    struct Version {
+        // Versions are numbered from 0, in publishing order.
+        std::uint64_t number{0};
+        TransportNetwork network{};
+    };
+
+    using Snapshot = std::shared_ptr<const Version>;
+
+    /*! \brief Start from an empty network, as version 0.
+     */
+    VersionedTransportNetwork();
+
+    /*! \brief Start from the given network, as version 0.
+     */
+    explicit VersionedTransportNetwork(TransportNetwork network);
+
+    /*! \brief Get the current version of the network.
+     *
+     *  This method can be called from any thread, also while a writer publishes a new
+     *  version.
+     */
+    Snapshot GetSnapshot() const;
+
+    /*! \brief Publish a new version of the network.
+     *
+     *  `update` is called with a copy of the current network, which it can change
+     *  freely, e.g. with `SetTravelTime` or `RecordPassengerEvents`. Readers do not
+     *  see any of the changes until `update` returns and the copy is published.
+     *
+     *  The copy costs one pointer per chunk of travel times and passenger counts,
+     *  and the first change to a chunk in an update copies the chunk: batching
+     *  changes into one update is cheaper than publishing them one by one. Unlike on
+     *  other networks, `update` must not record passenger events from several
+     *  threads at once.
+     *
+     *  Concurrent calls are serialized. If `update` throws, no version is published.
+     *
+     *  \returns The number of the published version.
+     */
+    template <typename Update>
+    std::uint64_t Publish(Update&& update)
+    {
+        std::lock_guard<std::mutex> lock{writer_mutex_};
+        const auto current{GetSnapshot()};
+        auto next{std::make_shared<Version>(Version{
+            current->number + 1,
+            {current->network, TransportNetwork::SharePassengerCounts{}},
+        })};
+        std::forward<Update>(update)(next->network);
+        const auto number{next->number};
+        std::atomic_store(&current_, Snapshot{std::move(next)});
+        return number;
+    }
+
+   private:
+    Snapshot current_;
+    std::mutex writer_mutex_{};
+};
+
+}  // namespace NetworkMonitor
@@ -3,12 +3,119 @@
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
 #include <boost/beast/ssl.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <network-monitor/message-buffer-pool.hpp>
+#include <network-monitor/metrics.hpp>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace NetworkMonitor {
 
+/*! \brief Settings of the WebSocketClient outbound queue.
+ */
+struct WebSocketOutboundQueueOptions {
+    /*! \brief Number of queued bytes above which `Send` signals back-pressure.
+     */
+    std::size_t high_water_mark_bytes{1 << 20};
+
+    /*! \brief Size limit of a write merging several queued messages.
+     *
+     *  Queued messages are concatenated into a single WebSocket message while the result
+     *  fits in the limit. This is only safe for protocols that delimit their own frames,
+     *  like STOMP. Zero, the default, writes every message on its own.
+     */
+    std::size_t coalesce_limit_bytes{0};
+};
+
+/*! \brief Settings of the permessage-deflate extension (RFC 7692).
+ *
+ *  The extension is only used if the server accepts it during the handshake.
+ */
+struct WebSocketCompressionOptions {
+    /*! \brief Offer compression to the server.
+     */
+    bool enabled{false};
+
+    /*! \brief Base-2 logarithm of the LZ77 window used by the client, from 9 to 15.
+     */
+    int client_max_window_bits{15};
+
+    /*! \brief Base-2 logarithm of the LZ77 window requested from the server.
+     */
+    int server_max_window_bits{15};
+
+    /*! \brief Reset the client compressor after each message.
+     *
+     *  This saves the compressor memory between messages at the cost of compression
+     *  ratio on repetitive messages.
+     */
+    bool client_no_context_takeover{false};
+
+    /*! \brief Ask the server to reset its compressor after each message.
+     */
+    bool server_no_context_takeover{false};
+
+    /*! \brief zlib compression level, from 0 (no compression) to 9.
+     */
+    int compression_level{8};
+
+    /*! \brief zlib memory level, from 1 to 9. Higher values use more memory and are
+     *         faster.
+     */
+    int memory_level{4};
+
+    /*! \brief Outgoing messages smaller than this are sent uncompressed.
+     */
+    std::size_t threshold_bytes{0};
+};
+
+/*! \brief Settings of a WebSocketClient.
+ */
+struct WebSocketClientOptions {
+    WebSocketOutboundQueueOptions outbound_queue{};
+    WebSocketCompressionOptions compression{};
+};
+
+/*! \brief Counters of the WebSocketClient outbound queue.
+ */
+struct WebSocketOutboundQueueStats {
+    // Messages accepted by `Send` and not sent yet, including the one being written.
+    std::size_t queued_messages{0};
+    std::size_t queued_bytes{0};
+    // Messages whose write completed, successfully or not.
+    std::uint64_t sent_messages{0};
+    // Messages written as part of a merged write.
+    std::uint64_t coalesced_messages{0};
+};
+
+/*! \brief Byte counters of a WebSocketClient connection.
+ *
+ *  Message bytes are WebSocket payloads before compression. Wire bytes are what the TLS
+ *  layer exchanged with the socket, so they also include the handshakes, the framing
+ *  and the TLS records. Comparing the two shows what compression saves.
+ *
+ *  All the counters add up the traffic of every connection of the client.
+ */
+struct WebSocketTrafficStats {
+    std::uint64_t sent_message_bytes{0};
+    std::uint64_t received_message_bytes{0};
+    std::uint64_t sent_wire_bytes{0};
+    std::uint64_t received_wire_bytes{0};
+};
+
 /*! \brief Client to connect to a WebSocket server over plain TCP.
+ *
+ *  Threading model: the client makes its own strand from the io_context, and all of its
+ *  I/O and handlers run on it. The io_context can therefore be run from any number of
+ *  threads, and each client stays serialized. The public methods can be called from any
+ *  thread. Objects driven by the client can post to `GetExecutor()` to share its strand
+ *  instead of synchronizing with it.
  *
  *  \tparam Resolver        The class to resolve the URL to an IP address. It must support
  *                          the same interface of boost::asio::ip::tcp::resolver.
@@ -18,6 +125,18 @@ namespace NetworkMonitor {
 template <typename Resolver, typename WebSocketStream>
 class WebSocketClient {
    public:
+    /*! \brief Handler for a message viewed in the receive buffer.
+     *
+     *  The view is only valid during the call.
+     */
+    using MessageViewCallback =
+        std::function<void(boost::system::error_code, std::string_view)>;
+
+    /*! \brief Handler for a message copied into a pooled buffer owned by the receiver.
+     */
+    using PooledMessageCallback =
+        std::function<void(boost::system::error_code, MessageBufferPool::Buffer&&)>;
+
     /*! \brief Construct a WebSocket client.
      *
      *  \note This constructor does not initiate a connection.
@@ -29,69 +148,156 @@ class WebSocketClient {
      *  \param io_context   The io_context object. The user takes care of calling
      *                      ioc.run().
      *  \param tls_context  The TLS context to setup a TLS socket stream.
+     *  \param options      Settings of the outbound queue and of compression.
      */
     WebSocketClient(const std::string& url,
                     const std::string& endpoint,
                     const std::string& port,
                     boost::asio::io_context& io_context,
-                    boost::asio::ssl::context& tls_context);
+                    boost::asio::ssl::context& tls_context,
+                    WebSocketClientOptions options = {});
 
     /*! \brief Destructor.
      */
     ~WebSocketClient();
 
     /*! \brief Connect to the server.
+     *
+     *  The client can connect again once disconnected or closed. A new connection
+     *  resumes the TLS session of the previous one when the server allows it.
      *
      *  \param on_connect       Called when the connection fails or succeeds.
      *  \param on_message       Called only when a message is successfully
      *                          received. The message is an rvalue reference;
      *                          ownership is passed to the receiver.
      *  \param on_disconnect    Called when the connection is closed by the server
-     *                          or due to a connection error.
+     *                          or due to a connection error, but not after `Close`.
      */
     void Connect(std::function<void(boost::system::error_code)> on_connect = nullptr,
                  std::function<void(boost::system::error_code, std::string&&)>
                      on_message = nullptr,
                  std::function<void(boost::system::error_code)> on_disconnect = nullptr);
 
+    /*! \brief Connect to the server, viewing each message in the receive buffer.
+     *
+     *  Same as `Connect`, but messages are not copied out of the receive buffer.
+     *
+     *  \param on_message   Called only when a message is successfully received. The
+     *                      view is only valid during the call.
+     */
+    void ConnectWithMessageViews(
+        std::function<void(boost::system::error_code)> on_connect,
+        MessageViewCallback on_message,
+        std::function<void(boost::system::error_code)> on_disconnect = nullptr);
+
+    /*! \brief Connect to the server, passing each message in a pooled buffer.
+     *
+     *  Same as `Connect`, but messages are copied into recycled buffers, so receiving
+     *  stops allocating once the pool is warm. The buffer returns to the pool when the
+     *  receiver drops it.
+     *
+     *  \param on_message   Called only when a message is successfully received.
+     */
+    void ConnectWithPooledMessages(
+        std::function<void(boost::system::error_code)> on_connect,
+        PooledMessageCallback on_message,
+        std::function<void(boost::system::error_code)> on_disconnect = nullptr);
+
     /*! \brief Send a text message to the WebSocket server.
      *
-     *  \param message  The message to send. The caller must ensure that this
-     *                  string stays in scope until the onSend handler is called.
+     *  The message is queued and written once the writes queued before it complete.
+     *  This method can be called from any thread.
+     *
+     *  \param message  The message to send. The client owns it until it is sent.
      *  \param on_send  Called when a message is sent successfully or if it
      *                  failed to send.
+     *
+     *  \returns false if the queued bytes exceed the high-water mark. The message is
+     *           queued anyway; the caller should slow down until the queue drains.
      */
-    void Send(const std::string& message,
+    bool Send(std::string message,
               std::function<void(boost::system::error_code)> on_send_callback = nullptr);
 
     /*! \brief Close the WebSocket connection.
+     *
+     *  This method can be called from any thread.
      *
      *  \param on_close Called when the connection is closed, successfully or not.
      */
     void Close(std::function<void(boost::system::error_code)> on_close = nullptr);
 
+    /*! \brief Get the strand on which all the handlers of the client run.
+     */
+    boost::asio::strand<boost::asio::io_context::executor_type> GetExecutor() const;
+
+#ifdef NETWORK_MONITOR_COROUTINES
+    /*! \brief Connect to the server, for a coroutine.
+     *
+     *  Unlike `Connect`, no message is read until `AsyncReceive` is awaited, and no
+     *  handler is stored. `Send` and `Close` work as for the callback interface.
+     *
+     *  \returns The error of the connection.
+     */
+    boost::asio::awaitable<boost::system::error_code> AsyncConnect();
+
+    /*! \brief Receive the next message, for a coroutine connected with `AsyncConnect`.
+     *
+     *  \returns The error of the read and a view of the message in the receive buffer.
+     *           The view is valid until the next call.
+     */
+    boost::asio::awaitable<std::pair<boost::system::error_code, std::string_view>>
+    AsyncReceive();
+#endif
+
     // TODO: add brief
     const std::string& GetServerUrl() const;
     // TODO: add brief
     const std::string& GetServerPort() const;
 
+    /*! \brief Get the counters of the outbound queue.
+     */
+    WebSocketOutboundQueueStats GetOutboundQueueStats() const;
+
+    /*! \brief Get the byte counters of the connection.
+     */
+    WebSocketTrafficStats GetTrafficStats() const;
+
+    /*! \brief Check if the last TLS handshake resumed the previous session.
+     */
+    bool IsTlsSessionReused() const;
+
+    /*! \brief Get the counters of the pool used by `ConnectWithPooledMessages`.
+     */
+    MessageBufferPool::Stats GetMessagePoolStats() const;
+
    private:
+    struct OutboundMessage {
+        std::string message;
+        std::function<void(boost::system::error_code)> on_send_callback;
+    };
     void SaveProvidedCallbacks(
         std::function<void(boost::system::error_code)> on_connect = nullptr,
         std::function<void(boost::system::error_code, std::string&&)> on_message =
             nullptr,
         std::function<void(boost::system::error_code)> on_disconnect = nullptr);
+    void StartConnection();
+    void ResetStream();
     void ResolveServerUrl();
     void ConnectToServer(boost::asio::ip::tcp::resolver::results_type endpoint);
     void SetTcpStreamTimeoutToSuggested();
+    void PrepareTlsHandshake();
+    void SetCompressionOption();
+    void UpdateWireBytes();
     void HandshakeTls();
     void HandshakeWebSocket();
     void ListenToIncomingMessage(const boost::system::error_code& error);
-    std::string ReadMessage(const size_t received_bytes_count);
+    void WriteNextMessages();
+    void OnMessagesWritten(const boost::system::error_code& error,
+                           const std::size_t messages_count);
 
     void CallOnConnectCallbackIfExists(const boost::system::error_code& error);
     void CallOnMessageCallbackIfExists(const boost::system::error_code& error,
-                                       std::string&& message);
+                                       std::string_view message);
 
     void OnServerUrlResolved(boost::asio::ip::tcp::resolver::results_type results);
     void OnConnectedToServer(const boost::system::error_code& error);
@@ -100,19 +306,61 @@ class WebSocketClient {
     void OnMessageReceived(const boost::system::error_code& error,
                            const size_t received_bytes_count);
 
+#ifdef NETWORK_MONITOR_COROUTINES
+    boost::asio::awaitable<boost::system::error_code> ConnectOnStrand();
+    boost::asio::awaitable<std::pair<boost::system::error_code, std::string_view>>
+    ReceiveOnStrand();
+
+    // Size of the message last returned by `AsyncReceive`, consumed by the next one.
+    std::size_t received_size_{0};
+#endif
+
     const std::string server_url_{};
     const std::string server_endpoint_{};
     const std::string server_port_{};
 
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+    boost::asio::ssl::context& tls_context_;
+
+    // Both run on `strand_`. The stream is replaced for every new connection.
     Resolver resolver_;
-    WebSocketStream websocket_stream_;
+    std::optional<WebSocketStream> websocket_stream_;
+    bool stream_used_{false};
+
+    // Session of the previous connection, offered for resumption.
+    std::unique_ptr<SSL_SESSION, decltype(&SSL_SESSION_free)> tls_session_{
+        nullptr, SSL_SESSION_free};
+    std::atomic<bool> tls_session_reused_{false};
 
     boost::beast::flat_buffer response_buffer_{};
     bool closed_{true};
 
+    const WebSocketClientOptions options_;
+    // Only accessed on the stream strand.
+    std::deque<OutboundMessage> outbound_queue_{};
+    std::string coalesced_buffer_{};
+    bool write_in_progress_{false};
+    // Written on the stream strand or by Send, read from any thread.
+    std::atomic<std::size_t> queued_messages_{0};
+    std::atomic<std::size_t> queued_bytes_{0};
+    std::atomic<std::uint64_t> sent_messages_{0};
+    std::atomic<std::uint64_t> coalesced_messages_{0};
+    // Written on the stream strand, read from any thread.
+    std::atomic<std::uint64_t> sent_message_bytes_{0};
+    std::atomic<std::uint64_t> received_message_bytes_{0};
+    std::atomic<std::uint64_t> sent_wire_bytes_{0};
+    std::atomic<std::uint64_t> received_wire_bytes_{0};
+    // Wire bytes of the previous connections. Only accessed on the stream strand.
+    std::uint64_t previous_sent_wire_bytes_{0};
+    std::uint64_t previous_received_wire_bytes_{0};
+
     std::function<void(boost::system::error_code)> on_connect_callback_;
     std::function<void(boost::system::error_code, std::string&&)> on_message_callback_;
+    MessageViewCallback on_message_view_callback_;
+    PooledMessageCallback on_pooled_message_callback_;
     std::function<void(boost::system::error_code)> on_disconnect_callback_;
+
+    MessageBufferPool message_pool_{};
 };
 
 template <typename Resolver, typename WebSocketStream>
@@ -121,13 +369,18 @@ WebSocketClient<Resolver, WebSocketStream>::WebSocketClient(
     const std::string& endpoint,
     const std::string& port,
     boost::asio::io_context& io_context,
-    boost::asio::ssl::context& tls_context)
+    boost::asio::ssl::context& tls_context,
+    WebSocketClientOptions options)
     : server_url_{url},
       server_endpoint_{endpoint},
       server_port_{port},
-      resolver_{boost::asio::make_strand(io_context)},
-      websocket_stream_{boost::asio::make_strand(io_context), tls_context}
+      strand_{boost::asio::make_strand(io_context)},
+      tls_context_{tls_context},
+      resolver_{strand_},
+      websocket_stream_{std::in_place, strand_, tls_context},
+      options_{options}
 {
+    SetCompressionOption();
 }
 
 template <typename Resolver, typename WebSocketStream>
@@ -141,7 +394,37 @@ void WebSocketClient<Resolver, WebSocketStream>::Connect(
 {
     SaveProvidedCallbacks(std::move(on_connect), std::move(on_message),
                           std::move(on_disconnect));
-    ResolveServerUrl();
+    boost::asio::post(strand_, [this]() { StartConnection(); });
+}
+
+template <typename Resolver, typename WebSocketStream>
+void WebSocketClient<Resolver, WebSocketStream>::ConnectWithMessageViews(
+    std::function<void(boost::system::error_code)> on_connect,
+    MessageViewCallback on_message,
+    std::function<void(boost::system::error_code)> on_disconnect)
+{
+    SaveProvidedCallbacks(std::move(on_connect), nullptr, std::move(on_disconnect));
+    if (on_message) {
+        on_message_callback_ = nullptr;
+        on_message_view_callback_ = std::move(on_message);
+        on_pooled_message_callback_ = nullptr;
+    }
+    boost::asio::post(strand_, [this]() { StartConnection(); });
+}
+
+template <typename Resolver, typename WebSocketStream>
+void WebSocketClient<Resolver, WebSocketStream>::ConnectWithPooledMessages(
+    std::function<void(boost::system::error_code)> on_connect,
+    PooledMessageCallback on_message,
+    std::function<void(boost::system::error_code)> on_disconnect)
+{
+    SaveProvidedCallbacks(std::move(on_connect), nullptr, std::move(on_disconnect));
+    if (on_message) {
+        on_message_callback_ = nullptr;
+        on_message_view_callback_ = nullptr;
+        on_pooled_message_callback_ = std::move(on_message);
+    }
+    boost::asio::post(strand_, [this]() { StartConnection(); });
 }
 
 template <typename Resolver, typename WebSocketStream>
@@ -155,12 +438,48 @@ void WebSocketClient<Resolver, WebSocketStream>::SaveProvidedCallbacks(
     }
     if (on_message) {
         on_message_callback_ = std::move(on_message);
+        on_message_view_callback_ = nullptr;
+        on_pooled_message_callback_ = nullptr;
     }
     if (on_disconnect) {
         on_disconnect_callback_ = std::move(on_disconnect);
     }
 }
 
+template <typename Resolver, typename WebSocketStream>
+void WebSocketClient<Resolver, WebSocketStream>::StartConnection()
+{
+    // A WebSocket stream cannot be reopened once it has been used.
+    if (stream_used_) {
+        ResetStream();
+    }
+    stream_used_ = true;
+    ResolveServerUrl();
+}
+
+template <typename Resolver, typename WebSocketStream>
+void WebSocketClient<Resolver, WebSocketStream>::ResetStream()
+{
+    // With TLS 1.3 the session tickets arrive after the handshake, so the session is
+    // taken from the connection that is ending rather than right after the handshake.
+    auto* session{SSL_get1_session(websocket_stream_->next_layer().native_handle())};
+    if (session != nullptr && SSL_SESSION_is_resumable(session) == 1) {
+        tls_session_.reset(session);
+    } else if (session != nullptr) {
+        SSL_SESSION_free(session);
+    }
+
+    // The wire byte counters of the BIO start from zero with the new stream.
+    UpdateWireBytes();
+    previous_sent_wire_bytes_ = sent_wire_bytes_.load(std::memory_order_relaxed);
+    previous_received_wire_bytes_ = received_wire_bytes_.load(std::memory_order_relaxed);
+
+    // Pending operations on the old stream complete with an error.
+    websocket_stream_.emplace(strand_, tls_context_);
+    response_buffer_.clear();
+    SetCompressionOption();
+}
+
 template <typename Resolver, typename WebSocketStream>
 void WebSocketClient<Resolver, WebSocketStream>::ResolveServerUrl()
 {
@@ -187,7 +506,7 @@ template <typename Resolver, typename WebSocketStream>
 void WebSocketClient<Resolver, WebSocketStream>::ConnectToServer(
     boost::asio::ip::tcp::resolver::results_type endpoint)
 {
-    auto& tcp_stream = boost::beast::get_lowest_layer(websocket_stream_);
+    auto& tcp_stream = boost::beast::get_lowest_layer(*websocket_stream_);
     tcp_stream.expires_after(std::chrono::seconds(5));
     tcp_stream.async_connect(*endpoint,
                              [this](auto error) { OnConnectedToServer(error); });
@@ -203,27 +522,65 @@ void WebSocketClient<Resolver, WebSocketStream>::OnConnectedToServer(
     }
 
     SetTcpStreamTimeoutToSuggested();
+    PrepareTlsHandshake();
+    HandshakeTls();
+}
 
+template <typename Resolver, typename WebSocketStream>
+void WebSocketClient<Resolver, WebSocketStream>::PrepareTlsHandshake()
+{
     // Set the host name before the TLS handshake or the connection will fail
-    SSL_set_tlsext_host_name(websocket_stream_.next_layer().native_handle(),
-                             server_url_.c_str());
-
-    HandshakeTls();
+    auto* tls_handle{websocket_stream_->next_layer().native_handle()};
+    SSL_set_tlsext_host_name(tls_handle, server_url_.c_str());
+    if (tls_session_) {
+        SSL_set_session(tls_handle, tls_session_.get());
+    }
 }
 
 template <typename Resolver, typename WebSocketStream>
 void WebSocketClient<Resolver, WebSocketStream>::SetTcpStreamTimeoutToSuggested()
 {
-    auto& tcp_stream = boost::beast::get_lowest_layer(websocket_stream_);
+    auto& tcp_stream = boost::beast::get_lowest_layer(*websocket_stream_);
     tcp_stream.expires_never();
-    websocket_stream_.set_option(boost::beast::websocket::stream_base::timeout::suggested(
-        boost::beast::role_type::client));
+    websocket_stream_->set_option(
+        boost::beast::websocket::stream_base::timeout::suggested(
+            boost::beast::role_type::client));
+}
+
+template <typename Resolver, typename WebSocketStream>
+void WebSocketClient<Resolver, WebSocketStream>::SetCompressionOption()
+{
+    const auto& compression{options_.compression};
+    boost::beast::websocket::permessage_deflate option{};
+    option.client_enable = compression.enabled;
+    option.client_max_window_bits = compression.client_max_window_bits;
+    option.server_max_window_bits = compression.server_max_window_bits;
+    option.client_no_context_takeover = compression.client_no_context_takeover;
+    option.server_no_context_takeover = compression.server_no_context_takeover;
+    option.compLevel = compression.compression_level;
+    option.memLevel = compression.memory_level;
+    option.msg_size_threshold = compression.threshold_bytes;
+    websocket_stream_->set_option(option);
+}
+
+template <typename Resolver, typename WebSocketStream>
+void WebSocketClient<Resolver, WebSocketStream>::UpdateWireBytes()
+{
+    // The TLS engine reads and writes the socket through this BIO.
+    auto* bio{SSL_get_rbio(websocket_stream_->next_layer().native_handle())};
+    if (bio == nullptr) {
+        return;
+    }
+    sent_wire_bytes_.store(previous_sent_wire_bytes_ + BIO_number_written(bio),
+                           std::memory_order_relaxed);
+    received_wire_bytes_.store(previous_received_wire_bytes_ + BIO_number_read(bio),
+                               std::memory_order_relaxed);
 }
 
 template <typename Resolver, typename WebSocketStream>
 void WebSocketClient<Resolver, WebSocketStream>::HandshakeTls()
 {
-    websocket_stream_.next_layer().async_handshake(
+    websocket_stream_->next_layer().async_handshake(
         boost::asio::ssl::stream_base::handshake_type::client,
         [this](auto error) { OnTlsHandshakeCompleted(error); });
 }
@@ -236,6 +593,8 @@ void WebSocketClient<Resolver, WebSocketStream>::OnTlsHandshakeCompleted(
         CallOnConnectCallbackIfExists(error);
         return;
     }
+    tls_session_reused_ =
+        SSL_session_reused(websocket_stream_->next_layer().native_handle()) == 1;
     HandshakeWebSocket();
 }
 
@@ -243,7 +602,7 @@ template <typename Resolver, typename WebSocketStream>
 void WebSocketClient<Resolver, WebSocketStream>::HandshakeWebSocket()
 {
     const std::string connection_host{server_url_ + ':' + server_port_};
-    websocket_stream_.async_handshake(connection_host, server_endpoint_,
+    websocket_stream_->async_handshake(connection_host, server_endpoint_,
                                       [this](const boost::system::error_code& error) {
                                           OnWebSocketHandshakeCompleted(error);
                                       });
@@ -255,12 +614,15 @@ void WebSocketClient<Resolver, WebSocketStream>::OnWebSocketHandshakeCompleted(
 {
     // FIXME: this return on error prevents calling the remaining stuff if there's
     //        an error and even so wants to pass the error to them
+    // The connection is open before the callback runs, so that it can close it.
+    if (!error.failed()) {
+        closed_ = false;
+    }
     CallOnConnectCallbackIfExists(error);
     if (error.failed()) {
         return;
     }
     ListenToIncomingMessage(error);
-    closed_ = false;
 }
 
 template <typename Resolver, typename WebSocketStream>
@@ -282,7 +644,7 @@ void WebSocketClient<Resolver, WebSocketStream>::ListenToIncomingMessage(
         }
         return;
     }
-    websocket_stream_.async_read(response_buffer_,
+    websocket_stream_->async_read(response_buffer_,
                                  [this](auto error, auto received_bytes_count) {
                                      OnMessageReceived(error, received_bytes_count);
                                  });
@@ -292,59 +654,248 @@ template <typename Resolver, typename WebSocketStream>
 void WebSocketClient<Resolver, WebSocketStream>::OnMessageReceived(
     const boost::system::error_code& error, const size_t received_bytes_count)
 {
-    // FIXME: this return on error prevents calling the remaining stuff if there's
-    //        an error and even so wants to pass the error to them
     if (error) {
+        // After Close, the end of the connection is expected.
+        if (!closed_) {
+            closed_ = true;
+            if (on_disconnect_callback_) {
+                on_disconnect_callback_(error);
+            }
+        }
         return;
     }
-    CallOnMessageCallbackIfExists(error, ReadMessage(received_bytes_count));
+    // The message is delivered straight from the receive buffer, which is only
+    // released after the callback returns.
+    const auto received_data{response_buffer_.data()};
+    received_message_bytes_.fetch_add(received_data.size(), std::memory_order_relaxed);
+    UpdateWireBytes();
+    GetMetrics().websocket_messages_received.Add();
+    GetMetrics().websocket_bytes_received.Add(received_data.size());
+    CallOnMessageCallbackIfExists(
+        error, {static_cast<const char*>(received_data.data()), received_data.size()});
+    response_buffer_.consume(received_bytes_count);
     ListenToIncomingMessage(error);
 }
 
 template <typename Resolver, typename WebSocketStream>
-std::string WebSocketClient<Resolver, WebSocketStream>::ReadMessage(
-    const size_t received_bytes_count)
+void WebSocketClient<Resolver, WebSocketStream>::CallOnMessageCallbackIfExists(
+    const boost::system::error_code& error, std::string_view message)
 {
-    std::string message{boost::beast::buffers_to_string(response_buffer_.data())};
-    response_buffer_.consume(received_bytes_count);
-    return message;
+    if (on_message_view_callback_) {
+        on_message_view_callback_(error, message);
+    } else if (on_pooled_message_callback_) {
+        on_pooled_message_callback_(error, message_pool_.Acquire(message));
+    } else if (on_message_callback_) {
+        on_message_callback_(error, std::string{message});
+    }
 }
 
 template <typename Resolver, typename WebSocketStream>
-void WebSocketClient<Resolver, WebSocketStream>::CallOnMessageCallbackIfExists(
-    const boost::system::error_code& error, std::string&& message)
+bool WebSocketClient<Resolver, WebSocketStream>::Send(
+    std::string message,
+    std::function<void(boost::system::error_code)> on_send_callback)
+{
+    const auto message_size{message.size()};
+    const auto queued_bytes{queued_bytes_.fetch_add(message_size) + message_size};
+    queued_messages_.fetch_add(1);
+
+    auto enqueue{[this, message = std::move(message),
+                  on_send_callback = std::move(on_send_callback)]() mutable {
+        outbound_queue_.push_back({std::move(message), std::move(on_send_callback)});
+        if (!write_in_progress_) {
+            WriteNextMessages();
+        }
+    }};
+    boost::asio::post(strand_, std::move(enqueue));
+
+    return queued_bytes <= options_.outbound_queue.high_water_mark_bytes;
+}
+
+template <typename Resolver, typename WebSocketStream>
+void WebSocketClient<Resolver, WebSocketStream>::WriteNextMessages()
 {
-    if (on_message_callback_) {
-        on_message_callback_(error, std::move(message));
+    write_in_progress_ = true;
+
+    // Count the queued messages fitting in a single write.
+    std::size_t messages_count{1};
+    std::size_t write_size{outbound_queue_.front().message.size()};
+    while (options_.outbound_queue.coalesce_limit_bytes > 0 &&
+           messages_count < outbound_queue_.size()) {
+        const auto next_size{outbound_queue_[messages_count].message.size()};
+        if (write_size + next_size > options_.outbound_queue.coalesce_limit_bytes) {
+            break;
+        }
+        write_size += next_size;
+        ++messages_count;
+    }
+
+    auto on_write{[this, messages_count](auto error, auto) {
+        OnMessagesWritten(error, messages_count);
+    }};
+
+    if (messages_count == 1) {
+        websocket_stream_->async_write(
+            boost::asio::buffer(outbound_queue_.front().message), std::move(on_write));
+        return;
+    }
+
+    // The buffer keeps its capacity, so merging stops allocating in steady state.
+    coalesced_buffer_.clear();
+    coalesced_buffer_.reserve(write_size);
+    for (std::size_t index{0}; index < messages_count; ++index) {
+        coalesced_buffer_ += outbound_queue_[index].message;
     }
+    coalesced_messages_.fetch_add(messages_count);
+    websocket_stream_->async_write(boost::asio::buffer(coalesced_buffer_),
+                                  std::move(on_write));
 }
 
 template <typename Resolver, typename WebSocketStream>
-void WebSocketClient<Resolver, WebSocketStream>::Send(
-    const std::string& message,
-    std::function<void(boost::system::error_code)> on_send_callback)
+void WebSocketClient<Resolver, WebSocketStream>::OnMessagesWritten(
+    const boost::system::error_code& error, const std::size_t messages_count)
 {
-    websocket_stream_.async_write(boost::asio::buffer(message),
-                                  [this, on_send_callback](auto error, auto) {
-                                      if (on_send_callback) {
-                                          on_send_callback(error);
-                                      }
-                                  });
+    if (!error) {
+        std::size_t written_bytes{0};
+        for (std::size_t index{0}; index < messages_count; ++index) {
+            written_bytes += outbound_queue_[index].message.size();
+        }
+        sent_message_bytes_.fetch_add(written_bytes, std::memory_order_relaxed);
+        UpdateWireBytes();
+        GetMetrics().websocket_messages_sent.Add(messages_count);
+        GetMetrics().websocket_bytes_sent.Add(written_bytes);
+    }
+
+    for (std::size_t index{0}; index < messages_count; ++index) {
+        auto on_send_callback{std::move(outbound_queue_.front().on_send_callback)};
+        queued_bytes_.fetch_sub(outbound_queue_.front().message.size());
+        queued_messages_.fetch_sub(1);
+        sent_messages_.fetch_add(1);
+        outbound_queue_.pop_front();
+
+        if (on_send_callback) {
+            on_send_callback(error);
+        }
+    }
+
+    // Sends issued by the callbacks are posted, so they start their own write if needed.
+    write_in_progress_ = false;
+    if (!outbound_queue_.empty()) {
+        WriteNextMessages();
+    }
 }
 
 template <typename Resolver, typename WebSocketStream>
 void WebSocketClient<Resolver, WebSocketStream>::Close(
     std::function<void(boost::system::error_code)> on_close_callback)
 {
-    websocket_stream_.async_close(boost::beast::websocket::close_code::none,
-                                  [on_close_callback](auto error_code) {
-                                      if (on_close_callback) {
-                                          on_close_callback(error_code);
-                                      }
-                                  });
-    closed_ = true;
+    boost::asio::post(strand_, [this, on_close = std::move(on_close_callback)]() {
+        closed_ = true;
+        websocket_stream_->async_close(boost::beast::websocket::close_code::none,
+                                      [on_close](auto error_code) {
+                                          if (on_close) {
+                                              on_close(error_code);
+                                          }
+                                      });
+    });
 }
 
+template <typename Resolver, typename WebSocketStream>
+boost::asio::strand<boost::asio::io_context::executor_type>
+WebSocketClient<Resolver, WebSocketStream>::GetExecutor() const
+{
+    return strand_;
+}
+
+#ifdef NETWORK_MONITOR_COROUTINES
+template <typename Resolver, typename WebSocketStream>
+boost::asio::awaitable<boost::system::error_code>
+WebSocketClient<Resolver, WebSocketStream>::AsyncConnect()
+{
+    // The steps run on the client strand, then the caller resumes on its own executor.
+    co_return co_await boost::asio::co_spawn(strand_, ConnectOnStrand(),
+                                             boost::asio::use_awaitable);
+}
+
+template <typename Resolver, typename WebSocketStream>
+boost::asio::awaitable<std::pair<boost::system::error_code, std::string_view>>
+WebSocketClient<Resolver, WebSocketStream>::AsyncReceive()
+{
+    co_return co_await boost::asio::co_spawn(strand_, ReceiveOnStrand(),
+                                             boost::asio::use_awaitable);
+}
+
+template <typename Resolver, typename WebSocketStream>
+boost::asio::awaitable<boost::system::error_code>
+WebSocketClient<Resolver, WebSocketStream>::ConnectOnStrand()
+{
+    // A WebSocket stream cannot be reopened once it has been used.
+    if (stream_used_) {
+        ResetStream();
+    }
+    stream_used_ = true;
+    received_size_ = 0;
+
+    boost::system::error_code error{};
+    auto token{boost::asio::redirect_error(boost::asio::use_awaitable, error)};
+
+    const auto results{
+        co_await resolver_.async_resolve(server_url_, server_port_, token)};
+    if (error.failed()) {
+        co_return error;
+    }
+
+    auto& tcp_stream = boost::beast::get_lowest_layer(*websocket_stream_);
+    tcp_stream.expires_after(std::chrono::seconds(5));
+    co_await tcp_stream.async_connect(*results, token);
+    if (error.failed()) {
+        co_return error;
+    }
+    SetTcpStreamTimeoutToSuggested();
+    PrepareTlsHandshake();
+
+    co_await websocket_stream_->next_layer().async_handshake(
+        boost::asio::ssl::stream_base::handshake_type::client, token);
+    if (error.failed()) {
+        co_return error;
+    }
+    tls_session_reused_ =
+        SSL_session_reused(websocket_stream_->next_layer().native_handle()) == 1;
+
+    const std::string connection_host{server_url_ + ':' + server_port_};
+    co_await websocket_stream_->async_handshake(connection_host, server_endpoint_, token);
+    if (!error.failed()) {
+        closed_ = false;
+    }
+    co_return error;
+}
+
+template <typename Resolver, typename WebSocketStream>
+boost::asio::awaitable<std::pair<boost::system::error_code, std::string_view>>
+WebSocketClient<Resolver, WebSocketStream>::ReceiveOnStrand()
+{
+    response_buffer_.consume(std::exchange(received_size_, 0));
+
+    boost::system::error_code error{};
+    received_size_ = co_await websocket_stream_->async_read(
+        response_buffer_, boost::asio::redirect_error(boost::asio::use_awaitable, error));
+    if (error.failed()) {
+        closed_ = true;
+        received_size_ = 0;
+        co_return std::pair{error, std::string_view{}};
+    }
+
+    const auto received_data{response_buffer_.data()};
+    received_message_bytes_.fetch_add(received_data.size(), std::memory_order_relaxed);
+    UpdateWireBytes();
+    GetMetrics().websocket_messages_received.Add();
+    GetMetrics().websocket_bytes_received.Add(received_data.size());
+    co_return std::pair{
+        error,
+        std::string_view{static_cast<const char*>(received_data.data()),
+                         received_data.size()}};
+}
+#endif
+
 template <typename Resolver, typename WebSocketStream>
 const std::string& WebSocketClient<Resolver, WebSocketStream>::GetServerUrl() const
 {
@@ -357,6 +908,36 @@ const std::string& WebSocketClient<Resolver, WebSocketStream>::GetServerPort() c
     return server_port_;
 }
 
+template <typename Resolver, typename WebSocketStream>
+WebSocketOutboundQueueStats
+WebSocketClient<Resolver, WebSocketStream>::GetOutboundQueueStats() const
+{
+    return {queued_messages_.load(), queued_bytes_.load(), sent_messages_.load(),
+            coalesced_messages_.load()};
+}
+
+template <typename Resolver, typename WebSocketStream>
+WebSocketTrafficStats WebSocketClient<Resolver, WebSocketStream>::GetTrafficStats() const
+{
+    return {sent_message_bytes_.load(std::memory_order_relaxed),
+            received_message_bytes_.load(std::memory_order_relaxed),
+            sent_wire_bytes_.load(std::memory_order_relaxed),
+            received_wire_bytes_.load(std::memory_order_relaxed)};
+}
+
+template <typename Resolver, typename WebSocketStream>
+bool WebSocketClient<Resolver, WebSocketStream>::IsTlsSessionReused() const
+{
+    return tls_session_reused_;
+}
+
+template <typename Resolver, typename WebSocketStream>
+MessageBufferPool::Stats WebSocketClient<Resolver, WebSocketStream>::GetMessagePoolStats()
+    const
+{
+    return message_pool_.GetStats();
+}
+
 using BoostWebSocketClient = WebSocketClient<
     boost::asio::ip::tcp::resolver,
     boost::beast::websocket::stream<boost::beast::ssl_stream<boost::beast::tcp_stream>>>;
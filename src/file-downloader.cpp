@@ -3,39 +3,298 @@
 #include <cstdio>
 #include <fstream>
 #include <network-monitor/file-downloader.hpp>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
 
-bool NetworkMonitor::DownloadFile(const std::string& file_url,
-                                  const std::filesystem::path& destination,
-                                  const std::filesystem::path& ca_cert_file)
+using NetworkMonitor::DownloadRequest;
+using NetworkMonitor::DownloadResult;
+using NetworkMonitor::FileDownloader;
+
+namespace {
+
+// What identifies the version of a file the last time it was downloaded.
+struct Validators {
+    std::string etag{};
+    curl_off_t last_modified{-1};
+};
+
+// A download running on one of the easy handles.
+struct Transfer {
+    CURL* easy{nullptr};
+    const FileDownloader::ChunkHandler* on_chunk{nullptr};
+    std::FILE* file{nullptr};
+    std::filesystem::path partial_file{};
+    curl_slist* headers{nullptr};
+    CURLcode result{CURLE_OK};
+    bool done{false};
+};
+
+std::string_view ToStringView(const DownloadResult& result)
 {
-    curl_global_init(CURL_GLOBAL_DEFAULT);
+    switch (result) {
+        case DownloadResult::Downloaded:
+            return "Downloaded";
+        case DownloadResult::NotModified:
+            return "NotModified";
+        case DownloadResult::Failed:
+            return "Failed";
+    }
+    return "Failed";
+}
 
-    auto* curl = curl_easy_init();
-    if (curl == nullptr) {
-        return false;
+std::size_t OnTransferData(char* data, std::size_t size, std::size_t count, void* user)
+{
+    auto* transfer{static_cast<Transfer*>(user)};
+    const auto length{size * count};
+    if (transfer->file != nullptr &&
+        std::fwrite(data, 1, length, transfer->file) != length) {
+        return 0;
     }
+    if (transfer->on_chunk != nullptr && !(*transfer->on_chunk)({data, length})) {
+        return 0;
+    }
+    return length;
+}
+
+// The global initialization of libcurl is not thread-safe and must run only once.
+void InitCurl()
+{
+    static const auto result{curl_global_init(CURL_GLOBAL_DEFAULT)};
+    static_cast<void>(result);
+}
+
+}  // namespace
+
+struct FileDownloader::State {
+    std::vector<DownloadResult> Run(const std::vector<DownloadRequest>& requests,
+                                    const ChunkHandler* on_chunk);
+    void StartTransfer(Transfer& transfer, CURL* easy, const DownloadRequest& request);
+    void RunTransfers(std::vector<Transfer>& transfers);
+    DownloadResult FinishTransfer(Transfer& transfer, const DownloadRequest& request);
+
+    std::string ca_cert_file{};
+    CURLSH* share{nullptr};
+    CURLM* multi{nullptr};
+
+    // One handle per parallel download. They keep their connections between calls.
+    std::vector<CURL*> easy_handles{};
 
+    // Indexed by the destination of the download.
+    std::unordered_map<std::string, Validators> validators{};
+};
+
+std::vector<DownloadResult> FileDownloader::State::Run(
+    const std::vector<DownloadRequest>& requests,
+    const ChunkHandler* on_chunk)
+{
+    std::vector<DownloadResult> results(requests.size(), DownloadResult::Failed);
+    if (multi == nullptr) {
+        return results;
+    }
+    while (easy_handles.size() < requests.size()) {
+        auto* easy{curl_easy_init()};
+        if (easy == nullptr) {
+            return results;
+        }
+        easy_handles.push_back(easy);
+    }
+
+    // The transfers do not move: the write callbacks refer to them.
+    std::vector<Transfer> transfers(requests.size());
+    for (std::size_t idx{0}; idx < requests.size(); ++idx) {
+        transfers[idx].on_chunk = on_chunk;
+        StartTransfer(transfers[idx], easy_handles[idx], requests[idx]);
+    }
+    RunTransfers(transfers);
+    for (std::size_t idx{0}; idx < requests.size(); ++idx) {
+        results[idx] = FinishTransfer(transfers[idx], requests[idx]);
+    }
+    return results;
+}
+
+void FileDownloader::State::StartTransfer(Transfer& transfer,
+                                          CURL* easy,
+                                          const DownloadRequest& request)
+{
+    transfer.easy = easy;
+
+    // Only the options are reset: the connections and the caches are kept.
+    curl_easy_reset(easy);
+    curl_easy_setopt(easy, CURLOPT_URL, request.file_url.c_str());
+    curl_easy_setopt(easy, CURLOPT_SHARE, share);
     if (!ca_cert_file.empty()) {
-        curl_easy_setopt(curl, CURLOPT_CAINFO, ca_cert_file.c_str());
+        curl_easy_setopt(easy, CURLOPT_CAINFO, ca_cert_file.c_str());
     }
+    // An empty list requests every encoding supported by the libcurl build.
+    curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(easy, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(easy, CURLOPT_FILETIME, 1L);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, OnTransferData);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer);
 
-    auto* file_handler = std::fopen(destination.c_str(), "w");
-    if (file_handler == nullptr) {
-        curl_easy_cleanup(curl);
-        return false;
+    // Without a destination, the content only goes to the chunk handler.
+    if (request.destination.empty()) {
+        curl_multi_add_handle(multi, easy);
+        return;
     }
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, file_handler);
 
-    curl_easy_setopt(curl, CURLOPT_URL, file_url.c_str());
+    // A conditional request is only valid if the previous copy is still there.
+    const auto validators_it{validators.find(request.destination.string())};
+    if (validators_it != validators.end() &&
+        std::filesystem::exists(request.destination)) {
+        const auto& [etag, last_modified]{validators_it->second};
+        if (!etag.empty()) {
+            transfer.headers =
+                curl_slist_append(nullptr, ("If-None-Match: " + etag).c_str());
+            curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer.headers);
+        }
+        if (last_modified >= 0) {
+            curl_easy_setopt(easy, CURLOPT_TIMECONDITION, CURL_TIMECOND_IFMODSINCE);
+            curl_easy_setopt(easy, CURLOPT_TIMEVALUE_LARGE, last_modified);
+        }
+    }
+
+    // The body goes to a separate file, so a failed download keeps the previous copy.
+    transfer.partial_file = request.destination;
+    transfer.partial_file += ".part";
+    transfer.file = std::fopen(transfer.partial_file.c_str(), "wb");
+    if (transfer.file == nullptr) {
+        return;
+    }
 
-    const auto result = curl_easy_perform(curl);
-    curl_easy_cleanup(curl);
-    std::fclose(file_handler);
+    // A transfer that is not added never completes, and fails.
+    curl_multi_add_handle(multi, easy);
+}
+
+void FileDownloader::State::RunTransfers(std::vector<Transfer>& transfers)
+{
+    int running{0};
+    while (curl_multi_perform(multi, &running) == CURLM_OK && running > 0) {
+        if (curl_multi_poll(multi, nullptr, 0, 1000, nullptr) != CURLM_OK) {
+            break;
+        }
+    }
 
-    if (result != CURLE_OK) {
-        return false;
+    int queued{0};
+    while (const auto* message{curl_multi_info_read(multi, &queued)}) {
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+        for (auto& transfer : transfers) {
+            if (transfer.easy == message->easy_handle) {
+                transfer.result = message->data.result;
+                transfer.done = true;
+            }
+        }
     }
-    return true;
+}
+
+DownloadResult FileDownloader::State::FinishTransfer(Transfer& transfer,
+                                                     const DownloadRequest& request)
+{
+    if (transfer.easy != nullptr) {
+        curl_multi_remove_handle(multi, transfer.easy);
+    }
+    curl_slist_free_all(transfer.headers);
+    const bool written{request.destination.empty() ||
+                       (transfer.file != nullptr && std::fclose(transfer.file) == 0)};
+
+    auto result{DownloadResult::Failed};
+    if (written && transfer.done && transfer.result == CURLE_OK) {
+        long response_code{0};
+        long condition_unmet{0};
+        curl_easy_getinfo(transfer.easy, CURLINFO_RESPONSE_CODE, &response_code);
+        curl_easy_getinfo(transfer.easy, CURLINFO_CONDITION_UNMET, &condition_unmet);
+        if (response_code == 304 || condition_unmet != 0) {
+            result = DownloadResult::NotModified;
+        } else if (request.destination.empty()) {
+            result = DownloadResult::Downloaded;
+        } else {
+            std::error_code error{};
+            std::filesystem::rename(transfer.partial_file, request.destination, error);
+            if (!error) {
+                result = DownloadResult::Downloaded;
+            }
+        }
+    }
+
+    if (request.destination.empty()) {
+        return result;
+    }
+    if (result == DownloadResult::Downloaded) {
+        Validators downloaded{};
+        curl_header* etag{nullptr};
+        if (curl_easy_header(transfer.easy, "ETag", 0, CURLH_HEADER, -1, &etag) ==
+            CURLHE_OK) {
+            downloaded.etag = etag->value;
+        }
+        curl_easy_getinfo(transfer.easy, CURLINFO_FILETIME_T, &downloaded.last_modified);
+        validators[request.destination.string()] = std::move(downloaded);
+    } else if (!transfer.partial_file.empty()) {
+        std::error_code error{};
+        std::filesystem::remove(transfer.partial_file, error);
+    }
+    return result;
+}
+
+std::ostream& NetworkMonitor::operator<<(std::ostream& os, const DownloadResult& result)
+{
+    os << ToStringView(result);
+    return os;
+}
+
+FileDownloader::FileDownloader(const std::filesystem::path& ca_cert_file)
+    : state_{std::make_unique<State>()}
+{
+    InitCurl();
+
+    state_->ca_cert_file = ca_cert_file.string();
+    state_->share = curl_share_init();
+    if (state_->share != nullptr) {
+        curl_share_setopt(state_->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(state_->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(state_->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    }
+    state_->multi = curl_multi_init();
+}
+
+FileDownloader::~FileDownloader()
+{
+    // The share handle can only be released once no easy handle uses it.
+    for (auto* easy : state_->easy_handles) {
+        curl_easy_cleanup(easy);
+    }
+    curl_multi_cleanup(state_->multi);
+    curl_share_cleanup(state_->share);
+}
+
+DownloadResult FileDownloader::Download(const std::string& file_url,
+                                        const std::filesystem::path& destination)
+{
+    return DownloadAll({{file_url, destination}}).front();
+}
+
+std::vector<DownloadResult> FileDownloader::DownloadAll(
+    const std::vector<DownloadRequest>& requests)
+{
+    return state_->Run(requests, nullptr);
+}
+
+DownloadResult FileDownloader::Stream(const std::string& file_url,
+                                      const ChunkHandler& on_chunk,
+                                      const std::filesystem::path& cache)
+{
+    return state_->Run({{file_url, cache}}, &on_chunk).front();
+}
+
+bool NetworkMonitor::DownloadFile(const std::string& file_url,
+                                  const std::filesystem::path& destination,
+                                  const std::filesystem::path& ca_cert_file)
+{
+    FileDownloader downloader{ca_cert_file};
+    return downloader.Download(file_url, destination) == DownloadResult::Downloaded;
 }
 
 nlohmann::json NetworkMonitor::ParseJsonFile(const std::filesystem::path& source)
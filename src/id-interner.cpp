@@ -0,0 +1,86 @@
+#include <functional>
+#include <network-monitor/id-interner.hpp>
+
+using namespace NetworkMonitor;
+
+namespace {
+constexpr std::size_t min_slots_count{16};
+
+std::size_t Hash(std::string_view id)
+{
+    return std::hash<std::string_view>{}(id);
+}
+}  // namespace
+
+IdInterner::Handle IdInterner::Intern(std::string_view id)
+{
+    // Keep the load factor at or below 1/2 so that probe sequences stay short.
+    if (2 * (ids_.size() + 1) > slots_.size()) {
+        Grow();
+    }
+
+    const auto hash{Hash(id)};
+    const auto mask{slots_.size() - 1};
+    auto slot{hash & mask};
+    for (; slots_[slot] != invalid_handle; slot = (slot + 1) & mask) {
+        const auto handle{slots_[slot]};
+        if (hashes_[handle] == hash && ids_[handle] == id) {
+            return handle;
+        }
+    }
+
+    const auto handle{static_cast<Handle>(ids_.size())};
+    ids_.emplace_back(id);
+    hashes_.push_back(hash);
+    slots_[slot] = handle;
+    return handle;
+}
+
+IdInterner::Handle IdInterner::Find(std::string_view id) const
+{
+    if (slots_.empty()) {
+        return invalid_handle;
+    }
+
+    const auto hash{Hash(id)};
+    const auto mask{slots_.size() - 1};
+    for (auto slot = hash & mask; slots_[slot] != invalid_handle;
+         slot = (slot + 1) & mask) {
+        const auto handle{slots_[slot]};
+        if (hashes_[handle] == hash && ids_[handle] == id) {
+            return handle;
+        }
+    }
+    return invalid_handle;
+}
+
+bool IdInterner::Contains(std::string_view id) const
+{
+    return Find(id) != invalid_handle;
+}
+
+const std::string& IdInterner::GetId(Handle handle) const
+{
+    return ids_[handle];
+}
+
+std::size_t IdInterner::Size() const
+{
+    return ids_.size();
+}
+
+void IdInterner::Grow()
+{
+    const auto slots_count{slots_.empty() ? min_slots_count : slots_.size() * 2};
+    slots_.assign(slots_count, invalid_handle);
+
+    // The hashes are cached, so rehashing does not touch the strings.
+    const auto mask{slots_count - 1};
+    for (Handle handle = 0; handle < hashes_.size(); handle++) {
+        auto slot{hashes_[handle] & mask};
+        while (slots_[slot] != invalid_handle) {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = handle;
+    }
+}
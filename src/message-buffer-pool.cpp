@@ -0,0 +1,106 @@
+#include <mutex>
+#include <network-monitor/message-buffer-pool.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace NetworkMonitor;
+
+struct MessageBufferPool::State {
+    mutable std::mutex mutex{};
+    std::vector<std::string> free_buffers{};
+    std::size_t max_free_buffers{0};
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+};
+
+MessageBufferPool::Buffer::Buffer(std::string&& data, std::shared_ptr<State> state)
+    : data_{std::move(data)},
+      state_{std::move(state)}
+{
+}
+
+MessageBufferPool::Buffer& MessageBufferPool::Buffer::operator=(Buffer&& other) noexcept
+{
+    if (this != &other) {
+        Recycle();
+        data_ = std::move(other.data_);
+        state_ = std::move(other.state_);
+    }
+    return *this;
+}
+
+MessageBufferPool::Buffer::~Buffer()
+{
+    Recycle();
+}
+
+std::string& MessageBufferPool::Buffer::operator*()
+{
+    return data_;
+}
+
+const std::string& MessageBufferPool::Buffer::operator*() const
+{
+    return data_;
+}
+
+std::string* MessageBufferPool::Buffer::operator->()
+{
+    return &data_;
+}
+
+const std::string* MessageBufferPool::Buffer::operator->() const
+{
+    return &data_;
+}
+
+std::string MessageBufferPool::Buffer::Release()
+{
+    state_.reset();
+    return std::exchange(data_, {});
+}
+
+void MessageBufferPool::Buffer::Recycle()
+{
+    if (!state_) {
+        return;
+    }
+    const auto state{std::move(state_)};
+    std::lock_guard<std::mutex> lock{state->mutex};
+    if (state->free_buffers.size() < state->max_free_buffers) {
+        // Moving the string hands its allocation over to the free list.
+        state->free_buffers.push_back(std::move(data_));
+    }
+}
+
+MessageBufferPool::MessageBufferPool(std::size_t max_free_buffers)
+    : state_{std::make_shared<State>()}
+{
+    state_->max_free_buffers = max_free_buffers;
+    // Released buffers never make the free list grow.
+    state_->free_buffers.reserve(max_free_buffers);
+}
+
+MessageBufferPool::Buffer MessageBufferPool::Acquire(std::string_view content)
+{
+    std::string data{};
+    {
+        std::lock_guard<std::mutex> lock{state_->mutex};
+        if (state_->free_buffers.empty()) {
+            ++state_->misses;
+        } else {
+            ++state_->hits;
+            data = std::move(state_->free_buffers.back());
+            state_->free_buffers.pop_back();
+        }
+    }
+    data.assign(content.data(), content.size());
+    return Buffer{std::move(data), state_};
+}
+
+MessageBufferPool::Stats MessageBufferPool::GetStats() const
+{
+    std::lock_guard<std::mutex> lock{state_->mutex};
+    return {state_->hits, state_->misses, state_->free_buffers.size()};
+}
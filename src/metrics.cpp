@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <network-monitor/metrics.hpp>
+#include <sstream>
+#include <string_view>
+
+using namespace NetworkMonitor;
+
+namespace {
+
+constexpr std::string_view metrics_prefix{"network_monitor_"};
+
+// Latency buckets exported to Prometheus, as powers of two of nanoseconds: from about
+// 1 microsecond to about 1 minute.
+constexpr std::size_t first_exported_bit{10};
+constexpr std::size_t last_exported_bit{36};
+
+void WriteHeader(std::ostream& os,
+                 std::string_view name,
+                 std::string_view type,
+                 std::string_view help)
+{
+    os << "# HELP " << metrics_prefix << name << ' ' << help << '\n';
+    os << "# TYPE " << metrics_prefix << name << ' ' << type << '\n';
+}
+
+void WriteCounter(std::ostream& os,
+                  std::string_view name,
+                  std::string_view help,
+                  std::uint64_t value)
+{
+    WriteHeader(os, name, "counter", help);
+    os << metrics_prefix << name << ' ' << value << '\n';
+}
+
+template <typename Error, std::size_t Size>
+void WriteErrorCounters(std::ostream& os,
+                        std::string_view name,
+                        std::string_view label,
+                        std::string_view help,
+                        const std::array<std::uint64_t, Size>& counts)
+{
+    WriteHeader(os, name, "counter", help);
+    for (std::size_t index{0}; index < Size; ++index) {
+        os << metrics_prefix << name << '{' << label << "=\""
+           << static_cast<Error>(index) << "\"} " << counts[index] << '\n';
+    }
+}
+
+void WriteHistogram(std::ostream& os,
+                    std::string_view name,
+                    std::string_view help,
+                    const LatencyHistogram::Snapshot& histogram)
+{
+    WriteHeader(os, name, "histogram", help);
+
+    // The buckets of an exported bound are all the buckets below it.
+    std::uint64_t cumulative_count{0};
+    std::size_t index{0};
+    for (auto bit{first_exported_bit}; bit <= last_exported_bit; ++bit) {
+        const auto bound{std::uint64_t{1} << bit};
+        for (; index < histogram.buckets.size() &&
+               LatencyHistogram::GetBucketUpperBound(index) < bound;
+             ++index) {
+            cumulative_count += histogram.buckets[index];
+        }
+        os << metrics_prefix << name << "_bucket{le=\""
+           << static_cast<double>(bound) * 1e-9 << "\"} " << cumulative_count << '\n';
+    }
+    os << metrics_prefix << name << "_bucket{le=\"+Inf\"} " << histogram.count << '\n';
+    os << metrics_prefix << name << "_sum "
+       << static_cast<double>(histogram.sum_ns) * 1e-9 << '\n';
+    os << metrics_prefix << name << "_count " << histogram.count << '\n';
+}
+
+}  // namespace
+
+std::uint64_t LatencyHistogram::Snapshot::GetPercentile(double percentile) const
+{
+    if (count == 0) {
+        return 0;
+    }
+    const auto fraction{std::clamp(percentile, 0.0, 100.0) / 100.0};
+    const auto rank{
+        static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(count)))};
+    std::uint64_t cumulative_count{0};
+    for (std::size_t index{0}; index < buckets.size(); ++index) {
+        cumulative_count += buckets[index];
+        if (cumulative_count >= rank && cumulative_count > 0) {
+            return GetBucketUpperBound(index);
+        }
+    }
+    return GetBucketUpperBound(buckets.size() - 1);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const
+{
+    Snapshot snapshot{};
+    for (std::size_t index{0}; index < bucket_count; ++index) {
+        snapshot.buckets[index] = buckets_[index].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[index];
+    }
+    snapshot.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+std::uint64_t LatencyHistogram::GetBucketUpperBound(std::size_t index)
+{
+    if (index < 2 * sub_bucket_count) {
+        return index;
+    }
+    const auto shift{index / sub_bucket_count - 1};
+    const auto lower_bound{
+        static_cast<std::uint64_t>(sub_bucket_count + index % sub_bucket_count) << shift};
+    return lower_bound + ((std::uint64_t{1} << shift) - 1);
+}
+
+MetricsSnapshot NetworkMonitor::GetMetricsSnapshot(const Metrics& metrics)
+{
+    MetricsSnapshot snapshot{};
+    snapshot.websocket_messages_received = metrics.websocket_messages_received.Get();
+    snapshot.websocket_bytes_received = metrics.websocket_bytes_received.Get();
+    snapshot.websocket_messages_sent = metrics.websocket_messages_sent.Get();
+    snapshot.websocket_bytes_sent = metrics.websocket_bytes_sent.Get();
+    snapshot.stomp_frame_parse_time = metrics.stomp_frame_parse_time.GetSnapshot();
+    snapshot.stomp_frame_results = metrics.stomp_frame_results.GetAll();
+    snapshot.stomp_client_errors = metrics.stomp_client_errors.GetAll();
+    snapshot.stomp_dispatch_delay = metrics.stomp_dispatch_delay.GetSnapshot();
+    snapshot.stomp_reconnect_attempts = metrics.stomp_reconnect_attempts.Get();
+    snapshot.stomp_reconnections = metrics.stomp_reconnections.Get();
+    snapshot.passenger_events_recorded = metrics.passenger_events_recorded.Get();
+    snapshot.passenger_events_rejected = metrics.passenger_events_rejected.Get();
+    return snapshot;
+}
+
+std::string NetworkMonitor::ToPrometheusText(const MetricsSnapshot& snapshot)
+{
+    std::ostringstream os{};
+    os << std::setprecision(12);
+    WriteCounter(os, "websocket_messages_received_total", "WebSocket messages received.",
+                 snapshot.websocket_messages_received);
+    WriteCounter(os, "websocket_received_bytes_total",
+                 "Payload bytes of the WebSocket messages received.",
+                 snapshot.websocket_bytes_received);
+    WriteCounter(os, "websocket_messages_sent_total", "WebSocket messages sent.",
+                 snapshot.websocket_messages_sent);
+    WriteCounter(os, "websocket_sent_bytes_total",
+                 "Payload bytes of the WebSocket messages sent.",
+                 snapshot.websocket_bytes_sent);
+    WriteHistogram(os, "stomp_frame_parse_seconds",
+                   "Time to parse a received STOMP frame.",
+                   snapshot.stomp_frame_parse_time);
+    WriteErrorCounters<StompError>(os, "stomp_frames_parsed_total", "result",
+                                   "Received STOMP frames, by parsing result.",
+                                   snapshot.stomp_frame_results);
+    WriteErrorCounters<StompClientError>(os, "stomp_client_errors_total", "error",
+                                         "Errors reported by the STOMP clients.",
+                                         snapshot.stomp_client_errors);
+    WriteHistogram(os, "stomp_dispatch_delay_seconds",
+                   "Time from the reception of a STOMP message to its subscribers.",
+                   snapshot.stomp_dispatch_delay);
+    WriteCounter(os, "stomp_reconnect_attempts_total",
+                 "Attempts of the STOMP clients to reconnect.",
+                 snapshot.stomp_reconnect_attempts);
+    WriteCounter(os, "stomp_reconnections_total",
+                 "Successful reconnections of the STOMP clients.",
+                 snapshot.stomp_reconnections);
+    WriteCounter(os, "passenger_events_recorded_total",
+                 "Passenger events recorded in the transport networks.",
+                 snapshot.passenger_events_recorded);
+    WriteCounter(os, "passenger_events_rejected_total",
+                 "Passenger events rejected by the transport networks.",
+                 snapshot.passenger_events_rejected);
+    return os.str();
+}
@@ -1,4 +1,6 @@
 #include <network-monitor/stomp-frame-builder.hpp>
+#include <string_view>
+#include <utility>
 
 using namespace NetworkMonitor;
 
@@ -13,41 +15,31 @@ void EmplaceIfValueNotEmpty(StompFrame::Headers& headers,
         headers.emplace(header, value);
     }
 }
-}  // namespace
 
-std::string ParseCommand(StompCommand command)
+// Empty values are sent as a pair of quotes, as an empty value is not valid STOMP.
+StompFrame::Headers QuoteEmptyValues(const StompFrame::Headers& headers)
 {
-    return ToString(command) + '\n';
-}
+    static constexpr std::string_view quoted_empty_value{"\"\""};
 
-std::string ParseHeaders(const StompFrame::Headers& headers)
-{
-    std::string parsed{};
-
-    for (const auto [header, value] : headers) {
-        parsed.append(ToString(header));
-        parsed.append(":");
-        value.empty() ? parsed.append("\"\"") : parsed.append(value);
-        parsed.append("\n");
+    StompFrame::Headers quoted_headers{};
+    for (const auto& [header, value] : headers) {
+        quoted_headers.emplace(header, value.empty() ? quoted_empty_value : value);
     }
-    parsed.push_back('\n');
-    return parsed;
+    return quoted_headers;
 }
-
-// StompFrame stomp_frame::Build(BuildParameters&& parameters)
-// {
-//     // TODO
-// }
+}  // namespace
 
 StompFrame stomp_frame::Build(StompError& error_code, const BuildParameters& parameters)
 {
-    std::string plain_content{};
-    plain_content.append(ParseCommand(parameters.command));
-    plain_content.append(ParseHeaders(parameters.headers));
-    plain_content.append(parameters.body);
-    plain_content.push_back('\0');
+    return StompFrame{error_code, parameters.command,
+                      QuoteEmptyValues(parameters.headers),
+                      std::string_view{parameters.body}};
+}
 
-    return StompFrame{error_code, std::move(plain_content)};
+StompFrame stomp_frame::Build(StompError& error_code, BuildParameters&& parameters)
+{
+    return StompFrame{error_code, parameters.command,
+                      QuoteEmptyValues(parameters.headers), std::move(parameters.body)};
 }
 
 StompFrame stomp_frame::MakeConnectedFrame(const std::string& version,
@@ -62,7 +54,7 @@ StompFrame stomp_frame::MakeConnectedFrame(const std::string& version,
     EmplaceIfValueNotEmpty(parameters.headers, StompHeader::HeartBeat, heart_beat);
 
     StompError error;
-    return Build(error, parameters);
+    return Build(error, std::move(parameters));
 }
 
 StompFrame stomp_frame::MakeErrorFrame(const std::string& message,
@@ -75,7 +67,7 @@ StompFrame stomp_frame::MakeErrorFrame(const std::string& message,
     }
 
     StompError error;
-    return Build(error, parameters);
+    return Build(error, std::move(parameters));
 }
 
 StompFrame stomp_frame::MakeReceiptFrame(const std::string& receipt_id)
@@ -84,19 +76,29 @@ StompFrame stomp_frame::MakeReceiptFrame(const std::string& receipt_id)
     EmplaceIfValueNotEmpty(parameters.headers, StompHeader::ReceiptId, receipt_id);
 
     StompError error;
-    return Build(error, parameters);
+    return Build(error, std::move(parameters));
 }
 
-StompFrame MakeMessageFrame(const std::string& destination,
-                            const std::string& message_id,
-                            const std::string& subscription,
-                            const std::string& ack,
-                            const std::string& body,
-                            const std::string& content_length,
-                            const std::string& content_type)
+StompFrame stomp_frame::MakeMessageFrame(const std::string& destination,
+                                         const std::string& message_id,
+                                         const std::string& subscription,
+                                         const std::string& ack,
+                                         const std::string& body,
+                                         const std::string& content_length,
+                                         const std::string& content_type)
 {
-    // TODO
-    return {};
+    BuildParameters parameters{StompCommand::Message};
+    EmplaceIfValueNotEmpty(parameters.headers, StompHeader::Destination, destination);
+    EmplaceIfValueNotEmpty(parameters.headers, StompHeader::MessageId, message_id);
+    EmplaceIfValueNotEmpty(parameters.headers, StompHeader::Subscription, subscription);
+    EmplaceIfValueNotEmpty(parameters.headers, StompHeader::Ack, ack);
+    EmplaceIfValueNotEmpty(parameters.headers, StompHeader::ContentLength,
+                           content_length);
+    EmplaceIfValueNotEmpty(parameters.headers, StompHeader::ContentType, content_type);
+    parameters.body = body;
+
+    StompError error;
+    return Build(error, std::move(parameters));
 }
 
 StompFrame stomp_frame::MakeSubscribeFrame(const std::string& destination,
@@ -111,5 +113,14 @@ StompFrame stomp_frame::MakeSubscribeFrame(const std::string& destination,
     EmplaceIfValueNotEmpty(parameters.headers, StompHeader::Receipt, receipt);
 
     StompError error;
-    return Build(error, parameters);
+    return Build(error, std::move(parameters));
+}
+
+StompFrame stomp_frame::MakeAckFrame(const std::string& id)
+{
+    BuildParameters parameters{StompCommand::Ack};
+    EmplaceIfValueNotEmpty(parameters.headers, StompHeader::Id, id);
+
+    StompError error;
+    return Build(error, std::move(parameters));
 }
@@ -0,0 +1,150 @@
+#include <charconv>
+#include <network-monitor/metrics.hpp>
+#include <network-monitor/stomp-frame-decoder.hpp>
+
+using namespace NetworkMonitor;
+
+namespace {
+constexpr auto npos{std::string_view::npos};
+
+// Get the value of the first content-length header in the frame command and headers,
+// or npos if there is none or it is not a number. The parser validates it again.
+std::size_t FindContentLength(std::string_view headers)
+{
+    static constexpr std::string_view header_name{"content-length:"};
+    for (auto line_end{headers.find('\n')};
+         line_end != npos && line_end + 1 < headers.size();
+         line_end = headers.find('\n', line_end + 1)) {
+        const auto line{headers.substr(line_end + 1)};
+        if (line.substr(0, header_name.size()) != header_name) {
+            continue;
+        }
+        const auto value{
+            line.substr(header_name.size(), line.find('\n') - header_name.size())};
+        const auto value_end{value.data() + value.size()};
+        std::size_t content_length{};
+        const auto [parsed_end, error]{
+            std::from_chars(value.data(), value_end, content_length)};
+        if (error != std::errc{} || parsed_end != value_end) {
+            return npos;
+        }
+        return content_length;
+    }
+    return npos;
+}
+}  // namespace
+
+void StompFrameDecoder::Push(std::string_view chunk, const FrameHandler& on_frame)
+{
+    // Without a pending frame, decode straight from the chunk and only keep its tail.
+    if (buffer_.empty()) {
+        const auto decoded_size{Decode(chunk, on_frame)};
+        buffer_.assign(chunk.substr(decoded_size));
+        return;
+    }
+    buffer_.append(chunk);
+    const auto decoded_size{Decode(buffer_, on_frame)};
+    buffer_.erase(0, decoded_size);
+}
+
+std::size_t StompFrameDecoder::GetPendingSize() const
+{
+    return buffer_.size();
+}
+
+void StompFrameDecoder::Reset()
+{
+    buffer_.clear();
+    ResetSearch();
+}
+
+std::size_t StompFrameDecoder::Decode(std::string_view stream,
+                                      const FrameHandler& on_frame)
+{
+    std::size_t offset{0};
+    while (offset < stream.size()) {
+        // Skip the heart-beats between frames.
+        if (scanned_ == 0) {
+            while (offset < stream.size() &&
+                   (stream[offset] == '\n' || stream[offset] == '\r')) {
+                ++offset;
+            }
+            if (offset == stream.size()) {
+                break;
+            }
+        }
+
+        const auto pending{stream.substr(offset)};
+        const auto frame_size{FindFrameSize(pending)};
+        if (frame_size == npos) {
+            break;
+        }
+        ResetSearch();
+        offset += frame_size;
+
+        auto& metrics{GetMetrics()};
+        const auto parse_start{MetricsClock::Now()};
+        StompError error{};
+        StompFrame frame{error, pending.substr(0, frame_size),
+                         StompFrame::borrowed_content};
+        metrics.stomp_frame_parse_time.RecordSince(parse_start);
+        metrics.stomp_frame_results.Add(error);
+        on_frame(error, std::move(frame));
+    }
+    return offset;
+}
+
+std::size_t StompFrameDecoder::FindFrameSize(std::string_view pending)
+{
+    static constexpr std::string_view header_delimiters{"\n\0", 2};
+
+    if (body_start_ == npos) {
+        // Look for the empty line ending the headers. A null character before it ends
+        // a malformed frame, which is left to the parser to report.
+        auto position{pending.find_first_of(header_delimiters, scanned_)};
+        for (; position != npos;
+             position = pending.find_first_of(header_delimiters, position + 1)) {
+            if (pending[position] == '\0') {
+                return position + 1;
+            }
+            if (position + 1 == pending.size() || pending[position + 1] == '\n') {
+                break;
+            }
+        }
+        if (position == npos || position + 1 == pending.size()) {
+            // Resume from the last newline, whose follower is not known yet.
+            scanned_ = position == npos ? pending.size() : position;
+            return npos;
+        }
+        body_start_ = position + 2;
+        scanned_ = body_start_;
+
+        const auto content_length{FindContentLength(pending.substr(0, position + 1))};
+        if (content_length < npos - body_start_ - 1) {
+            frame_size_ = body_start_ + content_length + 1;
+        }
+    }
+
+    if (frame_size_ != npos && frame_size_ <= pending.size() &&
+        pending[frame_size_ - 1] != '\0') {
+        // The length is wrong. Delimit the frame by its null character instead, so the
+        // parser reports the mismatch.
+        frame_size_ = npos;
+    }
+    if (frame_size_ == npos) {
+        const auto null_position{pending.find('\0', scanned_)};
+        if (null_position == npos) {
+            scanned_ = pending.size();
+            return npos;
+        }
+        frame_size_ = null_position + 1;
+    }
+    return frame_size_ <= pending.size() ? frame_size_ : npos;
+}
+
+void StompFrameDecoder::ResetSearch()
+{
+    scanned_ = 0;
+    body_start_ = npos;
+    frame_size_ = npos;
+}
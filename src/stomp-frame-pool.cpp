@@ -0,0 +1,160 @@
+#include <atomic>
+#include <mutex>
+#include <network-monitor/stomp-frame-pool.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace NetworkMonitor;
+
+struct StompFramePool::Slot {
+    std::string buffer{};
+    StompFrame frame{};
+    std::atomic<std::size_t> references{0};
+
+    // Only set while the slot is in use, so released slots do not keep the pool alive.
+    std::shared_ptr<State> state{};
+};
+
+struct StompFramePool::State {
+    void Recycle(Slot* slot);
+
+    mutable std::mutex mutex{};
+    std::vector<std::unique_ptr<Slot>> free_slots{};
+    std::size_t max_free_slots{0};
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+};
+
+void StompFramePool::State::Recycle(Slot* slot)
+{
+    std::unique_ptr<Slot> recycled_slot{slot};
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (free_slots.size() < max_free_slots) {
+            free_slots.push_back(std::move(recycled_slot));
+        }
+    }
+    // A slot beyond the limit is destroyed here, outside of the lock.
+}
+
+StompFramePool::Handle::Handle(Slot* slot) : slot_{slot} {}
+
+StompFramePool::Handle::Handle(const Handle& other) : slot_{other.slot_}
+{
+    if (slot_ != nullptr) {
+        slot_->references.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+StompFramePool::Handle::Handle(Handle&& other) noexcept
+    : slot_{std::exchange(other.slot_, nullptr)}
+{
+}
+
+StompFramePool::Handle& StompFramePool::Handle::operator=(const Handle& other)
+{
+    if (this != &other) {
+        Handle copy{other};
+        std::swap(slot_, copy.slot_);
+    }
+    return *this;
+}
+
+StompFramePool::Handle& StompFramePool::Handle::operator=(Handle&& other) noexcept
+{
+    if (this != &other) {
+        Release();
+        slot_ = std::exchange(other.slot_, nullptr);
+    }
+    return *this;
+}
+
+StompFramePool::Handle::~Handle()
+{
+    Release();
+}
+
+const StompFrame& StompFramePool::Handle::operator*() const
+{
+    return slot_->frame;
+}
+
+const StompFrame* StompFramePool::Handle::operator->() const
+{
+    return &slot_->frame;
+}
+
+StompFramePool::Handle::operator bool() const
+{
+    return slot_ != nullptr;
+}
+
+void StompFramePool::Handle::Release()
+{
+    if (slot_ == nullptr) {
+        return;
+    }
+    if (slot_->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // The state reference is moved out first: the slot may be destroyed by Recycle
+        // and the state with the last reference.
+        const auto state{std::move(slot_->state)};
+        state->Recycle(slot_);
+    }
+    slot_ = nullptr;
+}
+
+StompFramePool::StompFramePool(std::size_t max_free_slots)
+    : state_{std::make_shared<State>()}
+{
+    state_->max_free_slots = max_free_slots;
+    // Released slots never make the free list grow.
+    state_->free_slots.reserve(max_free_slots);
+}
+
+StompFramePool::Handle StompFramePool::Acquire(StompError& error_code,
+                                               std::string_view content)
+{
+    auto* slot{TakeSlot()};
+    slot->buffer.assign(content.data(), content.size());
+    slot->frame = StompFrame{error_code, slot->buffer, StompFrame::borrowed_content};
+    return Handle{slot};
+}
+
+StompFramePool::Handle StompFramePool::Acquire(const StompFrame& frame)
+{
+    auto* slot{TakeSlot()};
+    // Only the bytes viewed by the frame are copied, and its views are moved onto the
+    // copy instead of parsing it again.
+    const auto content{frame.GetViewedContent()};
+    slot->buffer.assign(content.data(), content.size());
+    slot->frame = StompFrame{frame, slot->buffer, StompFrame::borrowed_content};
+    return Handle{slot};
+}
+
+StompFramePool::Stats StompFramePool::GetStats() const
+{
+    std::lock_guard<std::mutex> lock{state_->mutex};
+    return {state_->hits, state_->misses, state_->free_slots.size()};
+}
+
+StompFramePool::Slot* StompFramePool::TakeSlot()
+{
+    std::unique_ptr<Slot> slot{};
+    {
+        std::lock_guard<std::mutex> lock{state_->mutex};
+        if (state_->free_slots.empty()) {
+            ++state_->misses;
+        } else {
+            ++state_->hits;
+            slot = std::move(state_->free_slots.back());
+            state_->free_slots.pop_back();
+        }
+    }
+    if (!slot) {
+        slot = std::make_unique<Slot>();
+    }
+    slot->references.store(1, std::memory_order_relaxed);
+    slot->state = state_;
+    return slot.release();
+}
@@ -1,134 +1,329 @@
 #include <algorithm>
-#include <sstream>
-#include <boost/bimap.hpp>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <functional>
 #include <network-monitor/stomp-frame.hpp>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 using namespace NetworkMonitor;
 
-template <typename L, typename R>
-boost::bimap<L, R> MakeBimap(
-    std::initializer_list<typename boost::bimap<L, R>::value_type> list)
-{
-    return boost::bimap<L, R>(list.begin(), list.end());
-}
+namespace {
 
-static const auto stomp_commands_strings{MakeBimap<StompCommand, std::string_view>({
+// The tables are indexed by the enum values, so they follow the declaration order.
+constexpr std::array<std::string_view, 16> stomp_commands_strings{
     // clang-format off
-    {StompCommand::Abort,           "ABORT"             },
-    {StompCommand::Ack,             "ACK"               },
-    {StompCommand::Begin,           "BEGIN"             },
-    {StompCommand::Commit,          "COMMIT"            },
-    {StompCommand::Connect,         "CONNECT"           },
-    {StompCommand::Connected,       "CONNECTED"         },
-    {StompCommand::Disconnect,      "DISCONNECT"        },
-    {StompCommand::Error,           "ERROR"             },
-    {StompCommand::Invalid,         "INVALID_COMMAND"   },
-    {StompCommand::Message,         "MESSAGE"           },
-    {StompCommand::NAck,            "NACK"              },
-    {StompCommand::Receipt,         "RECEIPT"           },
-    {StompCommand::Send,            "SEND"              },
-    {StompCommand::Stomp,           "STOMP"             },
-    {StompCommand::Subscribe,       "SUBSCRIBE"         },
-    {StompCommand::Unsubscribe,     "UNSUBSCRIBE"       },
+    "ABORT",
+    "ACK",
+    "BEGIN",
+    "COMMIT",
+    "CONNECT",
+    "CONNECTED",
+    "DISCONNECT",
+    "ERROR",
+    "INVALID_COMMAND",
+    "MESSAGE",
+    "NACK",
+    "RECEIPT",
+    "SEND",
+    "STOMP",
+    "SUBSCRIBE",
+    "UNSUBSCRIBE",
     // clang-format on
-})};
-
-static const auto stomp_headers_strings{MakeBimap<StompHeader, std::string_view>({
-    // clang-format off
-    {StompHeader::AcceptVersion,    "accept-version"    },
-    {StompHeader::Ack,              "ack"               },
-    {StompHeader::ContentLength,    "content-length"    },
-    {StompHeader::ContentType,      "content-type"      },
-    {StompHeader::Destination,      "destination"       },
-    {StompHeader::HeartBeat,        "heart-beat"        },
-    {StompHeader::Host,             "host"              },
-    {StompHeader::Id,               "id"                },
-    {StompHeader::Invalid,          "invalid-header"    },
-    {StompHeader::Login,            "login"             },
-    {StompHeader::Message,          "message"           },
-    {StompHeader::MessageId,        "message-id"        },
-    {StompHeader::Passcode,         "passcode"          },
-    {StompHeader::Receipt,          "receipt"           },
-    {StompHeader::ReceiptId,        "receipt-id"        },
-    {StompHeader::Session,          "session"           },
-    {StompHeader::Server,           "server"            },
-    {StompHeader::Subscription,     "subscription"      },
-    {StompHeader::Transaction,      "transaction"       },
-    {StompHeader::Version,          "version"           },
-    // clang-format on
-})};
+};
+static_assert(stomp_commands_strings.size() ==
+              static_cast<std::size_t>(StompCommand::Unsubscribe) + 1);
 
-static const auto stomp_errors_strings{MakeBimap<StompError, std::string_view>({
+constexpr std::array<std::string_view, 20> stomp_headers_strings{
     // clang-format off
-    {StompError::Ok,                            "Ok"                            },
-    {StompError::UndefinedError,                "UndefinedError"                },
-    {StompError::InvalidCommand,                "InvalidCommand"                },
-    {StompError::InvalidHeader,                 "InvalidHeader"                 },
-    {StompError::InvalidHeaderValue,            "InvalidHeaderValue"            },
-    {StompError::NoHeaderValue,                 "NoHeaderValue"                 },
-    {StompError::EmptyHeaderValue,              "EmptyHeaderValue"              },
-    {StompError::NoNewlineCharacters,           "NoNewlineCharacters"           },
-    {StompError::MissingLastHeaderNewline,      "MissingLastHeaderNewline"      },
-    {StompError::MissingBodyNewline,            "MissingBodyNewline"            },
-    {StompError::MissingClosingNullCharacter,   "MissingClosingNullCharacter"   },
-    {StompError::JunkAfterBody,                 "JunkAfterBody"                 },
-    {StompError::ContentLengthsDontMatch,       "ContentLengthsDontMatch"       },
-    {StompError::MissingRequiredHeader,         "MissingRequiredHeader"         },
-    {StompError::NoData,                        "NoData"                        },
-    {StompError::MissingCommand,                "MissingCommand"                },
-    {StompError::NoHeaderName,                  "NoHeaderName"                  }
+    "accept-version",
+    "ack",
+    "content-length",
+    "content-type",
+    "destination",
+    "heart-beat",
+    "host",
+    "id",
+    "invalid-header",
+    "login",
+    "message",
+    "message-id",
+    "passcode",
+    "receipt",
+    "receipt-id",
+    "session",
+    "server",
+    "subscription",
+    "transaction",
+    "version",
     // clang-format on
-})};
+};
+static_assert(stomp_headers_strings.size() ==
+              static_cast<std::size_t>(StompHeader::Version) + 1);
 
-static const std::map<StompCommand, std::set<StompHeader>> headers_required_by_commands{
+constexpr std::array<std::string_view, 17> stomp_errors_strings{
     // clang-format off
-    {StompCommand::Connect,     {StompHeader::AcceptVersion, StompHeader::Host}},
-    {StompCommand::Connected,   {StompHeader::Version}},
-    {StompCommand::Send,        {StompHeader::Destination}},
-    {StompCommand::Subscribe,   {StompHeader::Destination, StompHeader::Id}},
-    {StompCommand::Unsubscribe, {StompHeader::Id}},
-    {StompCommand::Ack,         {StompHeader::Id}},
-    {StompCommand::NAck,        {StompHeader::Id}},
-    {StompCommand::Begin,       {StompHeader::Transaction}},
-    {StompCommand::Commit,      {StompHeader::Transaction}},
-    {StompCommand::Abort,       {StompHeader::Transaction}},
-    {StompCommand::Disconnect,  {}},
-    {StompCommand::Message,     {StompHeader::Destination, StompHeader::MessageId, StompHeader::Subscription}},
-    {StompCommand::Receipt,     {StompHeader::ReceiptId}},
-    {StompCommand::Error,       {}}
+    "Ok",
+    "UndefinedError",
+    "InvalidCommand",
+    "InvalidHeader",
+    "InvalidHeaderValue",
+    "NoHeaderValue",
+    "EmptyHeaderValue",
+    "NoNewlineCharacters",
+    "MissingLastHeaderNewline",
+    "MissingBodyNewline",
+    "MissingClosingNullCharacter",
+    "JunkAfterBody",
+    "ContentLengthsDontMatch",
+    "MissingRequiredHeader",
+    "NoData",
+    "MissingCommand",
+    "NoHeaderName",
     // clang-format on
 };
+static_assert(stomp_errors_strings.size() ==
+              static_cast<std::size_t>(StompError::NoHeaderName) + 1);
+
+template <typename Enum, std::size_t N>
+constexpr std::string_view LookUpString(const std::array<std::string_view, N>& strings,
+                                        Enum value,
+                                        Enum fallback)
+{
+    const auto index{static_cast<std::size_t>(value)};
+    return index < N ? strings[index] : strings[static_cast<std::size_t>(fallback)];
+}
+
+}  // namespace
 
 std::string_view ToStringView(const StompCommand& command)
 {
-    const auto string_representation{stomp_commands_strings.left.find(command)};
-    if (string_representation == stomp_commands_strings.left.end()) {
-        return stomp_commands_strings.left.find(StompCommand::Invalid)->second;
-    } else {
-        return string_representation->second;
-    }
+    return LookUpString(stomp_commands_strings, command, StompCommand::Invalid);
 }
 
 std::string_view ToStringView(const StompHeader& header)
 {
-    const auto string_representation{stomp_headers_strings.left.find(header)};
-    if (string_representation == stomp_headers_strings.left.end()) {
-        return stomp_headers_strings.left.find(StompHeader::Invalid)->second;
-    } else {
-        return string_representation->second;
-    }
+    return LookUpString(stomp_headers_strings, header, StompHeader::Invalid);
 }
 
 std::string_view ToStringView(const StompError& error)
 {
-    const auto string_representation{stomp_errors_strings.left.find(error)};
-    if (string_representation == stomp_errors_strings.left.end()) {
-        return stomp_errors_strings.left.find(StompError::UndefinedError)->second;
-    } else {
-        return string_representation->second;
+    return LookUpString(stomp_errors_strings, error, StompError::UndefinedError);
+}
+
+namespace {
+
+// Return the first candidate whose text representation equals `plain`, or `fallback`.
+template <typename Enum, typename... Candidates>
+Enum MatchName(std::string_view plain, Enum fallback, Candidates... candidates)
+{
+    Enum match{fallback};
+    ((plain == ToStringView(candidates) ? (match = candidates, true) : false) || ...);
+    return match;
+}
+
+// The name length selects a handful of candidates, which are then compared in full.
+// The `Invalid` placeholders are never recognized.
+StompCommand ParseCommand(std::string_view plain)
+{
+    using Command = StompCommand;
+    constexpr auto invalid{Command::Invalid};
+    switch (plain.size()) {
+        case 3:
+            return MatchName(plain, invalid, Command::Ack);
+        case 4:
+            return MatchName(plain, invalid, Command::NAck, Command::Send);
+        case 5:
+            return MatchName(plain, invalid, Command::Abort, Command::Begin,
+                             Command::Error, Command::Stomp);
+        case 6:
+            return MatchName(plain, invalid, Command::Commit);
+        case 7:
+            return MatchName(plain, invalid, Command::Connect, Command::Message,
+                             Command::Receipt);
+        case 9:
+            return MatchName(plain, invalid, Command::Connected, Command::Subscribe);
+        case 10:
+            return MatchName(plain, invalid, Command::Disconnect);
+        case 11:
+            return MatchName(plain, invalid, Command::Unsubscribe);
+        default:
+            return invalid;
+    }
+}
+
+StompHeader ParseHeader(std::string_view plain)
+{
+    using Header = StompHeader;
+    constexpr auto invalid{Header::Invalid};
+    switch (plain.size()) {
+        case 2:
+            return MatchName(plain, invalid, Header::Id);
+        case 3:
+            return MatchName(plain, invalid, Header::Ack);
+        case 4:
+            return MatchName(plain, invalid, Header::Host);
+        case 5:
+            return MatchName(plain, invalid, Header::Login);
+        case 6:
+            return MatchName(plain, invalid, Header::Server);
+        case 7:
+            return MatchName(plain, invalid, Header::Message, Header::Receipt,
+                             Header::Session, Header::Version);
+        case 8:
+            return MatchName(plain, invalid, Header::Passcode);
+        case 10:
+            return MatchName(plain, invalid, Header::HeartBeat, Header::MessageId,
+                             Header::ReceiptId);
+        case 11:
+            return MatchName(plain, invalid, Header::Destination, Header::Transaction);
+        case 12:
+            return MatchName(plain, invalid, Header::ContentType, Header::Subscription);
+        case 14:
+            return MatchName(plain, invalid, Header::AcceptVersion,
+                             Header::ContentLength);
+        default:
+            return invalid;
+    }
+}
+
+constexpr std::uint32_t ToMask(StompHeader header)
+{
+    return std::uint32_t{1} << static_cast<std::uint32_t>(header);
+}
+
+template <typename... Headers>
+constexpr std::uint32_t ToMask(StompHeader header, Headers... headers)
+{
+    return ToMask(header) | ToMask(headers...);
+}
+
+// Headers required by each command, as a mask of `StompHeader` bits.
+constexpr std::uint32_t GetRequiredHeaders(StompCommand command)
+{
+    using Header = StompHeader;
+    switch (command) {
+        case StompCommand::Connect:
+            return ToMask(Header::AcceptVersion, Header::Host);
+        case StompCommand::Connected:
+            return ToMask(Header::Version);
+        case StompCommand::Send:
+            return ToMask(Header::Destination);
+        case StompCommand::Subscribe:
+            return ToMask(Header::Destination, Header::Id);
+        case StompCommand::Unsubscribe:
+        case StompCommand::Ack:
+        case StompCommand::NAck:
+            return ToMask(Header::Id);
+        case StompCommand::Begin:
+        case StompCommand::Commit:
+        case StompCommand::Abort:
+            return ToMask(Header::Transaction);
+        case StompCommand::Message:
+            return ToMask(Header::Destination, Header::MessageId, Header::Subscription);
+        case StompCommand::Receipt:
+            return ToMask(Header::ReceiptId);
+        default:
+            return 0;
     }
 }
 
+// Find the first of the `Needles` characters in `text`, starting at `from`.
+//
+// The text is scanned in 32-byte or 16-byte blocks when the target supports AVX2, SSE2
+// or NEON, and byte by byte otherwise and for the tail. The intrinsics paths are only
+// taken with GCC and Clang, which define the feature macros used below. A single
+// needle is left to `memchr`, which the C library already dispatches at run time.
+template <char... Needles>
+std::size_t FindFirstOf(std::string_view text, std::size_t from)
+{
+    if constexpr (sizeof...(Needles) == 1) {
+        return text.find(Needles..., from);
+    }
+    if (from >= text.size()) {
+        return std::string_view::npos;
+    }
+    const char* const begin{text.data()};
+    const char* const end{begin + text.size()};
+    const char* first{begin + from};
+
+#if defined(__AVX2__)
+    for (; end - first >= 32; first += 32) {
+        const auto block{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first))};
+        auto matches{_mm256_setzero_si256()};
+        ((matches = _mm256_or_si256(matches,
+                                    _mm256_cmpeq_epi8(block, _mm256_set1_epi8(Needles)))),
+         ...);
+        const auto mask{static_cast<std::uint32_t>(_mm256_movemask_epi8(matches))};
+        if (mask != 0) {
+            return static_cast<std::size_t>(first - begin) + __builtin_ctz(mask);
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    for (; end - first >= 16; first += 16) {
+        const auto block{_mm_loadu_si128(reinterpret_cast<const __m128i*>(first))};
+        auto matches{_mm_setzero_si128()};
+        ((matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, _mm_set1_epi8(Needles)))),
+         ...);
+        const auto mask{static_cast<std::uint32_t>(_mm_movemask_epi8(matches))};
+        if (mask != 0) {
+            return static_cast<std::size_t>(first - begin) + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; end - first >= 16; first += 16) {
+        const auto block{vld1q_u8(reinterpret_cast<const std::uint8_t*>(first))};
+        auto matches{vdupq_n_u8(0)};
+        ((matches = vorrq_u8(
+              matches, vceqq_u8(block, vdupq_n_u8(static_cast<std::uint8_t>(Needles))))),
+         ...);
+        if (vmaxvq_u8(matches) != 0) {
+            // The match is within this block: leave it to the scalar loop.
+            break;
+        }
+    }
+#endif
+    for (; first != end; ++first) {
+        if (((*first == Needles) || ...)) {
+            return static_cast<std::size_t>(first - begin);
+        }
+    }
+    return std::string_view::npos;
+}
+
+// Check for the "\n\n" pattern that separates the headers from the body.
+bool HasBodyNewline(std::string_view text)
+{
+    for (auto newline{FindFirstOf<'\n'>(text, 0)}; newline != std::string_view::npos;
+         newline = FindFirstOf<'\n'>(text, newline + 1)) {
+        if (newline + 1 < text.size() && text[newline + 1] == '\n') {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Get the size of the command line, header lines and empty line of a frame.
+std::size_t GetHeadSize(StompCommand command, const StompHeaders& headers)
+{
+    auto size{ToStringView(command).size() + 1};
+    for (const auto& [header, value] : headers) {
+        size += ToStringView(header).size() + 1 + value.size() + 1;
+    }
+    return size + 1;
+}
+
+}  // namespace
+
 std::ostream& NetworkMonitor::operator<<(std::ostream& os, const StompCommand& command)
 {
     os << ToStringView(command);
@@ -162,12 +357,108 @@ std::string NetworkMonitor::ToString(const StompError& error)
     return std::string(ToStringView(error));
 }
 
+StompHeaders::Iterator::Iterator(const StompHeaders* headers, std::size_t index)
+    : headers_{headers},
+      index_{index}
+{
+    SkipMissing();
+}
+
+StompHeaders::value_type StompHeaders::Iterator::operator*() const
+{
+    return {static_cast<StompHeader>(index_), headers_->values_[index_]};
+}
+
+StompHeaders::Iterator& StompHeaders::Iterator::operator++()
+{
+    ++index_;
+    SkipMissing();
+    return *this;
+}
+
+StompHeaders::Iterator StompHeaders::Iterator::operator++(int)
+{
+    auto previous{*this};
+    ++(*this);
+    return previous;
+}
+
+bool StompHeaders::Iterator::operator==(const Iterator& other) const
+{
+    return headers_ == other.headers_ && index_ == other.index_;
+}
+
+bool StompHeaders::Iterator::operator!=(const Iterator& other) const
+{
+    return !(*this == other);
+}
+
+void StompHeaders::Iterator::SkipMissing()
+{
+    while (index_ < capacity_ && (headers_->mask_ & (std::uint32_t{1} << index_)) == 0) {
+        ++index_;
+    }
+}
+
+bool StompHeaders::emplace(StompHeader header, std::string_view value)
+{
+    if (count(header)) {
+        return false;
+    }
+    const auto index{ToIndex(header)};
+    values_[index] = value;
+    mask_ |= std::uint32_t{1} << index;
+    return true;
+}
+
+std::size_t StompHeaders::count(StompHeader header) const
+{
+    return (mask_ >> ToIndex(header)) & 1;
+}
+
+const std::string_view& StompHeaders::at(StompHeader header) const
+{
+    if (!count(header)) {
+        throw std::out_of_range{"The STOMP header is not in the set"};
+    }
+    return values_[ToIndex(header)];
+}
+
+std::size_t StompHeaders::size() const
+{
+    std::size_t size{0};
+    for (auto mask{mask_}; mask != 0; mask &= mask - 1) {
+        ++size;
+    }
+    return size;
+}
+
+bool StompHeaders::empty() const
+{
+    return mask_ == 0;
+}
+
+StompHeaders::Iterator StompHeaders::begin() const
+{
+    return Iterator{this, 0};
+}
+
+StompHeaders::Iterator StompHeaders::end() const
+{
+    return Iterator{this, capacity_};
+}
+
+std::size_t StompHeaders::ToIndex(StompHeader header)
+{
+    return static_cast<std::size_t>(header);
+}
+
 StompFrame::StompFrame() = default;
 
 StompFrame::StompFrame(StompError& error_code, const std::string& content)
 {
     plain_content_ = content;
-    error_code = ParseFrame();
+    error_code = ParseFrame(plain_content_);
     if (error_code != StompError::Ok) {
         return;
     }
@@ -177,10 +468,60 @@ StompFrame::StompFrame(StompError& error_code, const std::string& content)
 StompFrame::StompFrame(StompError& error_code, std::string&& content)
 {
     plain_content_ = std::move(content);
-    error_code = ParseFrame();
+    error_code = ParseFrame(plain_content_);
+    if (error_code != StompError::Ok) {
+        return;
+    }
+    error_code = ValidateFrame();
+}
+
+StompFrame::StompFrame(StompError& error_code,
+                       std::string_view content,
+                       BorrowedContent)
+{
+    error_code = ParseFrame(content);
+    if (error_code != StompError::Ok) {
+        return;
+    }
+    error_code = ValidateFrame();
+}
+
+StompFrame::StompFrame(StompError& error_code,
+                       StompCommand command,
+                       const Headers& headers,
+                       std::string_view body)
+{
+    error_code = ValidateParts(command, headers, body);
+    if (error_code != StompError::Ok) {
+        return;
+    }
+
+    const auto head_size{GetHeadSize(command, headers)};
+    plain_content_.reserve(head_size + body.size() + 1);
+    plain_content_.resize(head_size);
+    plain_content_.append(body);
+    plain_content_.push_back('\0');
+    WriteHead(command, headers);
+    error_code = ValidateFrame();
+}
+
+StompFrame::StompFrame(StompError& error_code,
+                       StompCommand command,
+                       const Headers& headers,
+                       std::string&& body)
+{
+    error_code = ValidateParts(command, headers, body);
     if (error_code != StompError::Ok) {
         return;
     }
+
+    const auto head_size{GetHeadSize(command, headers)};
+    const auto body_size{body.size()};
+    plain_content_ = std::move(body);
+    plain_content_.reserve(head_size + body_size + 1);
+    plain_content_.insert(0, head_size, '\n');
+    plain_content_.push_back('\0');
+    WriteHead(command, headers);
     error_code = ValidateFrame();
 }
 
@@ -190,43 +531,88 @@ StompFrame::StompFrame(const StompFrame& other)
       headers_{other.headers_},
       body_{other.body_}
 {
+    RebaseViews(other.plain_content_.data(), other.plain_content_.size(),
+                plain_content_.data());
 }
 
-StompFrame::StompFrame(StompFrame&& other)
-    : plain_content_{std::move(other.plain_content_)},
-      command_{std::move(other.command_)},
-      headers_{std::move(other.headers_)},
-      body_{std::move(other.body_)}
+StompFrame::StompFrame(const StompFrame& other,
+                       std::string_view copied_content,
+                       BorrowedContent)
+    : command_{other.command_},
+      headers_{other.headers_},
+      body_{other.body_}
 {
+    const auto content{other.GetViewedContent()};
+    RebaseViews(content.data(), content.size(), copied_content.data());
+}
+
+StompFrame::StompFrame(StompFrame&& other) noexcept
+{
+    *this = std::move(other);
 }
 
 StompFrame& StompFrame::operator=(const StompFrame& other)
 {
-    plain_content_ = other.plain_content_;
-    command_ = other.command_;
-    headers_ = other.headers_;
-    body_ = other.body_;
+    if (this != &other) {
+        plain_content_ = other.plain_content_;
+        command_ = other.command_;
+        headers_ = other.headers_;
+        body_ = other.body_;
+        RebaseViews(other.plain_content_.data(), other.plain_content_.size(),
+                    plain_content_.data());
+    }
     return *this;
 }
 
-StompFrame& StompFrame::operator=(StompFrame&& other)
+StompFrame& StompFrame::operator=(StompFrame&& other) noexcept
 {
-    plain_content_ = std::move(other.plain_content_);
-    command_ = std::move(other.command_);
-    headers_ = std::move(other.headers_);
-    body_ = std::move(other.body_);
+    if (this != &other) {
+        // A heap buffer changes hands with the string, so only a short string needs
+        // its views rebased.
+        const char* const other_content{other.plain_content_.data()};
+        const auto other_content_size{other.plain_content_.size()};
+        plain_content_ = std::move(other.plain_content_);
+        command_ = std::exchange(other.command_, StompCommand::Invalid);
+        headers_ = std::exchange(other.headers_, {});
+        body_ = std::exchange(other.body_, {});
+        RebaseViews(other_content, other_content_size, plain_content_.data());
+        other.plain_content_.clear();
+    }
     return *this;
 }
 
-StompError StompFrame::ParseFrame()
+void StompFrame::RebaseViews(const char* old_content,
+                             std::size_t content_size,
+                             const char* new_content)
+{
+    if (old_content == new_content) {
+        return;
+    }
+
+    // Views outside of the old content belong to a borrowed buffer and are kept.
+    const auto rebase{[old_content, content_size, new_content](std::string_view view) {
+        const std::less<const char*> is_before{};
+        if (view.data() == nullptr || is_before(view.data(), old_content) ||
+            is_before(old_content + content_size, view.data() + view.size())) {
+            return view;
+        }
+        return std::string_view{new_content + (view.data() - old_content), view.size()};
+    }};
+
+    Headers headers{};
+    for (const auto& [header, value] : headers_) {
+        headers.emplace(header, rebase(value));
+    }
+    headers_ = headers;
+    body_ = rebase(body_);
+}
+
+StompError StompFrame::ParseFrame(std::string_view plain_content)
 {
     static const char newline_character{'\n'};
-    static const char colon_character{':'};
     static const char null_character{'\0'};
 
     // Run pre-checks
-    std::string_view plain_content = plain_content_;
-
     if (plain_content.empty()) {
         return StompError::NoData;
     }
@@ -239,29 +625,38 @@ StompError StompFrame::ParseFrame()
         return StompError::MissingClosingNullCharacter;
     }
 
-    const auto command_end{plain_content.find(newline_character)};
+    const auto command_end{FindFirstOf<newline_character>(plain_content, 0)};
     if (command_end == std::string::npos) {
         return StompError::NoNewlineCharacters;
     }
 
-    // If no "\n\n" pattern, then the body's newline is missing.
-    const auto double_newline_pointer = std::adjacent_find(
-        plain_content.begin(), plain_content.end(),
-        [](const auto& a, const auto& b) { return a == b && a == '\n'; });
-    if (double_newline_pointer == plain_content.end()) {
+    // The content is parsed in a single pass that stops at the body. A missing "\n\n"
+    // pattern takes precedence over any error found on the way, so only look for it
+    // when the pass fails: a successful pass has found it already.
+    const auto error{ParseContent(plain_content, command_end)};
+    if (error != StompError::Ok && !HasBodyNewline(plain_content)) {
         return StompError::MissingBodyNewline;
     }
+    return error;
+}
+
+StompError StompFrame::ParseContent(std::string_view plain_content,
+                                    std::size_t command_end)
+{
+    static const char newline_character{'\n'};
+    static const char colon_character{':'};
+    static const char null_character{'\0'};
 
     // Parse command
-    auto command_plain{plain_content.substr(0, command_end)};
-    auto command{stomp_commands_strings.right.find(command_plain)};
-    if (command == stomp_commands_strings.right.end()) {
+    const auto command{ParseCommand(plain_content.substr(0, command_end))};
+    if (command == StompCommand::Invalid) {
         return StompError::InvalidCommand;
     }
-    command_ = command->second;
+    command_ = command;
 
     // Parse headers
     // Headers are optional.
+    bool null_in_headers{false};
     auto next_line_start{command_end + 1};
     while (1) {
         // Check if there's something more in the frame.
@@ -269,36 +664,46 @@ StompError StompFrame::ParseFrame()
             return StompError::MissingBodyNewline;
         }
 
-        if (plain_content.at(next_line_start) == newline_character) {
+        if (plain_content[next_line_start] == newline_character) {
             // CONNECT\n
             // \n
             //
             // No headers, go parse the body.
             break;
         }
-        if (plain_content.at(next_line_start) == colon_character) {
+        if (plain_content[next_line_start] == colon_character) {
             // CONNECT\n
             // :
             return StompError::NoHeaderName;
         }
-        if (plain_content.at(next_line_start) == null_character) {
+        if (plain_content[next_line_start] == null_character) {
             // CONNECT\n
             // \0
             return StompError::MissingBodyNewline;
         }
 
         const auto next_colon_position{
-            plain_content.find(colon_character, next_line_start)};
-        const auto next_newline_position{
-            plain_content.find(newline_character, next_line_start)};
-
-        if (next_colon_position == std::string::npos) {
+            FindFirstOf<colon_character, newline_character>(plain_content,
+                                                            next_line_start)};
+        if (next_colon_position == std::string::npos ||
+            plain_content[next_colon_position] == newline_character) {
             // CONNECT\n
-            // header-1:value\n
-            // header-2\n
-            //       ^ no header value
+            // header-1\n
+            //         ^ missing colon
+            // header-2:value\n
+            // \0
             return StompError::NoHeaderValue;
         }
+
+        // A null character within a value makes the closing one not the first.
+        auto next_newline_position{FindFirstOf<newline_character, null_character>(
+            plain_content, next_colon_position + 1)};
+        if (next_newline_position != std::string::npos &&
+            plain_content[next_newline_position] == null_character) {
+            null_in_headers = true;
+            next_newline_position =
+                FindFirstOf<newline_character>(plain_content, next_newline_position);
+        }
         if (next_newline_position == std::string::npos) {
             // CONNECT\n
             // header:value
@@ -306,16 +711,7 @@ StompError StompFrame::ParseFrame()
             // \0
             return StompError::MissingLastHeaderNewline;
         }
-        if (next_newline_position < next_colon_position) {
-            // CONNECT\n
-            // header-1\n
-            //         ^ missing colon
-            // header-2:value\n
-            // \0
-            return StompError::NoHeaderValue;
-        }
-        if (plain_content.at(next_colon_position + 1) ==
-            plain_content.at(next_newline_position)) {
+        if (next_newline_position == next_colon_position + 1) {
             // CONNECT\n
             // header:\n
             //       ^ ^ missing header value
@@ -328,17 +724,16 @@ StompError StompFrame::ParseFrame()
         // Read header.
         const auto header_plain{plain_content.substr(
             next_line_start, next_colon_position - next_line_start)};
-        const auto header{stomp_headers_strings.right.find(header_plain)};
-        if (header == stomp_headers_strings.right.end()) {
+        const auto header{ParseHeader(header_plain)};
+        if (header == StompHeader::Invalid) {
             return StompError::InvalidHeader;
         }
 
-        // Find the value. It's known '\n' is in a further part, so no frame end
-        // concerns. Also the value will be no empty.
+        // The value is not empty and ends before the newline.
         std::string_view value{plain_content.substr(
             next_colon_position + 1, next_newline_position - next_colon_position - 1)};
 
-        headers_.emplace(header->second, std::move(value));
+        headers_.emplace(header, value);
         next_line_start = next_newline_position + 1;
     }
 
@@ -346,10 +741,7 @@ StompError StompFrame::ParseFrame()
 
     // CONNECT\n
     // header-1:value
-    // \n <-- check if the newline is present
-    if (plain_content.at(next_line_start) != newline_character) {
-        return StompError::MissingBodyNewline;
-    }
+    // \n <-- the header loop stops at this newline
     next_line_start++;
 
     if (next_line_start >= plain_content.size()) {
@@ -358,21 +750,16 @@ StompError StompFrame::ParseFrame()
         //     <-- missing null
         return StompError::MissingClosingNullCharacter;
     }
-    const auto null_position{plain_content.find(null_character)};
-    if (null_position == std::string::npos) {
-        // CONNECT\n
-        // \n
-        // Frame body
-        //            ^ missing null
-        return StompError::MissingClosingNullCharacter;
-    }
 
     if (HasHeader(StompHeader::ContentLength)) {
-        // -2 excludes the closing null character.
+        // The length is checked later, so the body bytes are not scanned. -1 excludes
+        // the closing null character.
         body_ = plain_content.substr(next_line_start,
                                       plain_content.size() - next_line_start - 1);
     } else {
-        if (null_position + 1 != plain_content.size()) {
+        const auto null_position{
+            FindFirstOf<null_character>(plain_content, next_line_start)};
+        if (null_in_headers || null_position + 1 != plain_content.size()) {
             // CONNECT\n
             // \n
             // Frame body\0junk
@@ -389,11 +776,12 @@ StompError StompFrame::ValidateFrame()
 {
     // Check if content-length match body_'s length.
     if (HasHeader(StompHeader::ContentLength)) {
-        int expected_content_length{};
-        try {
-            expected_content_length =
-                std::stoi(GetHeaderValue(StompHeader::ContentLength).data());
-        } catch (const std::exception& exception) {
+        const auto& value{GetHeaderValue(StompHeader::ContentLength)};
+        std::size_t expected_content_length{};
+        const auto value_end{value.data() + value.size()};
+        const auto [parsed_end, error]{
+            std::from_chars(value.data(), value_end, expected_content_length)};
+        if (error != std::errc{} || parsed_end != value_end) {
             return StompError::InvalidHeaderValue;
         }
         if (expected_content_length != body_.length()) {
@@ -402,16 +790,70 @@ StompError StompFrame::ValidateFrame()
     }
 
     // Check for required headers.
-    const auto required_headers = headers_required_by_commands.at(command_);
-    for (const auto required_header : required_headers) {
-        if (!HasHeader(required_header)) {
-            return StompError::MissingRequiredHeader;
-        }
+    const auto required_headers{GetRequiredHeaders(command_)};
+    std::uint32_t contained_headers{0};
+    for (const auto& [header, _] : headers_) {
+        contained_headers |= ToMask(header);
+    }
+    if ((contained_headers & required_headers) != required_headers) {
+        return StompError::MissingRequiredHeader;
     }
 
     return StompError::Ok;
 }
 
+StompError StompFrame::ValidateParts(StompCommand command,
+                                     const Headers& headers,
+                                     std::string_view body)
+{
+    if (command == StompCommand::Invalid) {
+        return StompError::InvalidCommand;
+    }
+    for (const auto& [header, value] : headers) {
+        if (header == StompHeader::Invalid) {
+            return StompError::InvalidHeader;
+        }
+        if (value.empty()) {
+            return StompError::EmptyHeaderValue;
+        }
+        if (FindFirstOf<'\n', '\0'>(value, 0) != std::string_view::npos) {
+            return StompError::InvalidHeaderValue;
+        }
+    }
+    if (!headers.count(StompHeader::ContentLength) &&
+        body.find('\0') != std::string_view::npos) {
+        return StompError::JunkAfterBody;
+    }
+    return StompError::Ok;
+}
+
+// The content starts with room for the head, followed by the body and the closing null
+// character. The head is written in place and the views are set on the content.
+void StompFrame::WriteHead(StompCommand command, const Headers& headers)
+{
+    char* const begin{plain_content_.data()};
+    char* output{begin};
+    const auto write{[&output](std::string_view text) {
+        output = std::copy(text.begin(), text.end(), output);
+    }};
+
+    command_ = command;
+    write(ToStringView(command));
+    *output++ = '\n';
+    for (const auto& [header, value] : headers) {
+        write(ToStringView(header));
+        *output++ = ':';
+        headers_.emplace(header, std::string_view{output, value.size()});
+        write(value);
+        *output++ = '\n';
+    }
+    *output++ = '\n';
+
+    const auto body_start{static_cast<std::size_t>(output - begin)};
+    body_ = std::string_view{plain_content_}.substr(
+        body_start, plain_content_.size() - body_start - 1);
+}
+
 StompCommand StompFrame::GetCommand() const
 {
     return command_;
@@ -441,14 +883,56 @@ const std::string_view& StompFrame::GetBody() const
     return body_;
 }
 
-std::string StompFrame::ToString() const {
-    std::ostringstream stream;
-    stream << GetCommand() << "\n";
-    for (const auto& [header, value] : GetAllHeaders()) {
-        stream << header << ":" << value << "\n";
+std::string_view StompFrame::GetViewedContent() const
+{
+    const std::less<const char*> is_before{};
+    const char* first{nullptr};
+    const char* last{nullptr};
+    const auto extend{[&is_before, &first, &last](std::string_view view) {
+        if (view.data() == nullptr) {
+            return;
+        }
+        if (first == nullptr || is_before(view.data(), first)) {
+            first = view.data();
+        }
+        if (last == nullptr || is_before(last, view.data() + view.size())) {
+            last = view.data() + view.size();
+        }
+    }};
+    for (const auto& [header, value] : headers_) {
+        extend(value);
+    }
+    extend(body_);
+    if (first == nullptr) {
+        return {};
     }
-    stream << "\n" << GetBody();
-    stream.put('\0');
+    return {first, static_cast<std::size_t>(last - first)};
+}
 
-    return stream.str();
+std::string StompFrame::ToString() const
+{
+    std::string output{};
+    SerializeTo(output);
+    return output;
+}
+
+std::size_t StompFrame::GetSerializedSize() const
+{
+    return GetHeadSize(command_, headers_) + body_.size() + 1;
+}
+
+void StompFrame::SerializeTo(std::string& output) const
+{
+    output.reserve(output.size() + GetSerializedSize());
+    output.append(ToStringView(command_));
+    output.push_back('\n');
+    for (const auto& [header, value] : headers_) {
+        output.append(ToStringView(header));
+        output.push_back(':');
+        output.append(value);
+        output.push_back('\n');
+    }
+    output.push_back('\n');
+    output.append(body_);
+    output.push_back('\0');
 }
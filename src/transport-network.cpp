@@ -1,9 +1,758 @@
 #include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <network-monitor/metrics.hpp>
 #include <network-monitor/transport-network.hpp>
+#include <optional>
 #include <stdexcept>
+#include <streambuf>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
 
 using namespace NetworkMonitor;
 
+namespace {
+/*! \brief Binary min-heap of integer items keyed by an external array.
+ *
+ *  All storage is allocated once, at construction: items are in [0, capacity), and
+ *  each item is at most once in the heap. Lowering the key of an item that is
+ *  already in the heap moves it in place (decrease-key).
+ */
+class IndexedMinHeap {
+   public:
+    IndexedMinHeap(std::size_t capacity, const std::vector<unsigned int>& keys)
+        : keys_{keys},
+          positions_(capacity, not_in_heap)
+    {
+        heap_.reserve(capacity);
+    }
+
+    bool Empty() const { return heap_.empty(); }
+
+    // Insert the item, or restore the heap order after its key was lowered.
+    void PushOrDecrease(std::uint32_t item)
+    {
+        if (positions_[item] == not_in_heap) {
+            positions_[item] = heap_.size();
+            heap_.push_back(item);
+        }
+        SiftUp(positions_[item]);
+    }
+
+    std::uint32_t Pop()
+    {
+        const auto top{heap_.front()};
+        positions_[top] = not_in_heap;
+        if (heap_.size() > 1) {
+            heap_.front() = heap_.back();
+            positions_[heap_.front()] = 0;
+        }
+        heap_.pop_back();
+        if (!heap_.empty()) {
+            SiftDown(0);
+        }
+        return top;
+    }
+
+   private:
+    static constexpr std::size_t not_in_heap{std::numeric_limits<std::size_t>::max()};
+
+    void SiftUp(std::size_t position)
+    {
+        const auto item{heap_[position]};
+        while (position > 0) {
+            const auto parent{(position - 1) / 2};
+            if (keys_[heap_[parent]] <= keys_[item]) {
+                break;
+            }
+            Place(heap_[parent], position);
+            position = parent;
+        }
+        Place(item, position);
+    }
+
+    void SiftDown(std::size_t position)
+    {
+        const auto item{heap_[position]};
+        while (true) {
+            auto child{2 * position + 1};
+            if (child >= heap_.size()) {
+                break;
+            }
+            if (child + 1 < heap_.size() &&
+                keys_[heap_[child + 1]] < keys_[heap_[child]]) {
+                child++;
+            }
+            if (keys_[item] <= keys_[heap_[child]]) {
+                break;
+            }
+            Place(heap_[child], position);
+            position = child;
+        }
+        Place(item, position);
+    }
+
+    void Place(std::uint32_t item, std::size_t position)
+    {
+        heap_[position] = item;
+        positions_[item] = position;
+    }
+
+    const std::vector<unsigned int>& keys_;
+    std::vector<std::uint32_t> heap_{};
+    std::vector<std::size_t> positions_;
+};
+
+// Snapshot file layout: a SnapshotHeader, then `payload_size` bytes of payload. The
+// payload is a list of native-endian 32-bit words (counters and arrays, see
+// TransportNetwork::SaveSnapshot) followed by the bytes of all strings.
+constexpr char snapshot_magic[8]{'N', 'M', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr std::uint32_t snapshot_version{2};
+// Written as a native word: a snapshot is only loaded on a machine of the same
+// endianness.
+constexpr std::uint32_t snapshot_byte_order{0x01020304};
+
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t payload_size;
+    std::uint64_t checksum;
+};
+
+// 64-bit FNV-1a.
+std::uint64_t SnapshotChecksum(const char* data, std::size_t size)
+{
+    std::uint64_t hash{14695981039346656037ull};
+    for (std::size_t index = 0; index < size; index++) {
+        hash ^= static_cast<unsigned char>(data[index]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Bounds-checked sequential reads from a snapshot payload.
+class SnapshotReader {
+   public:
+    explicit SnapshotReader(const std::string& payload) : payload_{payload} {}
+
+    bool Read(std::uint32_t& value) { return ReadBytes(&value, sizeof(value)); }
+
+    bool Read(std::vector<std::uint32_t>& values, std::size_t count)
+    {
+        if (count > (payload_.size() - position_) / sizeof(std::uint32_t)) {
+            return false;
+        }
+        values.resize(count);
+        return ReadBytes(values.data(), count * sizeof(std::uint32_t));
+    }
+
+    bool Read(std::string& bytes, std::size_t count)
+    {
+        if (count > payload_.size() - position_) {
+            return false;
+        }
+        bytes.assign(payload_, position_, count);
+        position_ += count;
+        return true;
+    }
+
+    bool AtEnd() const { return position_ == payload_.size(); }
+
+   private:
+    bool ReadBytes(void* destination, std::size_t size)
+    {
+        if (size > payload_.size() - position_) {
+            return false;
+        }
+        std::memcpy(destination, payload_.data() + position_, size);
+        position_ += size;
+        return true;
+    }
+
+    const std::string& payload_;
+    std::size_t position_{0};
+};
+
+// Offsets into an array of `size` items: they start at 0, never decrease and end at
+// `size`.
+bool AreValidOffsets(const std::vector<std::uint32_t>& offsets, std::size_t size)
+{
+    return !offsets.empty() && offsets.front() == 0 && offsets.back() == size &&
+           std::is_sorted(offsets.begin(), offsets.end());
+}
+
+bool AreValidIndices(const std::vector<std::uint32_t>& indices, std::size_t size)
+{
+    return std::all_of(indices.begin(), indices.end(),
+                       [size](auto index) { return index < size; });
+}
+
+/*! \brief Stream buffer reading the chunks that another thread pushes.
+ *
+ *  Reads block until the next chunk is pushed, or until the writer closes the buffer.
+ *  Pushes block while too many chunks are waiting, so a slow reader bounds the memory
+ *  held by the buffer.
+ */
+class ChunkStreamBuffer : public std::streambuf {
+   public:
+    /*! \brief Queue a copy of the chunk.
+     *
+     *  \returns false if the reader has stopped reading.
+     */
+    bool Push(std::string_view chunk)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        space_available_.wait(
+            lock, [this]() { return abandoned_ || chunks_.size() < max_queued_chunks; });
+        if (abandoned_) {
+            return false;
+        }
+        if (!chunk.empty()) {
+            chunks_.emplace_back(chunk);
+            data_available_.notify_one();
+        }
+        return true;
+    }
+
+    // Called by the writer, once all the chunks are pushed.
+    void Close()
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        closed_ = true;
+        data_available_.notify_one();
+    }
+
+    // Called by the reader, once it stops reading.
+    void Abandon()
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        abandoned_ = true;
+        space_available_.notify_one();
+    }
+
+   protected:
+    int_type underflow() override
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        data_available_.wait(lock, [this]() { return closed_ || !chunks_.empty(); });
+        if (chunks_.empty()) {
+            return traits_type::eof();
+        }
+        current_ = std::move(chunks_.front());
+        chunks_.pop_front();
+        space_available_.notify_one();
+        setg(current_.data(), current_.data(), current_.data() + current_.size());
+        return traits_type::to_int_type(current_.front());
+    }
+
+   private:
+    static constexpr std::size_t max_queued_chunks{64};
+
+    std::mutex mutex_{};
+    std::condition_variable data_available_{};
+    std::condition_variable space_available_{};
+    std::deque<std::string> chunks_{};
+    bool closed_{false};
+    bool abandoned_{false};
+
+    // Only accessed by the reader.
+    std::string current_{};
+};
+
+// Closes a chunk stream and joins its reader thread when leaving the scope, also when
+// the writer throws: destroying a joinable thread terminates the program.
+class ChunkStreamReaderGuard {
+   public:
+    ChunkStreamReaderGuard(ChunkStreamBuffer& buffer, std::thread& reader)
+        : buffer_{buffer}, reader_{reader}
+    {
+    }
+
+    ~ChunkStreamReaderGuard()
+    {
+        Join();
+    }
+
+    ChunkStreamReaderGuard(const ChunkStreamReaderGuard&) = delete;
+    ChunkStreamReaderGuard& operator=(const ChunkStreamReaderGuard&) = delete;
+
+    void Join()
+    {
+        if (reader_.joinable()) {
+            buffer_.Close();
+            reader_.join();
+        }
+    }
+
+   private:
+    ChunkStreamBuffer& buffer_;
+    std::thread& reader_;
+};
+
+// Stations resolved during one batch of passenger events.
+//
+// The slot of an ID only depends on its length and last two characters, where the IDs
+// of a network usually differ, so a repeated ID is found without hashing it again.
+// IDs sharing a slot evict each other, and are then resolved again.
+class ResolvedStations {
+   public:
+    using Handle = IdInterner::Handle;
+
+    template <typename Resolve>
+    Handle Find(std::string_view id, const Resolve& resolve)
+    {
+        auto& entry{entries_[GetSlot(id)]};
+        if (entry.id.data() == nullptr || entry.id != id) {
+            entry.id = id;
+            entry.handle = resolve(id);
+        }
+        return entry.handle;
+    }
+
+   private:
+    static constexpr std::size_t slots_count{64};
+
+    struct Entry {
+        std::string_view id{};
+        Handle handle{IdInterner::invalid_handle};
+    };
+
+    static std::size_t GetSlot(std::string_view id)
+    {
+        std::size_t key{id.size()};
+        if (id.size() >= 1) {
+            key += static_cast<unsigned char>(id[id.size() - 1]);
+        }
+        if (id.size() >= 2) {
+            key += 31 * static_cast<unsigned char>(id[id.size() - 2]);
+        }
+        return key % slots_count;
+    }
+
+    std::array<Entry, slots_count> entries_{};
+};
+}  // namespace
+
+/*! \brief Builds the network straight from the SAX events of a network layout.
+ *
+ *  Lines usually come before stations in the layout files. A route stop naming a
+ *  station that was not defined yet adds a placeholder station, with no name, that the
+ *  station definition completes later on. Travel times that come before the lines are
+ *  kept aside until the route edges are in place.
+ */
+class TransportNetwork::JsonLayoutLoader : public nlohmann::json_sax<nlohmann::json> {
+   public:
+    explicit JsonLayoutLoader(TransportNetwork& network)
+        : network_{network},
+          station_defined_(network.layout_->nodes.size(), true)
+    {
+    }
+
+    /*! \brief Check the loaded layout is complete, once the document is parsed.
+     *
+     *  \returns false if the stations and lines were loaded, but not the travel times.
+     */
+    bool Finish() const
+    {
+        if (!has_stations_ || !has_lines_ || !has_travel_times_) {
+            throw std::runtime_error(
+                "Network layout must have stations, lines and travel_times");
+        }
+        if (undefined_stations_ > 0) {
+            const auto station{static_cast<StationIndex>(std::distance(
+                station_defined_.begin(),
+                std::find(station_defined_.begin(), station_defined_.end(), false)))};
+            throw std::runtime_error("Adding line failed: unknown station [id: " +
+                                     network_.layout_->station_ids.GetId(station) + "]");
+        }
+        return travel_times_ok_;
+    }
+
+    bool null() override { return true; }
+
+    bool boolean(bool) override { return true; }
+
+    bool number_integer(number_integer_t value) override
+    {
+        return number_unsigned(static_cast<number_unsigned_t>(value));
+    }
+
+    bool number_unsigned(number_unsigned_t value) override
+    {
+        if (Top() == Context::TravelTime && key_ == "travel_time") {
+            travel_time_ = static_cast<unsigned int>(value);
+        }
+        return true;
+    }
+
+    bool number_float(number_float_t, const string_t&) override { return true; }
+
+    bool string(string_t& value) override
+    {
+        switch (Top()) {
+            case Context::Station: {
+                if (key_ == "station_id") {
+                    station_id_ = std::move(value);
+                } else if (key_ == "name") {
+                    station_name_ = std::move(value);
+                }
+                break;
+            }
+            case Context::Line: {
+                if (key_ == "line_id") {
+                    line_id_ = std::move(value);
+                } else if (key_ == "name") {
+                    line_name_ = std::move(value);
+                }
+                break;
+            }
+            case Context::Route: {
+                if (key_ == "route_id") {
+                    route_id_ = std::move(value);
+                }
+                break;
+            }
+            case Context::RouteStops: {
+                route_stations_.push_back(ResolveStation(value));
+                break;
+            }
+            case Context::TravelTime: {
+                if (key_ == "start_station_id") {
+                    start_station_id_ = std::move(value);
+                } else if (key_ == "end_station_id") {
+                    end_station_id_ = std::move(value);
+                }
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool binary(binary_t&) override { return true; }
+
+    bool start_object(std::size_t) override
+    {
+        const auto context{ChildContext(true)};
+        switch (context) {
+            case Context::Station: {
+                station_id_.reset();
+                station_name_.reset();
+                break;
+            }
+            case Context::Line: {
+                line_id_.reset();
+                line_name_.reset();
+                line_routes_.clear();
+                break;
+            }
+            case Context::Route: {
+                route_id_.reset();
+                route_stations_.clear();
+                break;
+            }
+            case Context::TravelTime: {
+                start_station_id_.reset();
+                end_station_id_.reset();
+                travel_time_.reset();
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+        contexts_.push_back(context);
+        return true;
+    }
+
+    bool key(string_t& value) override
+    {
+        key_.assign(value);
+        return true;
+    }
+
+    bool end_object() override
+    {
+        const auto context{Top()};
+        contexts_.pop_back();
+        switch (context) {
+            case Context::Station: {
+                AddStation();
+                break;
+            }
+            case Context::Line: {
+                AddLine();
+                break;
+            }
+            case Context::Route: {
+                AddRoute();
+                break;
+            }
+            case Context::TravelTime: {
+                AddTravelTime();
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool start_array(std::size_t) override
+    {
+        const auto context{ChildContext(false)};
+        switch (context) {
+            case Context::Stations: {
+                has_stations_ = true;
+                break;
+            }
+            case Context::Lines: {
+                has_lines_ = true;
+                break;
+            }
+            case Context::TravelTimes: {
+                has_travel_times_ = true;
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+        contexts_.push_back(context);
+        return true;
+    }
+
+    bool end_array() override
+    {
+        const auto context{Top()};
+        contexts_.pop_back();
+        if (context == Context::Lines) {
+            // All route edges are merged into the adjacency arrays at once.
+            network_.AddEdgesInternal(std::move(pending_edges_));
+            pending_edges_.clear();
+            edges_ready_ = true;
+            for (const auto& travel_time : pending_travel_times_) {
+                SetTravelTime(std::get<0>(travel_time), std::get<1>(travel_time),
+                              std::get<2>(travel_time));
+            }
+            pending_travel_times_.clear();
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t,
+                     const std::string&,
+                     const nlohmann::json::exception& error) override
+    {
+        if (const auto* parse_error{
+                dynamic_cast<const nlohmann::json::parse_error*>(&error)}) {
+            throw *parse_error;
+        }
+        throw std::runtime_error(error.what());
+    }
+
+   private:
+    enum class Context {
+        Document,
+        Stations,
+        Station,
+        Lines,
+        Line,
+        Routes,
+        Route,
+        RouteStops,
+        TravelTimes,
+        TravelTime,
+        Ignored,
+    };
+
+    Context Top() const
+    {
+        return contexts_.empty() ? Context::Ignored : contexts_.back();
+    }
+
+    Context ChildContext(bool is_object) const
+    {
+        if (contexts_.empty()) {
+            return is_object ? Context::Document : Context::Ignored;
+        }
+        switch (contexts_.back()) {
+            case Context::Document: {
+                if (is_object) {
+                    return Context::Ignored;
+                }
+                if (key_ == "stations") {
+                    return Context::Stations;
+                }
+                if (key_ == "lines") {
+                    return Context::Lines;
+                }
+                if (key_ == "travel_times") {
+                    return Context::TravelTimes;
+                }
+                return Context::Ignored;
+            }
+            case Context::Stations: {
+                return is_object ? Context::Station : Context::Ignored;
+            }
+            case Context::Lines: {
+                return is_object ? Context::Line : Context::Ignored;
+            }
+            case Context::Line: {
+                return !is_object && key_ == "routes" ? Context::Routes
+                                                      : Context::Ignored;
+            }
+            case Context::Routes: {
+                return is_object ? Context::Route : Context::Ignored;
+            }
+            case Context::Route: {
+                return !is_object && key_ == "route_stops" ? Context::RouteStops
+                                                           : Context::Ignored;
+            }
+            case Context::TravelTimes: {
+                return is_object ? Context::TravelTime : Context::Ignored;
+            }
+            default: {
+                return Context::Ignored;
+            }
+        }
+    }
+
+    StationIndex ResolveStation(std::string& station_id)
+    {
+        auto station{network_.layout_->station_ids.Find(station_id)};
+        if (station == IdInterner::invalid_handle) {
+            station = static_cast<StationIndex>(network_.layout_->nodes.size());
+            network_.AddStationInternal({std::move(station_id), {}});
+            station_defined_.push_back(false);
+            undefined_stations_++;
+        }
+        return station;
+    }
+
+    void AddStation()
+    {
+        if (!station_id_ || !station_name_) {
+            throw std::runtime_error("Station must have a station_id and a name");
+        }
+        const auto station{network_.layout_->station_ids.Find(*station_id_)};
+        if (station == IdInterner::invalid_handle) {
+            network_.AddStationInternal(
+                {std::move(*station_id_), std::move(*station_name_)});
+            station_defined_.push_back(true);
+            return;
+        }
+        if (station_defined_[station]) {
+            throw std::runtime_error("Adding station failed [id: " + *station_id_ +
+                                     ", name: " + *station_name_ + "]");
+        }
+        network_.MutableLayout().nodes[station].name = std::move(*station_name_);
+        station_defined_[station] = true;
+        undefined_stations_--;
+    }
+
+    void AddRoute()
+    {
+        if (!route_id_) {
+            throw std::runtime_error("Route must have a route_id");
+        }
+        for (const auto route : line_routes_) {
+            if (network_.layout_->routes[route].id == *route_id_) {
+                throw std::runtime_error("Adding line failed: duplicate route [id: " +
+                                         *route_id_ + "]");
+            }
+        }
+        // Lines are added after all their routes, so this is the index the line will get.
+        const auto line{static_cast<LineIndex>(network_.layout_->lines.size())};
+        RouteInternal route{*route_id_, line};
+        route.stations = route_stations_;
+        line_routes_.push_back(
+            network_.AddRouteInternal(std::move(route), pending_edges_));
+    }
+
+    void AddLine()
+    {
+        if (!line_id_ || !line_name_) {
+            throw std::runtime_error("Line must have a line_id and a name");
+        }
+        if (network_.layout_->line_ids.Contains(*line_id_)) {
+            throw std::runtime_error("Adding line failed [id: " + *line_id_ +
+                                     ", name: " + *line_name_ + "]");
+        }
+        LineInternal line{*line_id_, *line_name_};
+        line.routes = line_routes_;
+        network_.AddLineInternal(std::move(line));
+    }
+
+    void AddTravelTime()
+    {
+        if (!start_station_id_ || !end_station_id_ || !travel_time_) {
+            throw std::runtime_error(
+                "Travel time must have a start_station_id, an end_station_id and a "
+                "travel_time");
+        }
+        if (!edges_ready_) {
+            pending_travel_times_.emplace_back(std::move(*start_station_id_),
+                                               std::move(*end_station_id_),
+                                               *travel_time_);
+            return;
+        }
+        SetTravelTime(*start_station_id_, *end_station_id_, *travel_time_);
+    }
+
+    void SetTravelTime(const Id& station_a, const Id& station_b, unsigned int travel_time)
+    {
+        // As with FromJson, the first bad travel time stops the travel time updates.
+        if (travel_times_ok_) {
+            travel_times_ok_ = network_.SetTravelTime(station_a, station_b, travel_time);
+        }
+    }
+
+    TransportNetwork& network_;
+
+    std::vector<Context> contexts_{};
+    std::string key_{};
+
+    bool has_stations_{false};
+    bool has_lines_{false};
+    bool has_travel_times_{false};
+
+    // Placeholder stations are the ones not defined yet.
+    std::vector<bool> station_defined_;
+    std::size_t undefined_stations_{0};
+
+    std::optional<Id> station_id_{};
+    std::optional<std::string> station_name_{};
+
+    std::optional<Id> line_id_{};
+    std::optional<std::string> line_name_{};
+    std::vector<RouteIndex> line_routes_{};
+
+    std::optional<Id> route_id_{};
+    std::vector<StationIndex> route_stations_{};
+    std::vector<PendingEdge> pending_edges_{};
+    bool edges_ready_{false};
+
+    std::optional<Id> start_station_id_{};
+    std::optional<Id> end_station_id_{};
+    std::optional<unsigned int> travel_time_{};
+    std::vector<std::tuple<Id, Id, unsigned int>> pending_travel_times_{};
+    bool travel_times_ok_{true};
+};
+
 bool Station::operator==(const Station& other) const
 {
     return id == other.id;
@@ -24,17 +773,52 @@ TransportNetwork::TransportNetwork() {}
 TransportNetwork::~TransportNetwork() {}
 
 TransportNetwork::TransportNetwork(const TransportNetwork& copied)
-    : stations_{copied.stations_},
-      lines_{copied.lines_}
+    : TransportNetwork{copied, SharePassengerCounts{}}
+{
+    // Passenger events can be recorded from several threads: the counters must not
+    // be shared.
+    passenger_counts_.Unshare();
+}
+
+TransportNetwork::TransportNetwork(const TransportNetwork& copied, SharePassengerCounts)
+    : layout_{copied.layout_},
+      edge_travel_times_{copied.edge_travel_times_},
+      stop_travel_times_{copied.stop_travel_times_},
+      passenger_counts_{copied.passenger_counts_}
 {
 }
 
 TransportNetwork::TransportNetwork(TransportNetwork&& moved)
-    : stations_{std::move(moved.stations_)},
-      lines_{std::move(moved.lines_)}
+    : layout_{std::exchange(moved.layout_, std::make_shared<Layout>())},
+      edge_travel_times_{std::exchange(moved.edge_travel_times_, {})},
+      stop_travel_times_{std::exchange(moved.stop_travel_times_, {})},
+      passenger_counts_{std::exchange(moved.passenger_counts_, {})}
 {
 }
 
+TransportNetwork& TransportNetwork::operator=(const TransportNetwork& copied)
+{
+    if (this != &copied) {
+        layout_ = copied.layout_;
+        edge_travel_times_ = copied.edge_travel_times_;
+        stop_travel_times_ = copied.stop_travel_times_;
+        passenger_counts_ = copied.passenger_counts_;
+        passenger_counts_.Unshare();
+    }
+    return *this;
+}
+
+TransportNetwork& TransportNetwork::operator=(TransportNetwork&& moved)
+{
+    if (this != &moved) {
+        layout_ = std::exchange(moved.layout_, std::make_shared<Layout>());
+        edge_travel_times_ = std::exchange(moved.edge_travel_times_, {});
+        stop_travel_times_ = std::exchange(moved.stop_travel_times_, {});
+        passenger_counts_ = std::exchange(moved.passenger_counts_, {});
+    }
+    return *this;
+}
+
 bool TransportNetwork::FromJson(nlohmann::json&& source)
 {
     for (const auto& station : source.at("stations")) {
@@ -82,6 +866,336 @@ bool TransportNetwork::FromJson(nlohmann::json&& source)
     return true;
 }
 
+bool TransportNetwork::FromJsonStream(std::istream& source)
+{
+    JsonLayoutLoader loader{*this};
+    nlohmann::json::sax_parse(source, &loader);
+    return loader.Finish();
+}
+
+bool TransportNetwork::FromJsonFile(const std::filesystem::path& source)
+{
+    std::ifstream file{source, std::ios::binary};
+    if (!file) {
+        throw std::runtime_error("Could not open network layout [path: " +
+                                 source.string() + "]");
+    }
+    return FromJsonStream(file);
+}
+
+bool TransportNetwork::FromJsonDownload(FileDownloader& downloader,
+                                        const std::string& file_url,
+                                        const std::filesystem::path& cache)
+{
+    ChunkStreamBuffer buffer{};
+    bool parsed{false};
+    bool ok{false};
+    std::exception_ptr parse_error{};
+    std::thread parser{[this, &buffer, &parsed, &ok, &parse_error]() {
+        std::istream source{&buffer};
+        // Nothing is pushed if the cached copy is up to date.
+        parsed = source.peek() != std::istream::traits_type::eof();
+        if (parsed) {
+            try {
+                ok = FromJsonStream(source);
+            } catch (...) {
+                parse_error = std::current_exception();
+            }
+        }
+        buffer.Abandon();
+    }};
+    ChunkStreamReaderGuard parser_guard{buffer, parser};
+
+    bool parser_stopped{false};
+    const auto result{downloader.Stream(
+        file_url,
+        [&buffer, &parser_stopped](std::string_view chunk) {
+            parser_stopped = !buffer.Push(chunk);
+            return !parser_stopped;
+        },
+        cache)};
+    parser_guard.Join();
+
+    // When the parser fails first, the download is aborted: the parse error is the
+    // cause.
+    if (parse_error && (result == DownloadResult::Downloaded || parser_stopped)) {
+        std::rethrow_exception(parse_error);
+    }
+    switch (result) {
+        case DownloadResult::Downloaded: {
+            if (!parsed) {
+                throw std::runtime_error("Empty network layout [url: " + file_url + "]");
+            }
+            return ok;
+        }
+        case DownloadResult::NotModified: {
+            return FromJsonFile(cache);
+        }
+        default: {
+            throw std::runtime_error("Could not download network layout [url: " +
+                                     file_url + "]");
+        }
+    }
+}
+
+bool TransportNetwork::SaveSnapshot(const std::filesystem::path& destination) const
+{
+    const auto& layout{*layout_};
+    // The string table. Station strings come first: station `s` has its ID at `2 * s`
+    // and its name at `2 * s + 1`.
+    std::string string_bytes{};
+    std::vector<std::uint32_t> string_offsets{0};
+    auto add_string{[&string_bytes, &string_offsets](std::string_view value) {
+        string_bytes.append(value);
+        string_offsets.push_back(static_cast<std::uint32_t>(string_bytes.size()));
+        return static_cast<std::uint32_t>(string_offsets.size() - 2);
+    }};
+
+    std::vector<std::uint32_t> station_strings{};
+    station_strings.reserve(2 * layout.nodes.size());
+    for (StationIndex station = 0; station < layout.nodes.size(); station++) {
+        station_strings.push_back(add_string(layout.station_ids.GetId(station)));
+        station_strings.push_back(add_string(layout.nodes[station].name));
+    }
+
+    std::vector<std::uint32_t> edges{};
+    edges.reserve(4 * layout.edges.size());
+    for (EdgeIndex edge = 0; edge < layout.edges.size(); edge++) {
+        edges.insert(edges.end(), {layout.edges[edge].route, layout.edges[edge].stop,
+                                   layout.edges[edge].next_station,
+                                   edge_travel_times_[edge]});
+    }
+
+    std::vector<std::uint32_t> route_records{};
+    std::vector<std::uint32_t> route_station_offsets{0};
+    std::vector<std::uint32_t> route_stations{};
+    std::vector<std::uint32_t> route_cumulative_times{};
+    for (const auto& route : layout.routes) {
+        route_records.insert(route_records.end(), {add_string(route.id), route.line});
+        route_stations.insert(route_stations.end(), route.stations.begin(),
+                              route.stations.end());
+        for (std::size_t position = 0; position < route.stations.size(); position++) {
+            route_cumulative_times.push_back(
+                stop_travel_times_[route.first_stop + position]);
+        }
+        route_station_offsets.push_back(
+            static_cast<std::uint32_t>(route_stations.size()));
+    }
+
+    std::vector<std::uint32_t> line_strings{};
+    std::vector<std::uint32_t> line_route_offsets{0};
+    std::vector<std::uint32_t> line_routes{};
+    for (const auto& line : layout.lines) {
+        line_strings.insert(line_strings.end(),
+                            {add_string(line.id), add_string(line.name)});
+        line_routes.insert(line_routes.end(), line.routes.begin(), line.routes.end());
+        line_route_offsets.push_back(static_cast<std::uint32_t>(line_routes.size()));
+    }
+
+    std::vector<std::uint32_t> words{
+        static_cast<std::uint32_t>(string_offsets.size() - 1),
+        static_cast<std::uint32_t>(string_bytes.size()),
+        static_cast<std::uint32_t>(layout.nodes.size()),
+        static_cast<std::uint32_t>(layout.edges.size()),
+        static_cast<std::uint32_t>(layout.routes.size()),
+        static_cast<std::uint32_t>(route_stations.size()),
+        static_cast<std::uint32_t>(layout.lines.size()),
+        static_cast<std::uint32_t>(line_routes.size()),
+    };
+    const std::vector<std::uint32_t>* arrays[]{
+        &string_offsets, &station_strings, &layout.edge_offsets, &edges, &route_records,
+        &route_station_offsets, &route_stations, &route_cumulative_times, &line_strings,
+        &line_route_offsets, &line_routes,
+    };
+    for (const auto* array : arrays) {
+        words.insert(words.end(), array->begin(), array->end());
+    }
+
+    std::string payload(words.size() * sizeof(std::uint32_t), '\0');
+    std::memcpy(payload.data(), words.data(), payload.size());
+    payload.append(string_bytes);
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+    header.version = snapshot_version;
+    header.byte_order = snapshot_byte_order;
+    header.payload_size = payload.size();
+    header.checksum = SnapshotChecksum(payload.data(), payload.size());
+
+    std::ofstream file{destination, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(payload.data(), payload.size());
+    file.close();
+    return !file.fail();
+}
+
+bool TransportNetwork::LoadSnapshot(const std::filesystem::path& source)
+{
+    std::ifstream file{source, std::ios::binary};
+    SnapshotHeader header{};
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    if (std::memcmp(header.magic, snapshot_magic, sizeof(header.magic)) != 0 ||
+        header.version != snapshot_version || header.byte_order != snapshot_byte_order) {
+        return false;
+    }
+    std::error_code error{};
+    const auto file_size{std::filesystem::file_size(source, error)};
+    if (error || header.payload_size != file_size - sizeof(header)) {
+        return false;
+    }
+    std::string payload(header.payload_size, '\0');
+    if (!file.read(payload.data(), payload.size()) ||
+        SnapshotChecksum(payload.data(), payload.size()) != header.checksum) {
+        return false;
+    }
+
+    SnapshotReader reader{payload};
+    std::uint32_t strings{0};
+    std::uint32_t string_size{0};
+    std::uint32_t stations{0};
+    std::uint32_t edges{0};
+    std::uint32_t routes{0};
+    std::uint32_t route_stops{0};
+    std::uint32_t lines{0};
+    std::uint32_t line_route_count{0};
+    for (auto* count : {&strings, &string_size, &stations, &edges, &routes, &route_stops,
+                        &lines, &line_route_count}) {
+        if (!reader.Read(*count)) {
+            return false;
+        }
+    }
+
+    std::vector<std::uint32_t> string_offsets{};
+    std::vector<std::uint32_t> station_strings{};
+    std::vector<std::uint32_t> edge_offsets{};
+    std::vector<std::uint32_t> edge_words{};
+    std::vector<std::uint32_t> route_records{};
+    std::vector<std::uint32_t> route_station_offsets{};
+    std::vector<std::uint32_t> route_stations{};
+    std::vector<std::uint32_t> route_cumulative_times{};
+    std::vector<std::uint32_t> line_strings{};
+    std::vector<std::uint32_t> line_route_offsets{};
+    std::vector<std::uint32_t> line_routes{};
+    std::string string_bytes{};
+    const auto ok{reader.Read(string_offsets, std::size_t{strings} + 1) &&
+                  reader.Read(station_strings, std::size_t{2} * stations) &&
+                  reader.Read(edge_offsets, std::size_t{stations} + 1) &&
+                  reader.Read(edge_words, std::size_t{4} * edges) &&
+                  reader.Read(route_records, std::size_t{2} * routes) &&
+                  reader.Read(route_station_offsets, std::size_t{routes} + 1) &&
+                  reader.Read(route_stations, route_stops) &&
+                  reader.Read(route_cumulative_times, route_stops) &&
+                  reader.Read(line_strings, std::size_t{2} * lines) &&
+                  reader.Read(line_route_offsets, std::size_t{lines} + 1) &&
+                  reader.Read(line_routes, line_route_count) &&
+                  reader.Read(string_bytes, string_size) && reader.AtEnd()};
+    if (!ok) {
+        return false;
+    }
+
+    // The checksum only catches accidental corruption: the indices must still be
+    // checked before they are used.
+    bool valid{AreValidOffsets(string_offsets, string_size) &&
+               AreValidIndices(station_strings, strings) &&
+               AreValidOffsets(edge_offsets, edges) &&
+               AreValidOffsets(route_station_offsets, route_stops) &&
+               AreValidIndices(route_stations, stations) &&
+               AreValidOffsets(line_route_offsets, line_route_count) &&
+               AreValidIndices(line_routes, routes) &&
+               AreValidIndices(line_strings, strings)};
+    for (std::size_t edge = 0; valid && edge < edges; edge++) {
+        valid = edge_words[4 * edge] < routes && edge_words[4 * edge + 1] < route_stops &&
+                edge_words[4 * edge + 2] < stations;
+    }
+    for (std::size_t route = 0; valid && route < routes; route++) {
+        valid = route_records[2 * route] < strings &&
+                route_records[2 * route + 1] < lines;
+    }
+    if (!valid) {
+        return false;
+    }
+    auto get_string{[&string_bytes, &string_offsets](std::uint32_t index) {
+        return std::string_view{string_bytes}.substr(
+            string_offsets[index], string_offsets[index + 1] - string_offsets[index]);
+    }};
+
+    // Build a new network and only replace this one once the whole snapshot is read.
+    TransportNetwork network{};
+    auto& layout{network.MutableLayout()};
+    for (StationIndex station = 0; station < stations; station++) {
+        const Station new_station{
+            Id{get_string(station_strings[2 * station])},
+            std::string{get_string(station_strings[2 * station + 1])},
+        };
+        if (layout.station_ids.Contains(new_station.id)) {
+            return false;
+        }
+        network.AddStationInternal(new_station);
+    }
+
+    // Replaces the empty adjacency ranges of the new stations.
+    layout.edge_offsets = std::move(edge_offsets);
+    layout.edges.reserve(edges);
+    for (std::size_t edge = 0; edge < edges; edge++) {
+        layout.edges.emplace_back(edge_words[4 * edge], edge_words[4 * edge + 1],
+                                  edge_words[4 * edge + 2]);
+        network.edge_travel_times_.EmplaceBack(edge_words[4 * edge + 3]);
+    }
+
+    layout.routes.reserve(routes);
+    layout.stop_routes.reserve(route_stops);
+    for (RouteIndex route = 0; route < routes; route++) {
+        RouteInternal route_internal{Id{get_string(route_records[2 * route])},
+                                     route_records[2 * route + 1]};
+        route_internal.first_stop = static_cast<StopIndex>(layout.stop_routes.size());
+        const auto first{route_station_offsets[route]};
+        const auto last{route_station_offsets[route + 1]};
+        route_internal.stations.assign(route_stations.begin() + first,
+                                       route_stations.begin() + last);
+        for (const auto station : route_internal.stations) {
+            auto& station_stops{layout.station_stops[station]};
+            if (station_stops.empty() ||
+                station_stops.back() < route_internal.first_stop) {
+                layout.station_route_ids[station].push_back(route_internal.id);
+            }
+            station_stops.push_back(static_cast<StopIndex>(layout.stop_routes.size()));
+            layout.stop_routes.push_back(route);
+        }
+        layout.routes.push_back(std::move(route_internal));
+    }
+    for (const auto travel_time : route_cumulative_times) {
+        network.stop_travel_times_.EmplaceBack(travel_time);
+    }
+
+    // Each edge must leave a stop of its own route, towards the next stop.
+    for (const auto& edge : layout.edges) {
+        const auto& route{layout.routes[edge.route]};
+        const auto position{edge.stop - route.first_stop};
+        if (layout.stop_routes[edge.stop] != edge.route ||
+            position + 1 >= route.stations.size() ||
+            route.stations[position + 1] != edge.next_station) {
+            return false;
+        }
+    }
+
+    layout.lines.reserve(lines);
+    for (LineIndex line = 0; line < lines; line++) {
+        LineInternal line_internal{Id{get_string(line_strings[2 * line])},
+                                   std::string{get_string(line_strings[2 * line + 1])}};
+        if (layout.line_ids.Contains(line_internal.id)) {
+            return false;
+        }
+        line_internal.routes.assign(line_routes.begin() + line_route_offsets[line],
+                                    line_routes.begin() + line_route_offsets[line + 1]);
+        network.AddLineInternal(std::move(line_internal));
+    }
+
+    *this = std::move(network);
+    return true;
+}
+
 bool TransportNetwork::AddStation(const Station& station)
 {
     if (StationExists(station.id)) {
@@ -98,130 +1212,187 @@ bool TransportNetwork::AddLine(const Line& line)
         return false;
     }
 
-    // FIXME: Move this check to the time of creating a list of stations.
-    //        So to the interation over route.stops down below?
-    //        Do this rather as a part of the optimization phase.
-    if (!StationsExist(line.routes)) {
+    // Validate the whole line first, so a rejected line leaves no trace in the network.
+    if (!StationsExist(line.routes) || !RoutesAreUnique(line)) {
         return false;
     }
 
-    // FIXME: Should not insert the newly created line into the lines_.
-    //        The function actually becomes unneccessary anymore. Make here
-    //        a direct call to std::make_shared and insert it only at the end.
-    auto line_internal = CreateLineInternal(line.id, line.name);
+    const auto line_index{static_cast<LineIndex>(layout_->lines.size())};
+    LineInternal line_internal{line.id, line.name};
+    line_internal.routes.reserve(line.routes.size());
 
+    std::vector<PendingEdge> new_edges{};
     for (const auto& route : line.routes) {
-        // FIXME: Can be written more clearly or moved to the separate function.
-        //        It does "return false if the route already existis in the line".
-        if (std::find_if(line_internal->routes.begin(), line_internal->routes.end(),
-                         [&route](auto line_route) {
-                             return route.id == line_route->id;
-                         }) != line_internal->routes.end()) {
-            return false;
-        }
-
-        // FIXME: Gather the list of stations first.
-        std::vector<std::shared_ptr<GraphNode>> stops{};
-        stops.reserve(route.stops.size());
+        RouteInternal route_internal{route.id, line_index};
+        route_internal.stations.reserve(route.stops.size());
         for (const auto& stop_id : route.stops) {
-            // FIXME: Create a separate function for getting a station. In purpose of
-            //       readability.
-            if (!StationExists(stop_id)) {
-                return false;
-            }
-            const auto station = stations_.at(stop_id);
-            stops.push_back(station);
+            route_internal.stations.push_back(layout_->station_ids.Find(stop_id));
         }
-
-        auto route_internal = std::make_shared<RouteInternal>(route.id, line_internal);
-        route_internal->stations = std::move(stops);
-
-        for (unsigned index = 0; index < route.stops.size() - 1; index++) {
-            auto& current_stop = route_internal->stations.at(index);
-            auto& next_station = route_internal->stations.at(index + 1);
-            auto graph_edge = std::make_shared<GraphEdge>(route_internal, next_station);
-            current_stop->edges.push_back(std::move(graph_edge));
-        }
-        line_internal->routes.push_back(route_internal);
+        line_internal.routes.push_back(
+            AddRouteInternal(std::move(route_internal), new_edges));
     }
+
+    AddLineInternal(std::move(line_internal));
+    AddEdgesInternal(std::move(new_edges));
     return true;
 }
 
 bool TransportNetwork::RecordPassengerEvent(const PassengerEvent& event)
 {
-    if (!StationExists(event.station_id)) {
+    return RecordPassengerEvent(layout_->station_ids.Find(event.station_id), event.type);
+}
+
+bool TransportNetwork::RecordPassengerEvent(StationHandle station,
+                                            PassengerEvent::Type type)
+{
+    if (station >= layout_->nodes.size()) {
+        GetMetrics().passenger_events_rejected.Add();
         return false;
     }
 
-    auto& passenger_count = stations_.at(event.station_id)->passenger_count;
+    // Counts are independent of each other and of the rest of the network, so relaxed
+    // ordering is enough.
+    auto& passenger_count = passenger_counts_.Mutable(station).value;
 
-    switch (event.type) {
+    switch (type) {
         case PassengerEvent::Type::In: {
-            passenger_count++;
+            passenger_count.fetch_add(1, std::memory_order_relaxed);
             break;
         }
         case PassengerEvent::Type::Out: {
-            passenger_count--;
+            passenger_count.fetch_sub(1, std::memory_order_relaxed);
             break;
         }
         default:
+            GetMetrics().passenger_events_rejected.Add();
             return false;
     }
 
+    GetMetrics().passenger_events_recorded.Add();
     return true;
 }
 
+PassengerEventsReport TransportNetwork::RecordPassengerEvents(
+    const std::vector<PassengerEvent>& events)
+{
+    PassengerEventsReport report{};
+
+    // Per-thread scratch space: deltas are indexed by station and are all zero between
+    // calls. The touched stations are the ones that may have a non-zero delta.
+    thread_local std::vector<long long int> thread_station_deltas{};
+    thread_local std::vector<StationIndex> thread_touched_stations{};
+    auto& station_deltas{thread_station_deltas};
+    auto& touched_stations{thread_touched_stations};
+    if (station_deltas.size() < layout_->nodes.size()) {
+        station_deltas.resize(layout_->nodes.size(), 0);
+    }
+    touched_stations.clear();
+
+    // Bursts usually come from a few stations, interleaved: each distinct station is
+    // looked up in the ID table once per batch.
+    const auto& station_ids{layout_->station_ids};
+    const auto find_station{[&station_ids](auto id) { return station_ids.Find(id); }};
+    ResolvedStations resolved_stations{};
+    for (std::size_t index = 0; index < events.size(); index++) {
+        const auto& event{events[index]};
+        const auto station{resolved_stations.Find(event.station_id, find_station)};
+        if (station == invalid_station_handle) {
+            report.rejected.push_back(index);
+            continue;
+        }
+        auto& station_delta{station_deltas[station]};
+        if (station_delta == 0) {
+            touched_stations.push_back(station);
+        }
+        switch (event.type) {
+            case PassengerEvent::Type::In: {
+                station_delta++;
+                break;
+            }
+            case PassengerEvent::Type::Out: {
+                station_delta--;
+                break;
+            }
+            default: {
+                report.rejected.push_back(index);
+                continue;
+            }
+        }
+        report.n_recorded++;
+    }
+
+    // Apply one update per station, in station order. A station can be touched twice
+    // if its delta went back to zero: the second time its delta is already cleared.
+    std::sort(touched_stations.begin(), touched_stations.end());
+    for (const auto station : touched_stations) {
+        auto& station_delta{station_deltas[station]};
+        if (station_delta != 0) {
+            passenger_counts_.Mutable(station).value.fetch_add(
+                station_delta, std::memory_order_relaxed);
+            station_delta = 0;
+        }
+    }
+
+    GetMetrics().passenger_events_recorded.Add(report.n_recorded);
+    GetMetrics().passenger_events_rejected.Add(report.rejected.size());
+    return report;
+}
+
 long long int TransportNetwork::GetPassengerCount(const Id& station) const
 {
-    if (!StationExists(station)) {
+    const auto station_index{layout_->station_ids.Find(station)};
+    if (station_index == invalid_station_handle) {
         throw std::runtime_error("Station id '" + station + "' unknown");
     }
-    return stations_.at(station)->passenger_count;
+    return passenger_counts_[station_index].value.load(std::memory_order_relaxed);
 }
 
-std::vector<Id> TransportNetwork::GetRoutesServingStation(const Id& station) const
+long long int TransportNetwork::GetPassengerCount(StationHandle station) const
 {
-    std::vector<Id> routes;
-    if (!StationExists(station)) {
-        return routes;
+    if (station >= layout_->nodes.size()) {
+        throw std::runtime_error("Station handle '" + std::to_string(station) +
+                                 "' unknown");
     }
+    return passenger_counts_[station].value.load(std::memory_order_relaxed);
+}
 
-    const auto& edges = stations_.at(station)->edges;
-    routes.reserve(edges.size());
-    for (const auto& edge : edges) {
-        routes.push_back(edge->route->id);
-    }
+TransportNetwork::StationHandle TransportNetwork::GetStationHandle(
+    std::string_view station) const
+{
+    return layout_->station_ids.Find(station);
+}
 
-    for (const auto& [_, line] : lines_) {
-        for (const auto& route : line->routes) {
-            const auto& end_stop = route->stations.back();
-            if (station == end_stop->id) {
-                routes.push_back(route->id);
-            }
-        }
+const std::vector<Id>& TransportNetwork::GetRoutesServingStation(
+    const Id& station) const
+{
+    static const std::vector<Id> no_routes{};
+    const auto& layout{*layout_};
+    const auto station_index{layout.station_ids.Find(station)};
+    if (station_index == invalid_station_handle) {
+        return no_routes;
     }
-
-    return routes;
+    return layout.station_route_ids[station_index];
 }
 
 bool TransportNetwork::SetTravelTime(const Id& station_a,
                                      const Id& station_b,
                                      const unsigned int travel_time)
 {
-    if (!StationExists(station_a) || !StationExists(station_b) ||
-        station_a == station_b) {
+    const auto a{layout_->station_ids.Find(station_a)};
+    const auto b{layout_->station_ids.Find(station_b)};
+    if (a == invalid_station_handle || b == invalid_station_handle || a == b) {
         return false;
     }
 
-    if (!StationsAreAdjacend(station_a, station_b)) {
+    if (!StationsAreAdjacend(a, b)) {
         return false;
     }
 
-    for (auto& edge : stations_.at(station_a)->FindEdgesToNextStation(station_b)) {
-        edge->travel_time = travel_time;
+    for (const auto edge : FindEdgesToNextStation(a, b)) {
+        SetEdgeTravelTime(edge, travel_time);
     }
-    for (auto& edge : stations_.at(station_b)->FindEdgesToNextStation(station_a)) {
-        edge->travel_time = travel_time;
+    for (const auto edge : FindEdgesToNextStation(b, a)) {
+        SetEdgeTravelTime(edge, travel_time);
     }
     return true;
 }
@@ -229,21 +1400,20 @@ bool TransportNetwork::SetTravelTime(const Id& station_a,
 unsigned int TransportNetwork::GetTravelTime(const Id& station_a,
                                              const Id& station_b) const
 {
-    if (!StationExists(station_a) || !StationExists(station_b) ||
-        station_a == station_b) {
+    const auto a{layout_->station_ids.Find(station_a)};
+    const auto b{layout_->station_ids.Find(station_b)};
+    if (a == invalid_station_handle || b == invalid_station_handle || a == b) {
         return 0;
     }
 
-    const auto edges_from_a_to_b =
-        stations_.at(station_a)->FindEdgesToNextStation(station_b);
+    const auto edges_from_a_to_b{FindEdgesToNextStation(a, b)};
     if (!edges_from_a_to_b.empty()) {
-        return edges_from_a_to_b.front()->travel_time;
+        return edge_travel_times_[edges_from_a_to_b.front()];
     }
 
-    const auto edges_from_b_to_a =
-        stations_.at(station_b)->FindEdgesToNextStation(station_a);
+    const auto edges_from_b_to_a{FindEdgesToNextStation(b, a)};
     if (!edges_from_b_to_a.empty()) {
-        return edges_from_b_to_a.front()->travel_time;
+        return edge_travel_times_[edges_from_b_to_a.front()];
     }
 
     return 0;
@@ -254,101 +1424,276 @@ unsigned int TransportNetwork::GetTravelTime(const Id& line,
                                              const Id& station_a,
                                              const Id& station_b) const
 {
-    unsigned int total_travel_time{0};
+    const auto route_internal{FindRoute(line, route)};
+    if (route_internal == nullptr) {
+        return 0;
+    }
 
-    if (station_a == station_b) {
-        return total_travel_time;
+    const auto a{layout_->station_ids.Find(station_a)};
+    const auto b{layout_->station_ids.Find(station_b)};
+    if (a == invalid_station_handle || b == invalid_station_handle || a == b) {
+        return 0;
     }
 
-    if (!lines_.count(line)) {
-        return total_travel_time;
+    // A route can go through a station more than once: ride from the last stop at A
+    // before each stop at B, and keep the shortest ride.
+    static constexpr auto no_stop{std::numeric_limits<StopIndex>::max()};
+    const auto& stations{route_internal->stations};
+    auto stop_a{no_stop};
+    std::optional<unsigned int> travel_time{};
+    for (std::uint32_t position = 0; position < stations.size(); position++) {
+        const auto stop{route_internal->first_stop + position};
+        if (stations[position] == b && stop_a != no_stop) {
+            const auto ride{stop_travel_times_[stop] - stop_travel_times_[stop_a]};
+            travel_time = std::min(travel_time.value_or(ride), ride);
+        }
+        if (stations[position] == a) {
+            stop_a = stop;
+        }
     }
+    return travel_time.value_or(0);
+}
 
-    // FIXME: Turn the below code into the new private method named FindRoute.
-    const auto& line_routes = lines_.at(line)->routes;
-    const auto route_internal =
-        std::find_if(line_routes.begin(), line_routes.end(),
-                     [route](auto line_route) { return line_route->id == route; });
-    if (route_internal == line_routes.end()) {
-        return total_travel_time;
+TravelRoute TransportNetwork::GetFastestTravelRoute(
+    const Id& station_a, const Id& station_b, unsigned int line_change_penalty) const
+{
+    const auto& layout{*layout_};
+    TravelRoute travel_route{};
+    const auto a{layout.station_ids.Find(station_a)};
+    const auto b{layout.station_ids.Find(station_b)};
+    if (a == invalid_station_handle || b == invalid_station_handle) {
+        return travel_route;
+    }
+    travel_route.start_station_id = station_a;
+    travel_route.end_station_id = station_b;
+    if (a == b) {
+        return travel_route;
     }
 
-    // Find the stations.
-    const auto station_a_node = stations_.at(station_a);
-    const auto station_b_node = stations_.at(station_b);
+    // Dijkstra over the route stops. Riding a route moves to the next stop of the same
+    // route; changing route moves to another stop of the same station.
+    static constexpr auto unreachable{std::numeric_limits<unsigned int>::max()};
+    static constexpr auto no_stop{std::numeric_limits<StopIndex>::max()};
+    const auto stops_count{layout.stop_routes.size()};
+    std::vector<unsigned int> travel_times(stops_count, unreachable);
+    std::vector<StopIndex> previous_stops(stops_count, no_stop);
+    IndexedMinHeap heap{stops_count, travel_times};
 
-    // Walk the route looking for station A.
-    bool in_range{false};
-    for (const auto& stop : (*route_internal)->stations) {
-        if (stop->id == station_a) {
-            in_range = true;
+    const auto relax = [&](StopIndex stop, unsigned int travel_time, StopIndex from) {
+        if (travel_time < travel_times[stop]) {
+            travel_times[stop] = travel_time;
+            previous_stops[stop] = from;
+            heap.PushOrDecrease(stop);
         }
-        if (stop->id == station_b) {
-            return total_travel_time;
+    };
+
+    for (const auto stop : layout.station_stops[a]) {
+        relax(stop, 0, no_stop);
+    }
+
+    auto arrival_stop{no_stop};
+    while (!heap.Empty()) {
+        const auto stop{heap.Pop()};
+        const auto& route{layout.routes[layout.stop_routes[stop]]};
+        const auto station{route.stations[stop - route.first_stop]};
+        if (station == b) {
+            arrival_stop = stop;
+            break;
         }
 
-        if (in_range) {
-            auto edge = stop->FindEdgesForRoute(*route_internal);
-            if (edge.empty()) {
-                return 0;
+        const auto travel_time{travel_times[stop]};
+        const auto position{stop - route.first_stop};
+        if (position + 1 < route.stations.size()) {
+            const auto hop_travel_time{stop_travel_times_[stop + 1] -
+                                       stop_travel_times_[stop]};
+            relax(stop + 1, travel_time + hop_travel_time, stop);
+        }
+        for (const auto other_stop : layout.station_stops[station]) {
+            if (other_stop == stop) {
+                continue;
             }
-            total_travel_time += edge.front()->travel_time;
+            const auto same_line{layout.routes[layout.stop_routes[other_stop]].line ==
+                                 route.line};
+            const auto penalty{same_line ? 0 : line_change_penalty};
+            relax(other_stop, travel_time + penalty, stop);
+        }
+    }
+
+    if (arrival_stop == no_stop) {
+        return travel_route;
+    }
+
+    // Walk the search tree back, keeping only the hops that ride a route.
+    travel_route.total_travel_time = travel_times[arrival_stop];
+    for (auto stop = arrival_stop; previous_stops[stop] != no_stop;
+         stop = previous_stops[stop]) {
+        const auto from{previous_stops[stop]};
+        if (layout.stop_routes[from] != layout.stop_routes[stop] || from + 1 != stop) {
+            continue;
         }
+        const auto& route{layout.routes[layout.stop_routes[stop]]};
+        TravelRoute::Step step{};
+        const auto position{stop - route.first_stop};
+        step.start_station_id = layout.station_ids.GetId(route.stations[position - 1]);
+        step.end_station_id = layout.station_ids.GetId(route.stations[position]);
+        step.line_id = layout.lines[route.line].id;
+        step.route_id = route.id;
+        step.travel_time = travel_times[stop] - travel_times[from];
+        travel_route.steps.push_back(std::move(step));
     }
+    std::reverse(travel_route.steps.begin(), travel_route.steps.end());
 
-    return total_travel_time;
+    return travel_route;
 }
 
 TransportNetwork::GraphNode::GraphNode(const Station& station)
-    : id{station.id},
-      name{station.name}
+    : name{station.name}
 {
 }
 
-std::vector<std::shared_ptr<TransportNetwork::GraphEdge>>
-TransportNetwork::GraphNode::FindEdgesToNextStation(const Id& next_station) const
+TransportNetwork::PassengerCounter::PassengerCounter(const PassengerCounter& copied)
+    : value{copied.value.load(std::memory_order_relaxed)}
 {
-    std::vector<std::shared_ptr<TransportNetwork::GraphEdge>> edges_to_next_station;
-    for (const auto& edge : edges) {
-        if (edge->next_station->id == next_station) {
-            edges_to_next_station.push_back(edge);
-        }
-    }
-    return edges_to_next_station;
 }
 
-std::vector<std::shared_ptr<TransportNetwork::GraphEdge>>
-TransportNetwork::GraphNode::FindEdgesForRoute(
-    const std::shared_ptr<RouteInternal>& route) const
+TransportNetwork::PassengerCounter& TransportNetwork::PassengerCounter::operator=(
+    const PassengerCounter& copied)
 {
-    std::vector<std::shared_ptr<TransportNetwork::GraphEdge>> edges_for_route;
-    std::copy_if(edges.cbegin(), edges.cend(), std::back_inserter(edges_for_route),
-                 [&route](auto& edge) { return edge->route->id == route->id; });
-    return edges_for_route;
+    value.store(copied.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
 }
 
-TransportNetwork::GraphEdge::GraphEdge(const std::shared_ptr<RouteInternal>& route,
-                                       const std::shared_ptr<GraphNode>& next_station)
+TransportNetwork::GraphEdge::GraphEdge(RouteIndex route,
+                                       StopIndex stop,
+                                       StationIndex next_station)
     : route{route},
+      stop{stop},
       next_station{next_station}
 {
 }
 
+TransportNetwork::RouteInternal::RouteInternal(const Id& id, LineIndex line)
+    : id{id},
+      line{line}
+{
+}
+
+TransportNetwork::LineInternal::LineInternal(const Id& id, const std::string& name)
+    : id{id},
+      name{name}
+{
+}
+
+TransportNetwork::Layout& TransportNetwork::MutableLayout()
+{
+    if (layout_.use_count() > 1) {
+        layout_ = std::make_shared<Layout>(*layout_);
+    } else {
+        // The other owners may have just released the layout on other threads: their
+        // reads must be done before it is changed here.
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *layout_;
+}
+
 void TransportNetwork::AddStationInternal(const Station& station)
 {
-    auto node = std::make_shared<GraphNode>(station);
-    stations_.emplace(station.id, std::move(node));
+    auto& layout{MutableLayout()};
+    layout.station_ids.Intern(station.id);
+    layout.nodes.emplace_back(station);
+    passenger_counts_.EmplaceBack();
+    layout.station_stops.emplace_back();
+    layout.station_route_ids.emplace_back();
+    // The new station has no edges yet: its adjacency range is empty.
+    layout.edge_offsets.push_back(layout.edge_offsets.back());
 }
 
-std::shared_ptr<TransportNetwork::LineInternal> TransportNetwork::CreateLineInternal(
-    const Id& id, const std::string& name)
+TransportNetwork::RouteIndex TransportNetwork::AddRouteInternal(
+    RouteInternal&& route,
+    std::vector<PendingEdge>& new_edges)
 {
-    return lines_.emplace(id, std::make_shared<LineInternal>(id, name)).first->second;
+    auto& layout{MutableLayout()};
+    const auto route_index{static_cast<RouteIndex>(layout.routes.size())};
+    route.first_stop = static_cast<StopIndex>(layout.stop_routes.size());
+    const auto& stations{route.stations};
+    for (const auto station : stations) {
+        auto& station_stops{layout.station_stops[station]};
+        // Routes that go through a station more than once are only listed once.
+        if (station_stops.empty() || station_stops.back() < route.first_stop) {
+            layout.station_route_ids[station].push_back(route.id);
+        }
+        station_stops.push_back(static_cast<StopIndex>(layout.stop_routes.size()));
+        layout.stop_routes.push_back(route_index);
+    }
+    stop_travel_times_.Append(layout.stop_routes.size() - stop_travel_times_.Size(), 0);
+
+    for (std::uint32_t position = 0; position + 1 < stations.size(); position++) {
+        new_edges.push_back({stations[position],
+                             {route_index, route.first_stop + position,
+                              stations[position + 1]}});
+    }
+
+    layout.routes.push_back(std::move(route));
+    return route_index;
 }
 
-bool TransportNetwork::StationExists(const Id& station_id) const
+void TransportNetwork::AddLineInternal(LineInternal&& line)
 {
-    return stations_.count(station_id);
+    auto& layout{MutableLayout()};
+    layout.line_ids.Intern(line.id);
+    layout.lines.push_back(std::move(line));
+}
+
+void TransportNetwork::AddEdgesInternal(std::vector<PendingEdge>&& new_edges)
+{
+    if (new_edges.empty()) {
+        return;
+    }
+    auto& layout{MutableLayout()};
+
+    // Rebuild the CSR arrays with a counting sort by source station. Edges of the same
+    // station keep their insertion order, old edges first. New edges have no travel
+    // time yet.
+    std::vector<EdgeIndex> offsets(layout.nodes.size() + 1, 0);
+    for (StationIndex station = 0; station < layout.nodes.size(); station++) {
+        offsets[station + 1] =
+            layout.edge_offsets[station + 1] - layout.edge_offsets[station];
+    }
+    for (const auto& new_edge : new_edges) {
+        offsets[new_edge.station + 1]++;
+    }
+    for (std::size_t station = 0; station < layout.nodes.size(); station++) {
+        offsets[station + 1] += offsets[station];
+    }
+
+    std::stable_sort(new_edges.begin(), new_edges.end(),
+                     [](const auto& a, const auto& b) { return a.station < b.station; });
+    std::vector<GraphEdge> edges{};
+    CopyOnWriteChunks<unsigned int> edge_travel_times{};
+    edges.reserve(offsets.back());
+    auto new_edge{new_edges.begin()};
+    for (StationIndex station = 0; station < layout.nodes.size(); station++) {
+        const auto first{layout.edge_offsets[station]};
+        const auto last{layout.edge_offsets[station + 1]};
+        edges.insert(edges.end(), layout.edges.begin() + first,
+                     layout.edges.begin() + last);
+        for (auto edge = first; edge < last; edge++) {
+            edge_travel_times.EmplaceBack(edge_travel_times_[edge]);
+        }
+        for (; new_edge != new_edges.end() && new_edge->station == station; new_edge++) {
+            edges.push_back(new_edge->edge);
+            edge_travel_times.EmplaceBack(0);
+        }
+    }
+
+    layout.edges = std::move(edges);
+    layout.edge_offsets = std::move(offsets);
+    edge_travel_times_ = std::move(edge_travel_times);
+}
+
+bool TransportNetwork::StationExists(std::string_view station_id) const
+{
+    return layout_->station_ids.Contains(station_id);
 }
 
 bool TransportNetwork::StationsExist(const std::vector<Route>& routes) const
@@ -373,33 +1718,144 @@ bool TransportNetwork::StationsExist(const std::vector<Id>& stations) const
 
 bool TransportNetwork::LineExists(const Line& line) const
 {
-    return lines_.count(line.id);
+    return layout_->line_ids.Contains(line.id);
 }
 
-bool TransportNetwork::StationsAreAdjacend(const Id& station_a, const Id& station_b) const
+bool TransportNetwork::RoutesAreUnique(const Line& line) const
+{
+    for (auto route = line.routes.begin(); route != line.routes.end(); route++) {
+        if (std::find_if(line.routes.begin(), route, [&route](const auto& other) {
+                return other.id == route->id;
+            }) != route) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TransportNetwork::StationsAreAdjacend(StationIndex station_a,
+                                           StationIndex station_b) const
 {
     return StationConnectsAnother(station_a, station_b) ||
            StationConnectsAnother(station_b, station_a);
 }
 
-bool TransportNetwork::StationConnectsAnother(const Id& station_a,
-                                              const Id& station_b) const
+bool TransportNetwork::StationConnectsAnother(StationIndex station_a,
+                                              StationIndex station_b) const
 {
-    const auto& station_a_internal = stations_.at(station_a);
-    if (stations_.at(station_a)->FindEdgesToNextStation(station_b).empty()) {
-        return false;
+    return !FindEdgesToNextStation(station_a, station_b).empty();
+}
+
+const TransportNetwork::RouteInternal* TransportNetwork::FindRoute(const Id& line,
+                                                                   const Id& route) const
+{
+    const auto& layout{*layout_};
+    const auto line_index{layout.line_ids.Find(line)};
+    if (line_index == IdInterner::invalid_handle) {
+        return nullptr;
     }
-    return true;
+    for (const auto route_index : layout.lines[line_index].routes) {
+        if (layout.routes[route_index].id == route) {
+            return &layout.routes[route_index];
+        }
+    }
+    return nullptr;
 }
 
-TransportNetwork::RouteInternal::RouteInternal(const Id& id,
-                                               const std::shared_ptr<LineInternal>& line)
-    : id{id},
-      line{line}
+void TransportNetwork::SetEdgeTravelTime(EdgeIndex edge, unsigned int travel_time)
 {
+    // Shift the cumulative travel times of all the stops after the edge.
+    const auto& graph_edge{layout_->edges[edge]};
+    const auto& route{layout_->routes[graph_edge.route]};
+    const auto last_stop{route.first_stop + route.stations.size()};
+    const auto old_travel_time{edge_travel_times_[edge]};
+    for (auto next = graph_edge.stop + 1; next < last_stop; next++) {
+        auto& stop_travel_time{stop_travel_times_.Mutable(next)};
+        stop_travel_time = stop_travel_time - old_travel_time + travel_time;
+    }
+    edge_travel_times_.Mutable(edge) = travel_time;
 }
-TransportNetwork::LineInternal::LineInternal(const Id& id, const std::string& name)
-    : id{id},
-      name{name}
+
+TransportNetwork::EdgesToNextStation TransportNetwork::FindEdgesToNextStation(
+    StationIndex station, StationIndex next_station) const
 {
+    const auto& layout{*layout_};
+    return {layout.edges, layout.edge_offsets[station], layout.edge_offsets[station + 1],
+            next_station};
+}
+
+TransportNetwork::EdgesToNextStation::EdgesToNextStation(
+    const std::vector<GraphEdge>& edges,
+    EdgeIndex first,
+    EdgeIndex last,
+    StationIndex next_station)
+    : edges_{edges},
+      first_{first},
+      last_{last},
+      next_station_{next_station}
+{
+}
+
+TransportNetwork::EdgesToNextStation::Iterator
+TransportNetwork::EdgesToNextStation::begin() const
+{
+    return {*this, first_};
+}
+
+TransportNetwork::EdgesToNextStation::Iterator
+TransportNetwork::EdgesToNextStation::end() const
+{
+    return {*this, last_};
+}
+
+bool TransportNetwork::EdgesToNextStation::empty() const
+{
+    return begin() == end();
+}
+
+TransportNetwork::EdgeIndex TransportNetwork::EdgesToNextStation::front() const
+{
+    return *begin();
+}
+
+TransportNetwork::EdgesToNextStation::Iterator::Iterator(const EdgesToNextStation& range,
+                                                         EdgeIndex edge)
+    : range_{&range},
+      edge_{edge}
+{
+    SkipOtherStations();
+}
+
+TransportNetwork::EdgeIndex
+TransportNetwork::EdgesToNextStation::Iterator::operator*() const
+{
+    return edge_;
+}
+
+TransportNetwork::EdgesToNextStation::Iterator&
+TransportNetwork::EdgesToNextStation::Iterator::operator++()
+{
+    edge_++;
+    SkipOtherStations();
+    return *this;
+}
+
+bool TransportNetwork::EdgesToNextStation::Iterator::operator==(
+    const Iterator& other) const
+{
+    return edge_ == other.edge_;
+}
+
+bool TransportNetwork::EdgesToNextStation::Iterator::operator!=(
+    const Iterator& other) const
+{
+    return edge_ != other.edge_;
+}
+
+void TransportNetwork::EdgesToNextStation::Iterator::SkipOtherStations()
+{
+    while (edge_ < range_->last_ &&
+           range_->edges_[edge_].next_station != range_->next_station_) {
+        edge_++;
+    }
 }
@@ -0,0 +1,20 @@
+#include <memory>
+#include <network-monitor/versioned-transport-network.hpp>
+#include <utility>
+
+using namespace NetworkMonitor;
+
+VersionedTransportNetwork::VersionedTransportNetwork()
+    : current_{std::make_shared<Version>()}
+{
+}
+
+VersionedTransportNetwork::VersionedTransportNetwork(TransportNetwork network)
+    : current_{std::make_shared<Version>(Version{0, std::move(network)})}
+{
+}
+
+VersionedTransportNetwork::Snapshot VersionedTransportNetwork::GetSnapshot() const
+{
+    return std::atomic_load(&current_);
+}
@@ -18,7 +18,7 @@ class MockResolver {
     explicit MockResolver(ExecutionContext&& context);
 
     template <typename ResolveToken>
-    void async_resolve(std::string_view host,
+    auto async_resolve(std::string_view host,
                        std::string_view service,
                        ResolveToken&& token);
 
@@ -42,7 +42,7 @@ class MockTcpStream : public boost::beast::tcp_stream {
     static boost::system::error_code connect_error_code;
 
     template <typename ConnectToken>
-    void async_connect(endpoint_type type, ConnectToken&& token);
+    auto async_connect(endpoint_type type, ConnectToken&& token);
 };
 
 template <typename TcpStream>
@@ -53,7 +53,7 @@ class MockSslStream : public boost::beast::ssl_stream<TcpStream> {
     static boost::system::error_code handshake_error_code;
 
     template <typename HandshakeToken>
-    void async_handshake(boost::asio::ssl::stream_base::handshake_type type,
+    auto async_handshake(boost::asio::ssl::stream_base::handshake_type type,
                          HandshakeToken token);
 };
 
@@ -70,18 +70,18 @@ class MockWebSocketStream : public boost::beast::websocket::stream<TlsStream> {
     static std::string read_buffer;
 
     template <typename HandshakeToken>
-    void async_handshake(std::string_view host,
+    auto async_handshake(std::string_view host,
                          std::string_view target,
                          HandshakeToken token);
 
     template <typename ConstBufferSequence, typename WriteHandler>
-    void async_write(const ConstBufferSequence& buffers, WriteHandler&& handler);
+    auto async_write(const ConstBufferSequence& buffers, WriteHandler&& handler);
 
     template <typename DynamicBuffer, typename ReadHandler>
-    void async_read(DynamicBuffer& buffer, ReadHandler&& handler);
+    auto async_read(DynamicBuffer& buffer, ReadHandler&& handler);
 
     template <typename CloseHandler>
-    void async_close(const boost::beast::websocket::close_reason& close_reason,
+    auto async_close(const boost::beast::websocket::close_reason& close_reason,
                      CloseHandler&& handler);
 
    private:
@@ -97,7 +97,7 @@ MockResolver::MockResolver(ExecutionContext&& context) : context_{context}
 }
 
 template <typename ResolveToken>
-void MockResolver::async_resolve(std::string_view host,
+auto MockResolver::async_resolve(std::string_view host,
                                  std::string_view service,
                                  ResolveToken&& token)
 {
@@ -128,7 +128,7 @@ void MockResolver::async_resolve(std::string_view host,
 }
 
 template <typename ConnectToken>
-void MockTcpStream::async_connect(endpoint_type type, ConnectToken&& token)
+auto MockTcpStream::async_connect(endpoint_type type, ConnectToken&& token)
 {
     return boost::asio::async_initiate<ConnectToken, void(boost::system::error_code)>(
         [](auto&& handler, auto stream) {
@@ -141,7 +141,7 @@ void MockTcpStream::async_connect(endpoint_type type, ConnectToken&& token)
 
 template <typename TcpStream>
 template <typename HandshakeToken>
-void MockSslStream<TcpStream>::async_handshake(
+auto MockSslStream<TcpStream>::async_handshake(
     boost::asio::ssl::stream_base::handshake_type type, HandshakeToken token)
 {
     return boost::asio::async_initiate<HandshakeToken, void(boost::system::error_code)>(
@@ -156,7 +156,7 @@ void MockSslStream<TcpStream>::async_handshake(
 
 template <typename TlsStream>
 template <typename HandshakeToken>
-void MockWebSocketStream<TlsStream>::async_handshake(std::string_view host,
+auto MockWebSocketStream<TlsStream>::async_handshake(std::string_view host,
                                                      std::string_view target,
                                                      HandshakeToken token)
 {
@@ -175,7 +175,7 @@ void MockWebSocketStream<TlsStream>::async_handshake(std::string_view host,
 
 template <typename TlsStream>
 template <typename ConstBufferSequence, typename WriteHandler>
-void MockWebSocketStream<TlsStream>::async_write(const ConstBufferSequence& buffers,
+auto MockWebSocketStream<TlsStream>::async_write(const ConstBufferSequence& buffers,
                                                  WriteHandler&& handler)
 {
     return boost::asio::async_initiate<WriteHandler,
@@ -203,15 +203,16 @@ void MockWebSocketStream<TlsStream>::async_write(const ConstBufferSequence& buff
 
 template <typename TlsStream>
 template <typename DynamicBuffer, typename ReadHandler>
-void MockWebSocketStream<TlsStream>::async_read(DynamicBuffer& buffer,
+auto MockWebSocketStream<TlsStream>::async_read(DynamicBuffer& buffer,
                                                 ReadHandler&& handler)
 {
     return boost::asio::async_initiate<ReadHandler,
                                        void(boost::system::error_code, std::size_t)>(
-        [this](auto&& handler, auto& buffer) {
-            recursive_read_internal(handler, buffer);
+        // The buffer is passed by pointer, as initiation arguments may be copied.
+        [this](auto&& handler, auto* buffer) {
+            recursive_read_internal(std::move(handler), *buffer);
         },
-        handler, buffer);
+        handler, &buffer);
 }
 
 template <typename TlsStream>
@@ -236,8 +237,8 @@ void MockWebSocketStream<TlsStream>::recursive_read_internal(ReadHandler&& handl
 
     if (bytes_read == 0 && !error_code) {
         boost::asio::post(this->get_executor(),
-                          [this, handler = std::move(handler), &buffer]() {
-                              recursive_read_internal(handler, buffer);
+                          [this, handler = std::move(handler), &buffer]() mutable {
+                              recursive_read_internal(std::move(handler), buffer);
                           });
     } else {
         boost::asio::post(
@@ -248,7 +249,7 @@ void MockWebSocketStream<TlsStream>::recursive_read_internal(ReadHandler&& handl
 
 template <typename TlsStream>
 template <typename CloseHandler>
-void MockWebSocketStream<TlsStream>::async_close(
+auto MockWebSocketStream<TlsStream>::async_close(
     const boost::beast::websocket::close_reason& close_reason, CloseHandler&& handler)
 {
     return boost::asio::async_initiate<CloseHandler, void(boost::system::error_code)>(
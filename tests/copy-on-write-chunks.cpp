@@ -0,0 +1,103 @@
+#include <boost/test/unit_test.hpp>
+#include <network-monitor/copy-on-write-chunks.hpp>
+#include <utility>
+
+using NetworkMonitor::CopyOnWriteChunks;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_CopyOnWriteChunks);
+
+namespace {
+
+constexpr auto chunk_size{CopyOnWriteChunks<int>::chunk_size};
+
+CopyOnWriteChunks<int> MakeArray(std::size_t size)
+{
+    CopyOnWriteChunks<int> array{};
+    for (std::size_t index = 0; index < size; index++) {
+        array.EmplaceBack(static_cast<int>(index));
+    }
+    return array;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(append_across_chunks)
+{
+    auto array{MakeArray(2 * chunk_size + 1)};
+    array.Append(2, -1);
+
+    BOOST_REQUIRE_EQUAL(array.Size(), 2 * chunk_size + 3);
+    for (std::size_t index = 0; index <= 2 * chunk_size; index++) {
+        BOOST_CHECK_EQUAL(array[index], static_cast<int>(index));
+    }
+    BOOST_CHECK_EQUAL(array[2 * chunk_size + 1], -1);
+    BOOST_CHECK_EQUAL(array[2 * chunk_size + 2], -1);
+}
+
+BOOST_AUTO_TEST_CASE(copy_shares_chunks)
+{
+    const auto original{MakeArray(2 * chunk_size)};
+    auto copy{original};
+
+    BOOST_CHECK(&copy[0] == &original[0]);
+    BOOST_CHECK(&copy[chunk_size] == &original[chunk_size]);
+
+    // Only the changed chunk is copied.
+    copy.Mutable(chunk_size + 1) = -1;
+    BOOST_CHECK_EQUAL(copy[chunk_size + 1], -1);
+    BOOST_CHECK_EQUAL(original[chunk_size + 1], static_cast<int>(chunk_size + 1));
+    BOOST_CHECK(&copy[0] == &original[0]);
+    BOOST_CHECK(&copy[chunk_size] != &original[chunk_size]);
+    BOOST_CHECK_EQUAL(copy[chunk_size], static_cast<int>(chunk_size));
+
+    // A chunk that is not shared any more is changed in place.
+    const auto* value{&copy[chunk_size]};
+    copy.Mutable(chunk_size) = -2;
+    BOOST_CHECK(&copy[chunk_size] == value);
+}
+
+BOOST_AUTO_TEST_CASE(append_to_shared_chunk)
+{
+    const auto original{MakeArray(1)};
+    auto copy{original};
+    copy.EmplaceBack(42);
+
+    BOOST_CHECK_EQUAL(original.Size(), 1);
+    BOOST_CHECK_EQUAL(copy.Size(), 2);
+    BOOST_CHECK_EQUAL(copy[0], 0);
+    BOOST_CHECK_EQUAL(copy[1], 42);
+    BOOST_CHECK(&copy[0] != &original[0]);
+}
+
+BOOST_AUTO_TEST_CASE(unshare)
+{
+    const auto original{MakeArray(chunk_size + 1)};
+    auto copy{original};
+    copy.Unshare();
+
+    BOOST_CHECK(&copy[0] != &original[0]);
+    BOOST_CHECK(&copy[chunk_size] != &original[chunk_size]);
+    BOOST_CHECK_EQUAL(copy[chunk_size], static_cast<int>(chunk_size));
+}
+
+BOOST_AUTO_TEST_CASE(move)
+{
+    auto moved{MakeArray(3)};
+    auto array{std::move(moved)};
+    BOOST_CHECK_EQUAL(array.Size(), 3);
+    BOOST_CHECK_EQUAL(moved.Size(), 0);
+
+    // The moved array can still be used.
+    moved.EmplaceBack(1);
+    BOOST_CHECK_EQUAL(moved[0], 1);
+
+    array = std::move(moved);
+    BOOST_CHECK_EQUAL(array.Size(), 1);
+    BOOST_CHECK_EQUAL(moved.Size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // class_CopyOnWriteChunks
+
+BOOST_AUTO_TEST_SUITE_END();  // network_monitor
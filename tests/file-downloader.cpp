@@ -2,12 +2,32 @@
 #include <boost/test/unit_test.hpp>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <network-monitor/file-downloader.hpp>
 #include <string>
+#include <vector>
 
 using NetworkMonitor::DownloadFile;
+using NetworkMonitor::DownloadRequest;
+using NetworkMonitor::DownloadResult;
+using NetworkMonitor::FileDownloader;
 using NetworkMonitor::ParseJsonFile;
 
+namespace {
+
+std::string ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+std::string ToFileUrl(const std::filesystem::path& path)
+{
+    return "file://" + std::filesystem::absolute(path).string();
+}
+
+}  // namespace
+
 BOOST_AUTO_TEST_SUITE(network_monitor);
 
 BOOST_AUTO_TEST_CASE(file_downloader)
@@ -66,4 +86,69 @@ BOOST_AUTO_TEST_CASE(parse_json_file)
     BOOST_CHECK(!parsed_json.at(travel_times_keyword).empty());
 }
 
+BOOST_AUTO_TEST_SUITE(class_FileDownloader);
+
+BOOST_AUTO_TEST_CASE(skips_unmodified_file)
+{
+    const auto destination{std::filesystem::temp_directory_path() /
+                           "network-layout-copy.json"};
+    std::filesystem::remove(destination);
+
+    FileDownloader downloader{};
+    const auto file_url{ToFileUrl(TESTS_NETWORK_LAYOUT_JSON)};
+
+    BOOST_CHECK_EQUAL(downloader.Download(file_url, destination),
+                      DownloadResult::Downloaded);
+    BOOST_CHECK(ReadFile(destination) == ReadFile(TESTS_NETWORK_LAYOUT_JSON));
+
+    // The second download is conditional and leaves the local copy as it is.
+    BOOST_CHECK_EQUAL(downloader.Download(file_url, destination),
+                      DownloadResult::NotModified);
+    BOOST_CHECK(ReadFile(destination) == ReadFile(TESTS_NETWORK_LAYOUT_JSON));
+
+    // Without a local copy, the file is downloaded again.
+    std::filesystem::remove(destination);
+    BOOST_CHECK_EQUAL(downloader.Download(file_url, destination),
+                      DownloadResult::Downloaded);
+    BOOST_CHECK(std::filesystem::exists(destination));
+
+    // Clean up.
+    std::filesystem::remove(destination);
+}
+
+BOOST_AUTO_TEST_CASE(downloads_files_in_parallel)
+{
+    const auto directory{std::filesystem::temp_directory_path()};
+    const auto missing{directory / "network-monitor-missing.json"};
+    std::filesystem::remove(missing);
+    const std::vector<DownloadRequest> requests{
+        {ToFileUrl(TESTS_NETWORK_LAYOUT_JSON), directory / "network-layout-1.json"},
+        {ToFileUrl(missing), directory / "network-layout-2.json"},
+        {ToFileUrl(TESTS_CACERT_PEM), directory / "cacert-copy.pem"},
+    };
+    for (const auto& request : requests) {
+        std::filesystem::remove(request.destination);
+    }
+
+    FileDownloader downloader{};
+    const auto results{downloader.DownloadAll(requests)};
+
+    BOOST_REQUIRE_EQUAL(results.size(), requests.size());
+    BOOST_CHECK_EQUAL(results[0], DownloadResult::Downloaded);
+    BOOST_CHECK(ReadFile(requests[0].destination) ==
+                ReadFile(TESTS_NETWORK_LAYOUT_JSON));
+    BOOST_CHECK_EQUAL(results[1], DownloadResult::Failed);
+    BOOST_CHECK(!std::filesystem::exists(requests[1].destination));
+    BOOST_CHECK(!std::filesystem::exists(directory / "network-layout-2.json.part"));
+    BOOST_CHECK_EQUAL(results[2], DownloadResult::Downloaded);
+    BOOST_CHECK(ReadFile(requests[2].destination) == ReadFile(TESTS_CACERT_PEM));
+
+    // Clean up.
+    for (const auto& request : requests) {
+        std::filesystem::remove(request.destination);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // class_FileDownloader
+
 BOOST_AUTO_TEST_SUITE_END();
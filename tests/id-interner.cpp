@@ -0,0 +1,74 @@
+#include <boost/test/unit_test.hpp>
+#include <network-monitor/id-interner.hpp>
+#include <string>
+#include <string_view>
+
+using NetworkMonitor::IdInterner;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_IdInterner);
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+    IdInterner interner{};
+
+    BOOST_CHECK_EQUAL(interner.Size(), 0);
+    BOOST_CHECK_EQUAL(interner.Find("station_000"), IdInterner::invalid_handle);
+    BOOST_CHECK(!interner.Contains("station_000"));
+}
+
+BOOST_AUTO_TEST_CASE(dense_handles)
+{
+    IdInterner interner{};
+
+    BOOST_CHECK_EQUAL(interner.Intern("station_000"), 0);
+    BOOST_CHECK_EQUAL(interner.Intern("station_001"), 1);
+    BOOST_CHECK_EQUAL(interner.Intern("station_002"), 2);
+    BOOST_CHECK_EQUAL(interner.Size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(intern_twice)
+{
+    IdInterner interner{};
+
+    const auto handle{interner.Intern("station_000")};
+    BOOST_CHECK_EQUAL(interner.Intern("station_000"), handle);
+    BOOST_CHECK_EQUAL(interner.Size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(find_string_view)
+{
+    IdInterner interner{};
+    const auto handle{interner.Intern("station_000")};
+
+    // Look up a view into a larger buffer, with no std::string involved.
+    const std::string_view buffer{"station_000,station_001"};
+    BOOST_CHECK_EQUAL(interner.Find(buffer.substr(0, 11)), handle);
+    BOOST_CHECK_EQUAL(interner.Find(buffer.substr(12)), IdInterner::invalid_handle);
+    BOOST_CHECK_EQUAL(interner.GetId(handle), "station_000");
+}
+
+BOOST_AUTO_TEST_CASE(many_ids)
+{
+    IdInterner interner{};
+    const std::size_t ids_count{10000};
+
+    for (std::size_t index = 0; index < ids_count; index++) {
+        BOOST_REQUIRE_EQUAL(interner.Intern("id_" + std::to_string(index)), index);
+    }
+
+    // Handles and IDs survive the table growth.
+    BOOST_CHECK_EQUAL(interner.Size(), ids_count);
+    for (std::size_t index = 0; index < ids_count; index++) {
+        const auto id{"id_" + std::to_string(index)};
+        BOOST_REQUIRE_EQUAL(interner.Find(id), index);
+        BOOST_REQUIRE_EQUAL(interner.GetId(index), id);
+    }
+    BOOST_CHECK_EQUAL(interner.Find("id_" + std::to_string(ids_count)),
+                      IdInterner::invalid_handle);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // class_IdInterner
+
+BOOST_AUTO_TEST_SUITE_END();  // network_monitor
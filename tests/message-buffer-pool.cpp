@@ -0,0 +1,107 @@
+#include <boost/test/unit_test.hpp>
+#include <network-monitor/message-buffer-pool.hpp>
+#include <string>
+#include <utility>
+
+using NetworkMonitor::MessageBufferPool;
+
+namespace {
+
+// Large enough not to fit in the small string buffer.
+const std::string long_message(256, 'm');
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_MessageBufferPool);
+
+BOOST_AUTO_TEST_CASE(acquire)
+{
+    MessageBufferPool pool{};
+
+    auto buffer{pool.Acquire(long_message)};
+
+    BOOST_CHECK_EQUAL(*buffer, long_message);
+    BOOST_CHECK_EQUAL(buffer->size(), long_message.size());
+
+    const auto stats{pool.GetStats()};
+    BOOST_CHECK_EQUAL(stats.hits, 0);
+    BOOST_CHECK_EQUAL(stats.misses, 1);
+    BOOST_CHECK_EQUAL(stats.free_buffers, 0);
+}
+
+BOOST_AUTO_TEST_CASE(recycle)
+{
+    MessageBufferPool pool{};
+
+    const char* storage{nullptr};
+    {
+        const auto buffer{pool.Acquire(long_message)};
+        storage = buffer->data();
+    }
+    BOOST_CHECK_EQUAL(pool.GetStats().free_buffers, 1);
+
+    // The released string is reused, allocation included.
+    const auto buffer{pool.Acquire("short")};
+    BOOST_CHECK_EQUAL(*buffer, "short");
+    BOOST_CHECK_EQUAL(buffer->data(), storage);
+
+    const auto stats{pool.GetStats()};
+    BOOST_CHECK_EQUAL(stats.hits, 1);
+    BOOST_CHECK_EQUAL(stats.misses, 1);
+    BOOST_CHECK_EQUAL(stats.free_buffers, 0);
+}
+
+BOOST_AUTO_TEST_CASE(move_assign)
+{
+    MessageBufferPool pool{};
+
+    auto buffer{pool.Acquire(long_message)};
+    auto other{pool.Acquire("other")};
+    buffer = std::move(other);
+
+    // The overwritten buffer goes back to the pool.
+    BOOST_CHECK_EQUAL(*buffer, "other");
+    BOOST_CHECK_EQUAL(pool.GetStats().free_buffers, 1);
+}
+
+BOOST_AUTO_TEST_CASE(release)
+{
+    MessageBufferPool pool{};
+
+    std::string message{};
+    {
+        auto buffer{pool.Acquire(long_message)};
+        message = buffer.Release();
+    }
+
+    BOOST_CHECK_EQUAL(message, long_message);
+    BOOST_CHECK_EQUAL(pool.GetStats().free_buffers, 0);
+}
+
+BOOST_AUTO_TEST_CASE(max_free_buffers)
+{
+    MessageBufferPool pool{1};
+    {
+        const auto first{pool.Acquire(long_message)};
+        const auto second{pool.Acquire(long_message)};
+    }
+
+    BOOST_CHECK_EQUAL(pool.GetStats().free_buffers, 1);
+}
+
+BOOST_AUTO_TEST_CASE(buffer_outlives_pool)
+{
+    MessageBufferPool::Buffer buffer{};
+    {
+        MessageBufferPool pool{};
+        buffer = pool.Acquire(long_message);
+    }
+
+    BOOST_CHECK_EQUAL(*buffer, long_message);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // class_MessageBufferPool
+
+BOOST_AUTO_TEST_SUITE_END();  // network_monitor
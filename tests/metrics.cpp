@@ -0,0 +1,207 @@
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstdint>
+#include <network-monitor/metrics.hpp>
+#include <network-monitor/stomp-frame-decoder.hpp>
+#include <network-monitor/transport-network.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+using NetworkMonitor::ErrorCounters;
+using NetworkMonitor::GetMetricsSnapshot;
+using NetworkMonitor::LatencyHistogram;
+using NetworkMonitor::MetricCounter;
+using NetworkMonitor::Metrics;
+using NetworkMonitor::metrics_enabled;
+using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::StompClientError;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompFrameDecoder;
+using NetworkMonitor::stomp_client_error_count;
+using NetworkMonitor::stomp_error_count;
+using NetworkMonitor::TransportNetwork;
+
+using namespace std::string_literals;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(metrics);
+
+BOOST_AUTO_TEST_SUITE(class_MetricCounter);
+
+BOOST_AUTO_TEST_CASE(add_from_several_threads,
+                     *boost::unit_test::enable_if<metrics_enabled>())
+{
+    constexpr std::size_t thread_count{4};
+    constexpr std::uint64_t adds_per_thread{10000};
+
+    MetricCounter counter{};
+    std::vector<std::thread> threads{};
+    for (std::size_t idx{0}; idx < thread_count; ++idx) {
+        threads.emplace_back([&counter]() {
+            for (std::uint64_t add{0}; add < adds_per_thread; ++add) {
+                counter.Add();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    counter.Add(5);
+
+    BOOST_CHECK_EQUAL(counter.Get(), thread_count * adds_per_thread + 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // class_MetricCounter
+
+BOOST_AUTO_TEST_SUITE(class_ErrorCounters);
+
+BOOST_AUTO_TEST_CASE(count_by_error,
+                     *boost::unit_test::enable_if<metrics_enabled>())
+{
+    ErrorCounters<StompClientError, stomp_client_error_count> counters{};
+    counters.Add(StompClientError::Ok);
+    counters.Add(StompClientError::WebSocketServerDisconnected);
+    counters.Add(StompClientError::WebSocketServerDisconnected);
+
+    BOOST_CHECK_EQUAL(counters.Get(StompClientError::Ok), 1);
+    BOOST_CHECK_EQUAL(counters.Get(StompClientError::WebSocketServerDisconnected), 2);
+    BOOST_CHECK_EQUAL(counters.Get(StompClientError::UndefinedError), 0);
+
+    const auto counts{counters.GetAll()};
+    BOOST_REQUIRE_EQUAL(counts.size(), stomp_client_error_count);
+    BOOST_CHECK_EQUAL(
+        counts[static_cast<std::size_t>(StompClientError::WebSocketServerDisconnected)],
+        2);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // class_ErrorCounters
+
+BOOST_AUTO_TEST_SUITE(class_LatencyHistogram);
+
+BOOST_AUTO_TEST_CASE(bucket_bounds)
+{
+    // Every value falls in a bucket whose upper bound is not below it, and at most
+    // 1/8 above it.
+    for (std::uint64_t value : {0ull, 1ull, 15ull, 16ull, 17ull, 1000ull, 123456789ull,
+                                (1ull << 40) + 3, ~0ull}) {
+        const auto index{LatencyHistogram::GetBucketIndex(value)};
+        BOOST_REQUIRE_LT(index, LatencyHistogram::bucket_count);
+        const auto upper_bound{LatencyHistogram::GetBucketUpperBound(index)};
+        BOOST_CHECK_GE(upper_bound, value);
+        BOOST_CHECK_LE(upper_bound - value, value / LatencyHistogram::sub_bucket_count);
+        if (index > 0) {
+            BOOST_CHECK_LT(LatencyHistogram::GetBucketUpperBound(index - 1), value);
+        }
+    }
+    BOOST_CHECK_EQUAL(LatencyHistogram::GetBucketIndex(~0ull),
+                      LatencyHistogram::bucket_count - 1);
+}
+
+BOOST_AUTO_TEST_CASE(percentiles,
+                     *boost::unit_test::enable_if<metrics_enabled>())
+{
+    LatencyHistogram histogram{};
+    BOOST_CHECK_EQUAL(histogram.GetSnapshot().GetPercentile(50), 0);
+
+    for (int idx{1}; idx <= 100; ++idx) {
+        histogram.Record(std::chrono::microseconds{idx});
+    }
+    histogram.Record(std::chrono::nanoseconds{-1});
+
+    const auto snapshot{histogram.GetSnapshot()};
+    BOOST_CHECK_EQUAL(snapshot.count, 101);
+    BOOST_CHECK_EQUAL(snapshot.sum_ns, 5050 * 1000);
+    BOOST_CHECK_EQUAL(snapshot.GetPercentile(0), 0);
+
+    // Within the resolution of the buckets.
+    const auto median{snapshot.GetPercentile(50)};
+    BOOST_CHECK_GE(median, 50000);
+    BOOST_CHECK_LE(median, 50000 + 50000 / LatencyHistogram::sub_bucket_count);
+    const auto maximum{snapshot.GetPercentile(100)};
+    BOOST_CHECK_GE(maximum, 100000);
+    BOOST_CHECK_LE(maximum, 100000 + 100000 / LatencyHistogram::sub_bucket_count);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // class_LatencyHistogram
+
+BOOST_AUTO_TEST_SUITE(prometheus_text);
+
+BOOST_AUTO_TEST_CASE(format,
+                     *boost::unit_test::enable_if<metrics_enabled>())
+{
+    Metrics metrics{};
+    metrics.websocket_messages_received.Add(3);
+    metrics.stomp_frame_results.Add(StompError::Ok);
+    metrics.stomp_client_errors.Add(StompClientError::CouldNotSendSubscribeFrame);
+    metrics.stomp_dispatch_delay.Record(std::chrono::milliseconds{2});
+
+    const auto text{NetworkMonitor::ToPrometheusText(GetMetricsSnapshot(metrics))};
+
+    const auto check_line{[&text](const std::string& line) {
+        BOOST_TEST_CONTEXT(line)
+        {
+            BOOST_CHECK_NE(text.find("\n" + line + "\n"), std::string::npos);
+        }
+    }};
+    check_line("# TYPE network_monitor_websocket_messages_received_total counter");
+    check_line("network_monitor_websocket_messages_received_total 3");
+    check_line("network_monitor_stomp_frames_parsed_total{result=\"Ok\"} 1");
+    check_line("network_monitor_stomp_client_errors_total"
+               "{error=\"CouldNotSendSubscribeFrame\"} 1");
+    check_line("# TYPE network_monitor_stomp_dispatch_delay_seconds histogram");
+    check_line("network_monitor_stomp_dispatch_delay_seconds_bucket"
+               "{le=\"0.001048576\"} 0");
+    check_line("network_monitor_stomp_dispatch_delay_seconds_bucket"
+               "{le=\"0.002097152\"} 1");
+    check_line("network_monitor_stomp_dispatch_delay_seconds_bucket{le=\"+Inf\"} 1");
+    check_line("network_monitor_stomp_dispatch_delay_seconds_sum 0.002");
+    check_line("network_monitor_stomp_dispatch_delay_seconds_count 1");
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // prometheus_text
+
+BOOST_AUTO_TEST_SUITE(instrumentation);
+
+BOOST_AUTO_TEST_CASE(stomp_frame_decoder,
+                     *boost::unit_test::enable_if<metrics_enabled>())
+{
+    const auto before{GetMetricsSnapshot()};
+
+    StompFrameDecoder decoder{};
+    decoder.Push("RECEIPT\nreceipt-id:42\n\n\0"s "NOT_A_COMMAND\n\n\0"s,
+                 [](StompError error, StompFrame&& frame) {});
+
+    const auto after{GetMetricsSnapshot()};
+    BOOST_CHECK_EQUAL(after.stomp_frame_parse_time.count,
+                      before.stomp_frame_parse_time.count + 2);
+    const auto ok{static_cast<std::size_t>(StompError::Ok)};
+    BOOST_CHECK_EQUAL(after.stomp_frame_results[ok], before.stomp_frame_results[ok] + 1);
+}
+
+BOOST_AUTO_TEST_CASE(passenger_events,
+                     *boost::unit_test::enable_if<metrics_enabled>())
+{
+    TransportNetwork network{};
+    BOOST_REQUIRE(network.AddStation({"station_000", "Station Name 0"}));
+
+    const auto before{GetMetricsSnapshot()};
+
+    using EventType = PassengerEvent::Type;
+    BOOST_CHECK(network.RecordPassengerEvent({"station_000", EventType::In}));
+    BOOST_CHECK(!network.RecordPassengerEvent({"station_042", EventType::In}));
+
+    const auto after{GetMetricsSnapshot()};
+    BOOST_CHECK_EQUAL(after.passenger_events_recorded,
+                      before.passenger_events_recorded + 1);
+    BOOST_CHECK_EQUAL(after.passenger_events_rejected,
+                      before.passenger_events_rejected + 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // instrumentation
+
+BOOST_AUTO_TEST_SUITE_END();  // metrics
+
+BOOST_AUTO_TEST_SUITE_END();  // network_monitor
@@ -1,7 +1,13 @@
 #include <boost/test/unit_test.hpp>
 #include <network-monitor/stomp-client.hpp>
 #include <network-monitor/stomp-frame-builder.hpp>
+#include <network-monitor/stomp-frame-decoder.hpp>
+#include <chrono>
 #include <queue>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 #include "websocket-client-mock.hpp"
 
@@ -40,9 +46,13 @@ StompClientTestFixture::StompClientTestFixture()
     WebSocketClientMock::connect_error_code = {};
     WebSocketClientMock::send_error_code = {};
     WebSocketClientMock::close_error_code = {};
+    WebSocketClientMock::message_queue = {};
+    WebSocketClientMock::trigger_disconnection = false;
     WebSocketClientMockForStomp::username = "correct_username";
     WebSocketClientMockForStomp::password = "correct_password";
     WebSocketClientMockForStomp::endpoint = "correct_endpoint";
+    WebSocketClientMockForStomp::heart_beat = {};
+    WebSocketClientMockForStomp::connect_heart_beat = {};
 
     stomp_username = WebSocketClientMockForStomp::username;
     stomp_password = WebSocketClientMockForStomp::password;
@@ -199,6 +209,654 @@ BOOST_AUTO_TEST_CASE(ReturnsSubscriptionIdAtSuccess, *timeout(1))
     BOOST_CHECK(on_subscribe_called);
 }
 
+BOOST_AUTO_TEST_CASE(SharesSubscriptionOfDestination, *timeout(1))
+{
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context};
+
+    int subscribe_frames{0};
+    std::vector<std::string> subscribed_ids{};
+    std::string received_message{};
+    std::string received_frame_body{};
+    std::vector<const char*> viewed_bodies{};
+    NetworkMonitor::StompFramePool::Handle received_frame{};
+
+    auto respond_to_send{WebSocketClientMock::respond_to_send};
+    WebSocketClientMock::respond_to_send = [&](const std::string& message) {
+        StompError error{};
+        const StompFrame frame{error, message};
+        BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+        respond_to_send(message);
+
+        if (frame.GetCommand() == StompCommand::Subscribe) {
+            ++subscribe_frames;
+            WebSocketClientMock::message_queue.push(
+                NetworkMonitor::stomp_frame::MakeMessageFrame(
+                    stomp_endpoint, "1",
+                    std::string{frame.GetHeaderValue(StompHeader::Id)}, "", "hello", "",
+                    "")
+                    .ToString());
+        }
+    };
+
+    auto close_when_received{[&]() {
+        if (!received_message.empty() && !received_frame_body.empty()) {
+            stomp_client.Close();
+        }
+    }};
+    auto on_subscribe_callback{[&](auto result, auto&& subscription_id) {
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        subscribed_ids.push_back(subscription_id);
+    }};
+    auto on_message_callback{[&](auto result, auto&& message) {
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        received_message = message;
+        close_when_received();
+    }};
+    auto on_frame_callback{[&](auto result, auto frame) {
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        received_frame_body = frame->GetBody();
+        received_frame = frame;
+        close_when_received();
+    }};
+    auto on_message_view_callback{[&](auto result, std::string_view body) {
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        BOOST_CHECK_EQUAL(body, "hello");
+        viewed_bodies.push_back(body.data());
+    }};
+    auto on_connect_callback{[&](auto result) {
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        for (int view_listener{0}; view_listener < 2; ++view_listener) {
+            stomp_client.SubscribeWithMessageViews(stomp_endpoint, on_subscribe_callback,
+                                                   on_message_view_callback);
+        }
+        auto message_subscription_id{stomp_client.Subscribe(
+            stomp_endpoint, on_subscribe_callback, on_message_callback)};
+        auto frame_subscription_id{stomp_client.SubscribeToFrames(
+            stomp_endpoint, on_subscribe_callback, on_frame_callback)};
+        BOOST_CHECK_EQUAL(message_subscription_id, frame_subscription_id);
+    }};
+
+    stomp_client.Connect(stomp_username, stomp_password, on_connect_callback);
+    io_context.run();
+
+    BOOST_CHECK_EQUAL(subscribe_frames, 1);
+    BOOST_REQUIRE_EQUAL(subscribed_ids.size(), 4);
+    for (const auto& subscribed_id : subscribed_ids) {
+        BOOST_CHECK_EQUAL(subscribed_id, subscribed_ids[0]);
+    }
+    BOOST_CHECK_EQUAL(received_message, "hello");
+    BOOST_CHECK_EQUAL(received_frame_body, "hello");
+    // All the listeners shared a single copy of the message, and the view listeners
+    // read the body in place.
+    BOOST_REQUIRE_EQUAL(viewed_bodies.size(), 2);
+    BOOST_REQUIRE(received_frame);
+    BOOST_CHECK(viewed_bodies[0] == received_frame->GetBody().data());
+    BOOST_CHECK(viewed_bodies[1] == received_frame->GetBody().data());
+    BOOST_CHECK_EQUAL(stomp_client.GetFramePoolStats().misses, 1);
+}
+
+BOOST_AUTO_TEST_CASE(SendsCumulativeAcksInBatches, *timeout(1))
+{
+    NetworkMonitor::StompClientOptions options{};
+    options.ack.batch_size = 3;
+    options.ack.batch_delay = std::chrono::milliseconds{10};
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context, options};
+
+    std::vector<std::string> acks{};
+    int received_messages{0};
+
+    auto respond_to_send{WebSocketClientMock::respond_to_send};
+    WebSocketClientMock::respond_to_send = [&](const std::string& message) {
+        respond_to_send(message);
+        NetworkMonitor::StompFrameDecoder decoder{};
+        decoder.Push(message, [&](auto error, auto&& frame) {
+            BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+            if (frame.GetCommand() == StompCommand::Subscribe) {
+                BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::Ack), "client");
+                for (int id{1}; id <= 7; ++id) {
+                    WebSocketClientMock::message_queue.push(
+                        NetworkMonitor::stomp_frame::MakeMessageFrame(
+                            stomp_endpoint, std::to_string(id),
+                            std::string{frame.GetHeaderValue(StompHeader::Id)},
+                            "a" + std::to_string(id), "hello", "", "")
+                            .ToString());
+                }
+            }
+            if (frame.GetCommand() == StompCommand::Ack) {
+                acks.emplace_back(frame.GetHeaderValue(StompHeader::Id));
+                // The last message is only acknowledged after the batch delay.
+                if (acks.back() == "a7") {
+                    stomp_client.Close();
+                }
+            }
+        });
+    };
+
+    auto on_message_callback{[&](auto, auto&&) { ++received_messages; }};
+    auto on_connect_callback{[&](auto result) {
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        stomp_client.Subscribe(stomp_endpoint, nullptr, on_message_callback,
+                               NetworkMonitor::StompAckMode::Client);
+    }};
+
+    stomp_client.Connect(stomp_username, stomp_password, on_connect_callback);
+    io_context.run();
+
+    BOOST_CHECK_EQUAL(received_messages, 7);
+    const std::vector<std::string> expected_acks{"a3", "a6", "a7"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(acks.begin(), acks.end(), expected_acks.begin(),
+                                  expected_acks.end());
+}
+
+BOOST_AUTO_TEST_CASE(PacksIndividualAcksInOneMessage, *timeout(1))
+{
+    NetworkMonitor::StompClientOptions options{};
+    options.ack.batch_size = 3;
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context, options};
+
+    std::vector<std::vector<std::string>> ack_messages{};
+
+    auto respond_to_send{WebSocketClientMock::respond_to_send};
+    WebSocketClientMock::respond_to_send = [&](const std::string& message) {
+        respond_to_send(message);
+        std::vector<std::string> acks{};
+        NetworkMonitor::StompFrameDecoder decoder{};
+        decoder.Push(message, [&](auto error, auto&& frame) {
+            BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+            if (frame.GetCommand() == StompCommand::Subscribe) {
+                BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::Ack),
+                                  "client-individual");
+                for (int id{1}; id <= 3; ++id) {
+                    WebSocketClientMock::message_queue.push(
+                        NetworkMonitor::stomp_frame::MakeMessageFrame(
+                            stomp_endpoint, std::to_string(id),
+                            std::string{frame.GetHeaderValue(StompHeader::Id)},
+                            "a" + std::to_string(id), "hello", "", "")
+                            .ToString());
+                }
+            }
+            if (frame.GetCommand() == StompCommand::Ack) {
+                acks.emplace_back(frame.GetHeaderValue(StompHeader::Id));
+            }
+        });
+        if (!acks.empty()) {
+            ack_messages.push_back(std::move(acks));
+            stomp_client.Close();
+        }
+    };
+
+    auto on_frame_callback{[](auto, auto) {}};
+    auto on_connect_callback{[&](auto result) {
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        stomp_client.SubscribeToFrames(stomp_endpoint, nullptr, on_frame_callback,
+                                       NetworkMonitor::StompAckMode::ClientIndividual);
+    }};
+
+    stomp_client.Connect(stomp_username, stomp_password, on_connect_callback);
+    io_context.run();
+
+    BOOST_REQUIRE_EQUAL(ack_messages.size(), 1);
+    const std::vector<std::string> expected_acks{"a1", "a2", "a3"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(ack_messages[0].begin(), ack_messages[0].end(),
+                                  expected_acks.begin(), expected_acks.end());
+}
+
+BOOST_AUTO_TEST_CASE(DropsAcksOfPreviousConnection, *timeout(1))
+{
+    // The handlers only run when the test polls them.
+    boost::asio::io_context handlers{};
+    NetworkMonitor::StompClientOptions options{};
+    options.ack.batch_size = 1;
+    options.reconnect.enabled = true;
+    options.reconnect.initial_delay = std::chrono::milliseconds{1};
+    options.callback_executor = handlers.get_executor();
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context, options};
+
+    int subscribe_frames{0};
+    std::vector<std::string> acks{};
+    std::vector<std::string> received_messages{};
+
+    auto respond_to_send{WebSocketClientMock::respond_to_send};
+    WebSocketClientMock::respond_to_send = [&](const std::string& message) {
+        respond_to_send(message);
+        NetworkMonitor::StompFrameDecoder decoder{};
+        decoder.Push(message, [&](auto error, auto&& frame) {
+            BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+            if (frame.GetCommand() == StompCommand::Subscribe) {
+                // One message on each connection.
+                const auto id{std::to_string(++subscribe_frames)};
+                WebSocketClientMock::message_queue.push(
+                    NetworkMonitor::stomp_frame::MakeMessageFrame(
+                        stomp_endpoint, id,
+                        std::string{frame.GetHeaderValue(StompHeader::Id)}, "a" + id,
+                        "hello", "", "")
+                        .ToString());
+            }
+            if (frame.GetCommand() == StompCommand::Ack) {
+                acks.emplace_back(frame.GetHeaderValue(StompHeader::Id));
+                stomp_client.Close();
+            }
+        });
+    };
+
+    auto on_message_callback{[&](auto, auto&& message) {
+        received_messages.push_back(message);
+    }};
+    auto on_connect_callback{[&](auto result) {
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        stomp_client.Subscribe(stomp_endpoint, nullptr, on_message_callback,
+                               NetworkMonitor::StompAckMode::ClientIndividual);
+    }};
+    stomp_client.Connect(stomp_username, stomp_password, on_connect_callback);
+
+    const auto poll_handlers{[&handlers]() {
+        handlers.restart();
+        handlers.poll();
+    }};
+
+    // The first message waits for its handler while the connection drops.
+    while (stomp_client.GetFramePoolStats().misses == 0) {
+        poll_handlers();
+        BOOST_REQUIRE(io_context.run_one() > 0);
+    }
+    WebSocketClientMock::trigger_disconnection = true;
+    while (subscribe_frames < 2) {
+        BOOST_REQUIRE(io_context.run_one() > 0);
+    }
+    while (!io_context.stopped()) {
+        poll_handlers();
+        io_context.run_one();
+    }
+    poll_handlers();
+
+    const std::vector<std::string> expected_messages{"hello", "hello"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(received_messages.begin(), received_messages.end(),
+                                  expected_messages.begin(), expected_messages.end());
+    const std::vector<std::string> expected_acks{"a2"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(acks.begin(), acks.end(), expected_acks.begin(),
+                                  expected_acks.end());
+    BOOST_CHECK_EQUAL(stomp_client.GetReconnectionsCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(CallsHandlersOnCallbackExecutor, *timeout(1))
+{
+    boost::asio::thread_pool workers{1};
+    NetworkMonitor::StompClientOptions options{};
+    options.callback_executor = workers.get_executor();
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context, options};
+
+    const auto io_thread{std::this_thread::get_id()};
+    bool on_subscribe_called{false};
+    bool on_close_called{false};
+
+    auto on_close_callback{[&](auto result) {
+        BOOST_CHECK(std::this_thread::get_id() != io_thread);
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        on_close_called = true;
+    }};
+    auto on_subscribe_callback{[&](auto result, auto&&) {
+        BOOST_CHECK(std::this_thread::get_id() != io_thread);
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        on_subscribe_called = true;
+        stomp_client.Close(on_close_callback);
+    }};
+    auto on_connect_callback{[&](auto result) {
+        BOOST_CHECK(std::this_thread::get_id() != io_thread);
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        stomp_client.Subscribe(stomp_endpoint, on_subscribe_callback,
+                               [](auto, auto&&) {});
+    }};
+
+    stomp_client.Connect(stomp_username, stomp_password, on_connect_callback);
+    io_context.run();
+    workers.join();
+
+    BOOST_CHECK(on_subscribe_called);
+    BOOST_CHECK(on_close_called);
+}
+
+#ifdef NETWORK_MONITOR_COROUTINES
+BOOST_AUTO_TEST_CASE(AwaitsConnectionAndFrames, *timeout(1))
+{
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context};
+
+    auto respond_to_send{WebSocketClientMock::respond_to_send};
+    WebSocketClientMock::respond_to_send = [&](const std::string& message) {
+        StompError error{};
+        const StompFrame frame{error, message};
+        respond_to_send(message);
+        if (error == StompError::Ok && frame.GetCommand() == StompCommand::Subscribe) {
+            for (const auto* body : {"one", "two"}) {
+                WebSocketClientMock::message_queue.push(
+                    NetworkMonitor::stomp_frame::MakeMessageFrame(
+                        stomp_endpoint, body,
+                        std::string{frame.GetHeaderValue(StompHeader::Id)}, "", body, "",
+                        "")
+                        .ToString());
+            }
+        }
+    };
+
+    std::vector<std::string> bodies{};
+    bool stream_ended{false};
+    auto session{[&]() -> boost::asio::awaitable<void> {
+        const auto connect_result{
+            co_await stomp_client.AsyncConnect(stomp_username, stomp_password)};
+        BOOST_REQUIRE_EQUAL(connect_result, StompClientError::Ok);
+
+        auto [subscribe_result, frames]{
+            co_await stomp_client.AsyncSubscribe(stomp_endpoint)};
+        BOOST_REQUIRE_EQUAL(subscribe_result, StompClientError::Ok);
+        BOOST_CHECK(!frames.GetSubscriptionId().empty());
+
+        for (int count{0}; count < 2; ++count) {
+            const auto frame{co_await frames.Next()};
+            BOOST_REQUIRE(frame);
+            bodies.emplace_back(frame->GetBody());
+        }
+
+        stomp_client.Close();
+        stream_ended = !(co_await frames.Next());
+    }};
+    boost::asio::co_spawn(io_context, session, boost::asio::detached);
+    io_context.run();
+
+    const std::vector<std::string> expected_bodies{"one", "two"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(bodies.begin(), bodies.end(), expected_bodies.begin(),
+                                  expected_bodies.end());
+    BOOST_CHECK(stream_ended);
+}
+
+BOOST_AUTO_TEST_CASE(AcknowledgesPulledFrames, *timeout(1))
+{
+    NetworkMonitor::StompClientOptions options{};
+    options.ack.batch_size = 1;
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context, options};
+
+    std::string subscription_id{};
+    std::vector<std::string> acks{};
+    const auto push_message{[this, &subscription_id](const std::string& id) {
+        WebSocketClientMock::message_queue.push(
+            NetworkMonitor::stomp_frame::MakeMessageFrame(stomp_endpoint, id,
+                                                          subscription_id, "a" + id,
+                                                          "hello", "", "")
+                .ToString());
+    }};
+
+    auto respond_to_send{WebSocketClientMock::respond_to_send};
+    WebSocketClientMock::respond_to_send = [&](const std::string& message) {
+        respond_to_send(message);
+        NetworkMonitor::StompFrameDecoder decoder{};
+        decoder.Push(message, [&](auto error, auto&& frame) {
+            BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+            if (frame.GetCommand() == StompCommand::Subscribe) {
+                subscription_id = frame.GetHeaderValue(StompHeader::Id);
+                push_message("1");
+                push_message("2");
+            }
+            if (frame.GetCommand() == StompCommand::Ack) {
+                acks.emplace_back(frame.GetHeaderValue(StompHeader::Id));
+            }
+        });
+    };
+
+    boost::asio::steady_timer timer{io_context};
+    const auto wait{[&timer]() -> boost::asio::awaitable<void> {
+        timer.expires_after(std::chrono::milliseconds{20});
+        co_await timer.async_wait(boost::asio::use_awaitable);
+    }};
+    auto session{[&]() -> boost::asio::awaitable<void> {
+        const auto connect_result{
+            co_await stomp_client.AsyncConnect(stomp_username, stomp_password)};
+        BOOST_REQUIRE_EQUAL(connect_result, StompClientError::Ok);
+        auto [subscribe_result, frames]{co_await stomp_client.AsyncSubscribe(
+            stomp_endpoint, NetworkMonitor::StompAckMode::ClientIndividual)};
+        BOOST_REQUIRE_EQUAL(subscribe_result, StompClientError::Ok);
+
+        // The queued frames wait for the consumer to be acknowledged.
+        co_await wait();
+        BOOST_CHECK(acks.empty());
+        const auto frame{co_await frames.Next()};
+        BOOST_REQUIRE(frame);
+        BOOST_CHECK_EQUAL(frame->GetHeaderValue(StompHeader::MessageId), "1");
+        co_await wait();
+        BOOST_CHECK_EQUAL(acks.size(), 1);
+
+        // A dropped stream releases its frames, and queues no more of them.
+        frames = {};
+        push_message("3");
+        co_await wait();
+        stomp_client.Close();
+    }};
+    boost::asio::co_spawn(io_context, session, boost::asio::detached);
+    io_context.run();
+
+    const std::vector<std::string> expected_acks{"a1", "a2", "a3"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(acks.begin(), acks.end(), expected_acks.begin(),
+                                  expected_acks.end());
+    // No frame is left pinned.
+    const auto pool_stats{stomp_client.GetFramePoolStats()};
+    BOOST_CHECK_EQUAL(pool_stats.free_slots, pool_stats.misses);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(ReconnectsAndSubscribesAgain, *timeout(1))
+{
+    NetworkMonitor::StompClientOptions options{};
+    options.reconnect.enabled = true;
+    options.reconnect.initial_delay = std::chrono::milliseconds{1};
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context, options};
+
+    std::string subscription_id{};
+    int connect_frames{0};
+    int subscribe_frames{0};
+    int on_connect_calls{0};
+    int on_subscribe_calls{0};
+    bool on_disconnected_called{false};
+    std::string received_message{};
+
+    // Watch the frames sent to the mocked server, then let it answer them.
+    auto respond_to_send{WebSocketClientMock::respond_to_send};
+    WebSocketClientMock::respond_to_send = [&](const std::string& message) {
+        StompError error{};
+        const StompFrame frame{error, message};
+        BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+        respond_to_send(message);
+
+        if (frame.GetCommand() == StompCommand::Connect) {
+            ++connect_frames;
+        }
+        if (frame.GetCommand() == StompCommand::Subscribe) {
+            ++subscribe_frames;
+            BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::Id), subscription_id);
+        }
+        if (frame.GetCommand() == StompCommand::Subscribe && subscribe_frames == 2) {
+            // The subscription replayed after the reconnection receives messages.
+            WebSocketClientMock::message_queue.push(
+                NetworkMonitor::stomp_frame::MakeMessageFrame(
+                    stomp_endpoint, "1", subscription_id, "", "hello", "", "")
+                    .ToString());
+        }
+    };
+
+    auto on_message_callback{[&](auto result, auto&& message) {
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        // The reconnection went unnoticed.
+        BOOST_CHECK(!on_disconnected_called);
+        received_message = message;
+        stomp_client.Close();
+    }};
+    auto on_subscribe_callback{[&](auto result, auto&&) {
+        ++on_subscribe_calls;
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        // The broker drops the connection.
+        WebSocketClientMock::trigger_disconnection = true;
+    }};
+    auto on_connect_callback{[&](auto result) {
+        ++on_connect_calls;
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        subscription_id = stomp_client.Subscribe(stomp_endpoint, on_subscribe_callback,
+                                                 on_message_callback);
+    }};
+    auto on_disconnected_callback{[&](auto) { on_disconnected_called = true; }};
+
+    stomp_client.Connect(stomp_username, stomp_password, on_connect_callback,
+                         on_disconnected_callback);
+    io_context.run();
+
+    BOOST_CHECK_EQUAL(connect_frames, 2);
+    BOOST_CHECK_EQUAL(subscribe_frames, 2);
+    BOOST_CHECK_EQUAL(on_connect_calls, 1);
+    BOOST_CHECK_EQUAL(on_subscribe_calls, 1);
+    BOOST_CHECK_EQUAL(received_message, "hello");
+    BOOST_CHECK_EQUAL(stomp_client.GetReconnectionsCount(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(GivesUpReconnecting, *timeout(1))
+{
+    NetworkMonitor::StompClientOptions options{};
+    options.reconnect.enabled = true;
+    options.reconnect.initial_delay = std::chrono::milliseconds{1};
+    options.reconnect.max_attempts = 3;
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context, options};
+
+    int on_connect_calls{0};
+    bool on_disconnected_called{false};
+
+    auto on_connect_callback{[&](auto result) {
+        ++on_connect_calls;
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        // The broker drops the connection and stays unreachable.
+        WebSocketClientMock::connect_error_code = boost::asio::error::connection_refused;
+        WebSocketClientMock::trigger_disconnection = true;
+    }};
+    auto on_disconnected_callback{[&](auto result) {
+        on_disconnected_called = true;
+        BOOST_CHECK_EQUAL(result, StompClientError::WebSocketServerDisconnected);
+    }};
+
+    stomp_client.Connect(stomp_username, stomp_password, on_connect_callback,
+                         on_disconnected_callback);
+    io_context.run();
+
+    BOOST_CHECK_EQUAL(on_connect_calls, 1);
+    BOOST_CHECK(on_disconnected_called);
+    BOOST_CHECK_EQUAL(stomp_client.GetReconnectionsCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SendsNegotiatedHeartBeats, *timeout(1))
+{
+    // The server wants a heart-beat every 5 ms, more often than the client offers.
+    WebSocketClientMockForStomp::heart_beat = "0,5";
+    NetworkMonitor::StompClientOptions options{};
+    options.heart_beat.outgoing = std::chrono::milliseconds{1};
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context, options};
+
+    std::string connect_heart_beat{};
+    int heart_beats{0};
+    bool on_disconnected_called{false};
+
+    auto respond_to_send{WebSocketClientMock::respond_to_send};
+    WebSocketClientMock::respond_to_send = [&](const std::string& message) {
+        respond_to_send(message);
+        if (message == "\n") {
+            if (++heart_beats == 3) {
+                stomp_client.Close();
+            }
+            return;
+        }
+        StompError error{};
+        const StompFrame frame{error, message};
+        if (frame.GetCommand() == StompCommand::Connect) {
+            connect_heart_beat = frame.GetHeaderValue(StompHeader::HeartBeat);
+        }
+    };
+
+    const auto start{std::chrono::steady_clock::now()};
+    stomp_client.Connect(stomp_username, stomp_password, nullptr,
+                         [&](auto) { on_disconnected_called = true; });
+    io_context.run();
+
+    BOOST_CHECK_EQUAL(connect_heart_beat, "1,0");
+    BOOST_CHECK_EQUAL(heart_beats, 3);
+    const auto elapsed{std::chrono::steady_clock::now() - start};
+    BOOST_CHECK(elapsed >= std::chrono::milliseconds{15});
+    BOOST_CHECK(!on_disconnected_called);
+}
+
+BOOST_AUTO_TEST_CASE(ConnectOffersHeartBeats, *timeout(1))
+{
+    // Long enough not to fit in the small string buffer.
+    NetworkMonitor::StompClientOptions options{};
+    options.heart_beat.outgoing = std::chrono::milliseconds{123456789};
+    options.heart_beat.incoming = std::chrono::milliseconds{987654321};
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context, options};
+
+    bool on_connected_called{false};
+    stomp_client.Connect(stomp_username, stomp_password, [&](auto result) {
+        on_connected_called = true;
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        stomp_client.Close();
+    });
+    io_context.run();
+
+    BOOST_CHECK(on_connected_called);
+    BOOST_CHECK_EQUAL(WebSocketClientMockForStomp::connect_heart_beat,
+                      "123456789,987654321");
+}
+
+BOOST_AUTO_TEST_CASE(ReconnectsOnMissedHeartBeats, *timeout(1))
+{
+    // The server promises a heart-beat every 5 ms, but never sends one.
+    WebSocketClientMockForStomp::heart_beat = "5,0";
+    NetworkMonitor::StompClientOptions options{};
+    options.reconnect.enabled = true;
+    options.reconnect.initial_delay = std::chrono::milliseconds{1};
+    options.heart_beat.incoming = std::chrono::milliseconds{1};
+    NetworkMonitor::StompClient<WebSocketClientMockForStomp> stomp_client{
+        url, endpoint, port, io_context, tls_context, options};
+
+    int connect_frames{0};
+    int subscribe_frames{0};
+
+    auto respond_to_send{WebSocketClientMock::respond_to_send};
+    WebSocketClientMock::respond_to_send = [&](const std::string& message) {
+        StompError error{};
+        const StompFrame frame{error, message};
+        if (frame.GetCommand() == StompCommand::Connect && ++connect_frames == 2) {
+            // The new connection does not use heart-beats.
+            WebSocketClientMockForStomp::heart_beat = {};
+        }
+        respond_to_send(message);
+        if (frame.GetCommand() == StompCommand::Subscribe && ++subscribe_frames == 2) {
+            stomp_client.Close();
+        }
+    };
+
+    auto on_connect_callback{[&](auto result) {
+        BOOST_CHECK_EQUAL(result, StompClientError::Ok);
+        stomp_client.Subscribe(stomp_endpoint, nullptr, nullptr);
+    }};
+
+    stomp_client.Connect(stomp_username, stomp_password, on_connect_callback);
+    io_context.run();
+
+    BOOST_CHECK_EQUAL(connect_frames, 2);
+    BOOST_CHECK_EQUAL(subscribe_frames, 2);
+    BOOST_CHECK_EQUAL(stomp_client.GetReconnectionsCount(), 1);
+}
+
 /* StompClient::Connect()
  * - on_connected invoked with success
  * - on_connected invoked with failure
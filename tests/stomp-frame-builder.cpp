@@ -1,6 +1,7 @@
 #include <boost/test/unit_test.hpp>
 #include <network-monitor/stomp-frame-builder.hpp>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 using NetworkMonitor::StompCommand;
@@ -92,6 +93,64 @@ BOOST_AUTO_TEST_CASE(InsertsQuotesAtEmptySpecifiedHeaders)
     BOOST_CHECK(frame.ToString().find("passcode:\"\"\n"));
 }
 
+BOOST_AUTO_TEST_CASE(BuildsFromMovedParameters)
+{
+    stomp_frame::BuildParameters parameters(StompCommand::Send);
+    parameters.headers.emplace(StompHeader::Destination, "/queue_a/");
+    parameters.body = "Frame body";
+
+    StompError error_code;
+    auto frame = stomp_frame::Build(error_code, std::move(parameters));
+
+    BOOST_CHECK_EQUAL(error_code, StompError::Ok);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::Send);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::Destination), "/queue_a/");
+    BOOST_CHECK_EQUAL(frame.GetBody(), "Frame body");
+    BOOST_CHECK_EQUAL(frame.ToString(),
+                      "SEND\n"
+                      "destination:/queue_a/\n"
+                      "\n"
+                      "Frame body\0"s);
+}
+
+BOOST_AUTO_TEST_CASE(ReportsMissingRequiredHeader)
+{
+    stomp_frame::BuildParameters parameters(StompCommand::Subscribe);
+    parameters.headers.emplace(StompHeader::Destination, "/queue_a/");
+
+    StompError error_code;
+    auto frame = stomp_frame::Build(error_code, parameters);
+
+    BOOST_CHECK_EQUAL(error_code, StompError::MissingRequiredHeader);
+}
+
+BOOST_AUTO_TEST_CASE(MakesMessageFrame)
+{
+    auto frame = stomp_frame::MakeMessageFrame("/passengers", "42", "sub-0", "", "{}", "2",
+                                               "application/json");
+
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::Message);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::Destination), "/passengers");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::MessageId), "42");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::Subscription), "sub-0");
+    BOOST_CHECK(!frame.HasHeader(StompHeader::Ack));
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::ContentType), "application/json");
+    BOOST_CHECK_EQUAL(frame.GetBody(), "{}");
+}
+
+BOOST_AUTO_TEST_CASE(MakesAckFrame)
+{
+    auto frame = stomp_frame::MakeAckFrame("ack-7");
+
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::Ack);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::Id), "ack-7");
+    BOOST_CHECK_EQUAL(frame.ToString(),
+                      "ACK\n"
+                      "id:ack-7\n"
+                      "\n"
+                      "\0"s);
+}
+
 BOOST_AUTO_TEST_SUITE_END();  // stomp_frame_builder
 
 BOOST_AUTO_TEST_SUITE_END();  // network_monitor
\ No newline at end of file
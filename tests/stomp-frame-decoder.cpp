@@ -0,0 +1,184 @@
+#include <boost/test/unit_test.hpp>
+#include <network-monitor/stomp-frame-decoder.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using NetworkMonitor::StompCommand;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompFrameDecoder;
+using NetworkMonitor::StompHeader;
+
+using namespace std::string_literals;
+
+namespace {
+
+struct DecodedFrame {
+    StompError error{StompError::UndefinedError};
+    StompCommand command{StompCommand::Invalid};
+    std::string body{};
+};
+
+// Collect what the decoder emits. The frames are only valid during the handler.
+struct FrameCollector {
+    void operator()(StompError error, StompFrame&& frame)
+    {
+        (*frames).push_back({error, frame.GetCommand(), std::string{frame.GetBody()}});
+    }
+
+    std::vector<DecodedFrame>* frames;
+};
+
+const auto receipt_frame{
+    "RECEIPT\n"
+    "receipt-id:42\n"
+    "\n"
+    "\0"s};
+
+const auto message_frame{
+    "MESSAGE\n"
+    "destination:/passengers\n"
+    "message-id:007\n"
+    "subscription:0\n"
+    "content-length:8\n"
+    "\n"
+    "with\0nul\0"s};
+
+const auto message_frame_no_length{
+    "MESSAGE\n"
+    "destination:/passengers\n"
+    "message-id:008\n"
+    "subscription:0\n"
+    "\n"
+    "hello\0"s};
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_StompFrameDecoder);
+
+BOOST_AUTO_TEST_CASE(single_frame)
+{
+    std::vector<DecodedFrame> frames{};
+    StompFrameDecoder decoder{};
+
+    decoder.Push(receipt_frame, FrameCollector{&frames});
+
+    BOOST_REQUIRE_EQUAL(frames.size(), 1);
+    BOOST_CHECK_EQUAL(frames[0].error, StompError::Ok);
+    BOOST_CHECK_EQUAL(frames[0].command, StompCommand::Receipt);
+    BOOST_CHECK_EQUAL(decoder.GetPendingSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(batched_frames)
+{
+    std::vector<DecodedFrame> frames{};
+    StompFrameDecoder decoder{};
+
+    decoder.Push(receipt_frame + message_frame + message_frame_no_length,
+                 FrameCollector{&frames});
+
+    BOOST_REQUIRE_EQUAL(frames.size(), 3);
+    BOOST_CHECK_EQUAL(frames[0].command, StompCommand::Receipt);
+    BOOST_CHECK_EQUAL(frames[1].error, StompError::Ok);
+    BOOST_CHECK_EQUAL(frames[1].command, StompCommand::Message);
+    BOOST_CHECK_EQUAL(frames[1].body, "with\0nul"s);
+    BOOST_CHECK_EQUAL(frames[2].error, StompError::Ok);
+    BOOST_CHECK_EQUAL(frames[2].body, "hello");
+    BOOST_CHECK_EQUAL(decoder.GetPendingSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(fragmented_frames)
+{
+    const auto stream{message_frame + receipt_frame + message_frame_no_length};
+
+    // Every chunk size, down to one byte at a time.
+    for (std::size_t chunk_size{1}; chunk_size <= stream.size(); ++chunk_size) {
+        std::vector<DecodedFrame> frames{};
+        StompFrameDecoder decoder{};
+        for (std::size_t offset{0}; offset < stream.size(); offset += chunk_size) {
+            decoder.Push(std::string_view{stream}.substr(offset, chunk_size),
+                         FrameCollector{&frames});
+        }
+
+        BOOST_REQUIRE_EQUAL(frames.size(), 3);
+        BOOST_CHECK_EQUAL(frames[0].error, StompError::Ok);
+        BOOST_CHECK_EQUAL(frames[0].body, "with\0nul"s);
+        BOOST_CHECK_EQUAL(frames[1].error, StompError::Ok);
+        BOOST_CHECK_EQUAL(frames[1].command, StompCommand::Receipt);
+        BOOST_CHECK_EQUAL(frames[2].error, StompError::Ok);
+        BOOST_CHECK_EQUAL(frames[2].body, "hello");
+        BOOST_CHECK_EQUAL(decoder.GetPendingSize(), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(partial_frame)
+{
+    std::vector<DecodedFrame> frames{};
+    StompFrameDecoder decoder{};
+
+    decoder.Push(receipt_frame + message_frame.substr(0, 10), FrameCollector{&frames});
+
+    BOOST_CHECK_EQUAL(frames.size(), 1);
+    BOOST_CHECK_EQUAL(decoder.GetPendingSize(), 10);
+
+    decoder.Reset();
+    BOOST_CHECK_EQUAL(decoder.GetPendingSize(), 0);
+
+    decoder.Push(receipt_frame, FrameCollector{&frames});
+    BOOST_CHECK_EQUAL(frames.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(heart_beats)
+{
+    std::vector<DecodedFrame> frames{};
+    StompFrameDecoder decoder{};
+
+    decoder.Push("\n", FrameCollector{&frames});
+    decoder.Push("\r\n\n" + receipt_frame + "\n\n", FrameCollector{&frames});
+    decoder.Push("\r\n" + receipt_frame, FrameCollector{&frames});
+
+    BOOST_REQUIRE_EQUAL(frames.size(), 2);
+    BOOST_CHECK_EQUAL(frames[0].error, StompError::Ok);
+    BOOST_CHECK_EQUAL(frames[1].error, StompError::Ok);
+    BOOST_CHECK_EQUAL(decoder.GetPendingSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(wrong_content_length)
+{
+    std::vector<DecodedFrame> frames{};
+    StompFrameDecoder decoder{};
+
+    // The length is one byte short: the frame is delimited by its null character.
+    decoder.Push(
+        "SEND\n"
+        "destination:/queue\n"
+        "content-length:4\n"
+        "\n"
+        "hello\0"s +
+            receipt_frame,
+        FrameCollector{&frames});
+
+    BOOST_REQUIRE_EQUAL(frames.size(), 2);
+    BOOST_CHECK_EQUAL(frames[0].error, StompError::ContentLengthsDontMatch);
+    BOOST_CHECK_EQUAL(frames[1].error, StompError::Ok);
+}
+
+BOOST_AUTO_TEST_CASE(malformed_frame)
+{
+    std::vector<DecodedFrame> frames{};
+    StompFrameDecoder decoder{};
+
+    // The null character ends the frame before its headers do.
+    decoder.Push("RECEIPT\nreceipt-id:42\0"s + receipt_frame, FrameCollector{&frames});
+
+    BOOST_REQUIRE_EQUAL(frames.size(), 2);
+    BOOST_CHECK(frames[0].error != StompError::Ok);
+    BOOST_CHECK_EQUAL(frames[1].error, StompError::Ok);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // class_StompFrameDecoder
+
+BOOST_AUTO_TEST_SUITE_END();  // network_monitor
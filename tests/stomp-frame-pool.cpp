@@ -0,0 +1,160 @@
+#include <boost/test/unit_test.hpp>
+#include <network-monitor/stomp-frame-pool.hpp>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using NetworkMonitor::StompCommand;
+using NetworkMonitor::StompError;
+using NetworkMonitor::StompFrame;
+using NetworkMonitor::StompFramePool;
+using NetworkMonitor::StompHeader;
+
+using namespace std::string_literals;
+
+namespace {
+
+const auto message_frame{
+    "MESSAGE\n"
+    "destination:/passengers\n"
+    "message-id:007\n"
+    "subscription:0\n"
+    "\n"
+    "hello\0"s};
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_StompFramePool);
+
+BOOST_AUTO_TEST_CASE(acquire)
+{
+    StompFramePool pool{};
+
+    StompError error{};
+    auto content{message_frame};
+    const auto handle{pool.Acquire(error, content)};
+    // The pooled frame owns a copy of the content.
+    content.assign(content.size(), 'x');
+
+    BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+    BOOST_REQUIRE(handle);
+    BOOST_CHECK_EQUAL(handle->GetCommand(), StompCommand::Message);
+    BOOST_CHECK_EQUAL((*handle).GetHeaderValue(StompHeader::MessageId), "007");
+    BOOST_CHECK_EQUAL(handle->GetBody(), "hello");
+}
+
+BOOST_AUTO_TEST_CASE(acquire_error)
+{
+    StompFramePool pool{};
+
+    StompError error{};
+    const auto handle{pool.Acquire(error, "MESSAGE\n\nhello"s)};
+
+    BOOST_CHECK_EQUAL(error, StompError::MissingClosingNullCharacter);
+    BOOST_CHECK(handle);
+}
+
+BOOST_AUTO_TEST_CASE(acquire_copy_of_frame)
+{
+    StompFramePool pool{};
+
+    StompFramePool::Handle handle{};
+    BOOST_CHECK(!handle);
+    {
+        StompError error{};
+        auto content{message_frame};
+        const StompFrame frame{error, content, StompFrame::borrowed_content};
+        BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+        handle = pool.Acquire(frame);
+        content.assign(content.size(), 'x');
+    }
+
+    BOOST_CHECK_EQUAL(handle->GetHeaderValue(StompHeader::Destination), "/passengers");
+    BOOST_CHECK_EQUAL(handle->GetBody(), "hello");
+}
+
+BOOST_AUTO_TEST_CASE(recycle)
+{
+    StompFramePool pool{};
+    StompError error{};
+
+    {
+        const auto handle{pool.Acquire(error, message_frame)};
+        const auto copy{handle};
+        auto moved{std::move(copy)};
+        BOOST_CHECK_EQUAL(pool.GetStats().free_slots, 0);
+    }
+    BOOST_CHECK_EQUAL(pool.GetStats().free_slots, 1);
+
+    for (int i{0}; i < 10; ++i) {
+        const auto handle{pool.Acquire(error, message_frame)};
+        BOOST_CHECK_EQUAL(handle->GetBody(), "hello");
+    }
+
+    const auto stats{pool.GetStats()};
+    BOOST_CHECK_EQUAL(stats.misses, 1);
+    BOOST_CHECK_EQUAL(stats.hits, 10);
+    BOOST_CHECK_EQUAL(stats.free_slots, 1);
+}
+
+BOOST_AUTO_TEST_CASE(max_free_slots)
+{
+    StompFramePool pool{2};
+    StompError error{};
+
+    {
+        std::vector<StompFramePool::Handle> handles{};
+        for (int i{0}; i < 5; ++i) {
+            handles.push_back(pool.Acquire(error, message_frame));
+        }
+    }
+
+    const auto stats{pool.GetStats()};
+    BOOST_CHECK_EQUAL(stats.misses, 5);
+    BOOST_CHECK_EQUAL(stats.free_slots, 2);
+}
+
+BOOST_AUTO_TEST_CASE(handle_outlives_pool)
+{
+    StompFramePool::Handle handle{};
+    {
+        StompFramePool pool{};
+        StompError error{};
+        handle = pool.Acquire(error, message_frame);
+    }
+    BOOST_CHECK_EQUAL(handle->GetBody(), "hello");
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_release)
+{
+    StompFramePool pool{};
+
+    const int n_threads{4};
+    const int n_handles{1000};
+    std::vector<std::thread> threads{};
+    for (int i{0}; i < n_threads; ++i) {
+        threads.emplace_back([&pool]() {
+            for (int j{0}; j < n_handles; ++j) {
+                StompError thread_error{};
+                auto handle{pool.Acquire(thread_error, message_frame)};
+                auto copy{handle};
+                std::thread releaser{[copy = std::move(copy)]() {}};
+                releaser.join();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto stats{pool.GetStats()};
+    BOOST_CHECK_EQUAL(stats.hits + stats.misses, n_threads * n_handles);
+    BOOST_CHECK(stats.misses <= n_threads);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // class_StompFramePool
+
+BOOST_AUTO_TEST_SUITE_END();  // network_monitor
@@ -1,12 +1,18 @@
 #include <boost/test/unit_test.hpp>
+#include <memory>
 #include <network-monitor/stomp-frame.hpp>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 using NetworkMonitor::StompCommand;
 using NetworkMonitor::StompError;
 using NetworkMonitor::StompFrame;
 using NetworkMonitor::StompHeader;
+using NetworkMonitor::StompHeaders;
 
 using namespace std::string_literals;
 
@@ -167,6 +173,63 @@ BOOST_AUTO_TEST_CASE(ToString)
 
 BOOST_AUTO_TEST_SUITE_END();  // enum_StompError
 
+BOOST_AUTO_TEST_SUITE(class_StompHeaders);
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+    StompHeaders headers{};
+
+    BOOST_CHECK(headers.empty());
+    BOOST_CHECK_EQUAL(headers.size(), 0);
+    BOOST_CHECK(headers.begin() == headers.end());
+    for (const auto& header : stomp_headers) {
+        BOOST_CHECK_EQUAL(headers.count(header), 0);
+    }
+    BOOST_CHECK_THROW(headers.at(StompHeader::Id), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(emplace_keeps_first_value)
+{
+    StompHeaders headers{};
+
+    BOOST_CHECK(headers.emplace(StompHeader::Id, "1"));
+    BOOST_CHECK(!headers.emplace(StompHeader::Id, "2"));
+    BOOST_CHECK_EQUAL(headers.size(), 1);
+    BOOST_CHECK_EQUAL(headers.count(StompHeader::Id), 1);
+    BOOST_CHECK_EQUAL(headers.at(StompHeader::Id), "1");
+}
+
+BOOST_AUTO_TEST_CASE(empty_value)
+{
+    StompHeaders headers{};
+
+    BOOST_CHECK(headers.emplace(StompHeader::Login, ""));
+    BOOST_CHECK_EQUAL(headers.count(StompHeader::Login), 1);
+    BOOST_CHECK_EQUAL(headers.at(StompHeader::Login), "");
+}
+
+BOOST_AUTO_TEST_CASE(iteration_order)
+{
+    StompHeaders headers{};
+    headers.emplace(StompHeader::Version, "1.2");
+    headers.emplace(StompHeader::AcceptVersion, "1.2");
+    headers.emplace(StompHeader::Id, "42");
+
+    std::vector<std::pair<StompHeader, std::string_view>> expected{
+        {StompHeader::AcceptVersion, "1.2"},
+        {StompHeader::Id, "42"},
+        {StompHeader::Version, "1.2"},
+    };
+    std::vector<std::pair<StompHeader, std::string_view>> visited{};
+    for (const auto& [header, value] : headers) {
+        visited.emplace_back(header, value);
+    }
+    BOOST_CHECK_EQUAL(headers.size(), expected.size());
+    BOOST_CHECK(visited == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // class_StompHeaders
+
 BOOST_AUTO_TEST_SUITE(class_StompFrame);
 
 class ExpectedFrame {
@@ -843,6 +906,135 @@ BOOST_AUTO_TEST_CASE(parse_invalid_content_length_value)
     expected.Check(error, frame);
 }
 
+BOOST_AUTO_TEST_CASE(parse_long_header_values)
+{
+    // Values longer than the scanning blocks, with delimiters at block boundaries.
+    const std::string destination(47, 'd');
+    const std::string message_id(31, 'm');
+    std::string plain{"MESSAGE\n"
+                      "destination:" +
+                      destination +
+                      "\n"
+                      "message-id:" +
+                      message_id + ":" + message_id +
+                      "\n"
+                      "subscription:0\n"
+                      "\n" +
+                      std::string(100, 'b') + "\0"s};
+
+    ExpectedFrame expected;
+    expected.SetError(StompError::Ok);
+    expected.SetCommand(StompCommand::Message);
+    expected.AddHeader(StompHeader::Destination, std::string{destination});
+    expected.AddHeader(StompHeader::MessageId, message_id + ":" + message_id);
+    expected.AddHeader(StompHeader::Subscription, "0");
+    expected.SetBody(std::string(100, 'b'));
+
+    StompError error;
+    StompFrame frame{error, std::move(plain)};
+
+    expected.Check(error, frame);
+}
+
+BOOST_AUTO_TEST_CASE(parse_null_in_header_value)
+{
+    std::string plain{
+        "CONNECT\n"
+        "accept-version:42\n"
+        "host:host\0.com\n"
+        "\n"
+        "Frame body\0"s};
+
+    ExpectedFrame expected;
+    expected.SetError(StompError::JunkAfterBody);
+
+    StompError error;
+    StompFrame frame{error, std::move(plain)};
+
+    expected.Check(error, frame);
+}
+
+BOOST_AUTO_TEST_CASE(parse_invalid_command_missing_body_newline)
+{
+    // The missing body newline takes precedence over the invalid command.
+    std::string plain{
+        "CONNECTX\n"
+        "host:host.com\n"
+        "\0"s};
+
+    ExpectedFrame expected;
+    expected.SetError(StompError::MissingBodyNewline);
+
+    StompError error;
+    StompFrame frame{error, std::move(plain)};
+
+    expected.Check(error, frame);
+}
+
+BOOST_AUTO_TEST_CASE(parse_content_length_trailing_characters)
+{
+    std::string plain{
+        "CONNECT\n"
+        "accept-version:42\n"
+        "host:host.com\n"
+        "content-length:10b\n"
+        "\n"
+        "Frame body\0"s};
+
+    ExpectedFrame expected;
+    expected.SetError(StompError::InvalidHeaderValue);
+
+    StompError error;
+    StompFrame frame{error, std::move(plain)};
+
+    expected.Check(error, frame);
+}
+
+BOOST_AUTO_TEST_CASE(parse_borrowed_content)
+{
+    const std::string plain{
+        "MESSAGE\n"
+        "subscription:0\n"
+        "message-id:007\n"
+        "destination:/queue/a\n"
+        "content-length:13\n"
+        "\n"
+        "hello queue a\0"s};
+
+    ExpectedFrame expected;
+    expected.SetError(StompError::Ok);
+    expected.SetCommand(StompCommand::Message);
+    expected.AddHeader(StompHeader::Subscription, "0");
+    expected.AddHeader(StompHeader::MessageId, "007");
+    expected.AddHeader(StompHeader::Destination, "/queue/a");
+    expected.AddHeader(StompHeader::ContentLength, "13");
+    expected.SetBody("hello queue a");
+
+    StompError error;
+    StompFrame frame{error, plain, StompFrame::borrowed_content};
+
+    expected.Check(error, frame);
+
+    // The values point into the borrowed buffer.
+    const auto* buffer_begin{plain.data()};
+    const auto* buffer_end{plain.data() + plain.size()};
+    for (const auto& [header, value] : frame.GetAllHeaders()) {
+        BOOST_CHECK(value.data() >= buffer_begin && value.data() < buffer_end);
+    }
+    BOOST_CHECK(frame.GetBody().data() > buffer_begin &&
+                frame.GetBody().data() < buffer_end);
+}
+
+BOOST_AUTO_TEST_CASE(parse_borrowed_content_error)
+{
+    const std::string_view plain{"MESSAGE\n\nhello queue a"};
+
+    StompError error;
+    StompFrame frame{error, plain, StompFrame::borrowed_content};
+
+    BOOST_CHECK_EQUAL(error, StompError::MissingClosingNullCharacter);
+}
+
 BOOST_AUTO_TEST_CASE(copy_constructor)
 {
     std::string plain{
@@ -947,6 +1139,85 @@ BOOST_AUTO_TEST_CASE(copy_assignment_operator)
     expected.Check(error, other_frame);
 }
 
+BOOST_AUTO_TEST_CASE(copy_points_into_own_content)
+{
+    StompError error;
+    auto parsed_frame{std::make_unique<StompFrame>(error, "ACK\nid:1\n\nbody\0"s)};
+    BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+
+    const auto other_frame{*parsed_frame};
+    BOOST_CHECK(other_frame.GetBody().data() != parsed_frame->GetBody().data());
+    BOOST_CHECK(other_frame.GetHeaderValue(StompHeader::Id).data() !=
+                parsed_frame->GetHeaderValue(StompHeader::Id).data());
+
+    parsed_frame.reset();
+    BOOST_CHECK_EQUAL(other_frame.GetCommand(), StompCommand::Ack);
+    BOOST_CHECK_EQUAL(other_frame.GetHeaderValue(StompHeader::Id), "1");
+    BOOST_CHECK_EQUAL(other_frame.GetBody(), "body");
+}
+
+BOOST_AUTO_TEST_CASE(copy_of_borrowing_frame_borrows)
+{
+    const auto plain{"ACK\nid:1\n\nbody\0"s};
+
+    StompError error;
+    const StompFrame parsed_frame{error, plain, StompFrame::borrowed_content};
+    BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+
+    const auto other_frame{parsed_frame};
+    BOOST_CHECK_EQUAL(other_frame.GetBody().data(), parsed_frame.GetBody().data());
+    BOOST_CHECK_EQUAL(other_frame.GetHeaderValue(StompHeader::Id), "1");
+}
+
+BOOST_AUTO_TEST_CASE(copy_onto_copied_content)
+{
+    auto plain{"MESSAGE\ndestination:/a\nmessage-id:1\nsubscription:2\n\nbody\0"s};
+
+    StompError error;
+    const StompFrame parsed_frame{error, plain, StompFrame::borrowed_content};
+    BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+    const auto viewed{parsed_frame.GetViewedContent()};
+    BOOST_CHECK_EQUAL(viewed, "/a\nmessage-id:1\nsubscription:2\n\nbody");
+
+    const std::string copied_content{viewed};
+    const StompFrame other_frame{parsed_frame, copied_content,
+                                 StompFrame::borrowed_content};
+    plain.assign(plain.size(), 'x');
+    BOOST_CHECK_EQUAL(other_frame.GetCommand(), StompCommand::Message);
+    BOOST_CHECK_EQUAL(other_frame.GetHeaderValue(StompHeader::Destination), "/a");
+    BOOST_CHECK_EQUAL(other_frame.GetHeaderValue(StompHeader::Subscription), "2");
+    BOOST_CHECK_EQUAL(other_frame.GetBody(), "body");
+    BOOST_CHECK_EQUAL(other_frame.GetBody().data(), copied_content.data() + 32);
+}
+
+BOOST_AUTO_TEST_CASE(move_short_frames)
+{
+    // The frames fit in the string small buffer, so moving them moves their content.
+    StompError error;
+    std::vector<StompFrame> frames{};
+    for (int id{0}; id < 100; ++id) {
+        frames.emplace_back(error, "ACK\nid:" + std::to_string(id % 10) + "\n\n\0"s);
+        BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+    }
+    for (int id{0}; id < 100; ++id) {
+        BOOST_CHECK_EQUAL(frames[id].GetHeaderValue(StompHeader::Id),
+                          std::to_string(id % 10));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(moved_from_frame_is_empty)
+{
+    StompError error;
+    StompFrame parsed_frame{error, "ACK\nid:1\n\nbody\0"s};
+    BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+
+    const auto other_frame{std::move(parsed_frame)};
+    BOOST_CHECK_EQUAL(other_frame.GetHeaderValue(StompHeader::Id), "1");
+    BOOST_CHECK_EQUAL(parsed_frame.GetCommand(), StompCommand::Invalid);
+    BOOST_CHECK(parsed_frame.GetAllHeaders().empty());
+    BOOST_CHECK(parsed_frame.GetBody().empty());
+}
+
 
 BOOST_AUTO_TEST_CASE(parse_required_headers)
 {
@@ -1476,6 +1747,93 @@ BOOST_AUTO_TEST_CASE(to_string_method)
     BOOST_CHECK(frame_text.find("destination:/queue/a\n"));
 }
 
+BOOST_AUTO_TEST_CASE(construct_from_parts)
+{
+    StompHeaders headers{};
+    headers.emplace(StompHeader::Destination, "/queue/a");
+    headers.emplace(StompHeader::ContentLength, "13");
+
+    StompError error;
+    const std::string_view body{"hello queue a"};
+    StompFrame frame{error, StompCommand::Send, headers, body};
+
+    BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+    BOOST_CHECK_EQUAL(frame.GetCommand(), StompCommand::Send);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::Destination), "/queue/a");
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::ContentLength), "13");
+    BOOST_CHECK_EQUAL(frame.GetBody(), "hello queue a");
+
+    // The text representation parses back to the same frame.
+    StompFrame parsed{error, frame.ToString()};
+    BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+    BOOST_CHECK_EQUAL(parsed.ToString(), frame.ToString());
+}
+
+BOOST_AUTO_TEST_CASE(construct_from_parts_moved_body)
+{
+    StompHeaders headers{};
+    headers.emplace(StompHeader::Destination, "/queue/a");
+
+    std::string body{"hello queue a"};
+    body.reserve(256);
+
+    StompError error;
+    StompFrame frame{error, StompCommand::Send, headers, std::move(body)};
+
+    BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+    BOOST_CHECK_EQUAL(frame.GetHeaderValue(StompHeader::Destination), "/queue/a");
+    BOOST_CHECK_EQUAL(frame.GetBody(), "hello queue a");
+    BOOST_CHECK_EQUAL(frame.ToString(),
+                      "SEND\n"
+                      "destination:/queue/a\n"
+                      "\n"
+                      "hello queue a\0"s);
+}
+
+BOOST_AUTO_TEST_CASE(construct_from_invalid_parts)
+{
+    const auto check{[](StompCommand command, StompHeader header, std::string_view value,
+                        std::string_view body, StompError expected_error) {
+        StompHeaders headers{};
+        headers.emplace(header, value);
+
+        StompError error;
+        StompFrame frame{error, command, headers, body};
+        BOOST_CHECK_EQUAL(error, expected_error);
+    }};
+
+    check(StompCommand::Invalid, StompHeader::Id, "1", "", StompError::InvalidCommand);
+    check(StompCommand::Ack, StompHeader::Invalid, "1", "", StompError::InvalidHeader);
+    check(StompCommand::Ack, StompHeader::Id, "", "", StompError::EmptyHeaderValue);
+    check(StompCommand::Ack, StompHeader::Id, "1\n2", "", StompError::InvalidHeaderValue);
+    check(StompCommand::Ack, StompHeader::Id, "1", "a\0b"s, StompError::JunkAfterBody);
+    check(StompCommand::Ack, StompHeader::Receipt, "1", "",
+          StompError::MissingRequiredHeader);
+    check(StompCommand::Ack, StompHeader::ContentLength, "3", "ab",
+          StompError::ContentLengthsDontMatch);
+}
+
+BOOST_AUTO_TEST_CASE(serialize_to)
+{
+    const auto plain{
+        "MESSAGE\n"
+        "destination:/queue/a\n"
+        "message-id:007\n"
+        "subscription:0\n"
+        "\n"
+        "hello queue a\0"s};
+
+    StompError error;
+    StompFrame frame{error, plain};
+    BOOST_REQUIRE_EQUAL(error, StompError::Ok);
+
+    BOOST_CHECK_EQUAL(frame.GetSerializedSize(), plain.size());
+
+    std::string output{"prefix"};
+    frame.SerializeTo(output);
+    BOOST_CHECK_EQUAL(output, "prefix" + plain);
+}
+
 // TODO: test what GetHeaderValue returns when HasHeader returns false
 // TODO: test enums' ToString and operator<<
 
@@ -3,8 +3,10 @@
 #include <fstream>
 #include <network-monitor/file-downloader.hpp>
 #include <network-monitor/transport-network.hpp>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 using NetworkMonitor::Id;
 using NetworkMonitor::Line;
@@ -12,6 +14,7 @@ using NetworkMonitor::PassengerEvent;
 using NetworkMonitor::Route;
 using NetworkMonitor::Station;
 using NetworkMonitor::TransportNetwork;
+using NetworkMonitor::TravelRoute;
 
 BOOST_AUTO_TEST_SUITE(network_monitor);
 
@@ -263,6 +266,151 @@ BOOST_AUTO_TEST_CASE(basic)
     BOOST_CHECK_EQUAL(network.GetPassengerCount(station_2.id), -1);
 }
 
+BOOST_AUTO_TEST_CASE(station_handle)
+{
+    TransportNetwork network{};
+    bool ok{false};
+
+    Station station_0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station_1{
+        "station_001",
+        "Station Name 1",
+    };
+    ok = true;
+    ok &= network.AddStation(station_0);
+    ok &= network.AddStation(station_1);
+    BOOST_REQUIRE(ok);
+
+    // Resolve the station once, then record through the handle.
+    const auto handle_0{network.GetStationHandle(station_0.id)};
+    BOOST_REQUIRE(handle_0 != TransportNetwork::invalid_station_handle);
+    BOOST_CHECK(network.GetStationHandle("station_42") ==
+                TransportNetwork::invalid_station_handle);
+
+    using EventType = PassengerEvent::Type;
+    ok = network.RecordPassengerEvent(handle_0, EventType::In);
+    BOOST_REQUIRE(ok);
+    ok = network.RecordPassengerEvent(handle_0, EventType::In);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(handle_0), 2);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_0.id), 2);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_1.id), 0);
+
+    // The handle and ID based methods see the same counters.
+    ok = network.RecordPassengerEvent({station_0.id, EventType::Out});
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(handle_0), 1);
+
+    // Invalid handles are rejected.
+    ok = network.RecordPassengerEvent(TransportNetwork::invalid_station_handle,
+                                      EventType::In);
+    BOOST_CHECK(!ok);
+    BOOST_CHECK_THROW(network.GetPassengerCount(TransportNetwork::invalid_station_handle),
+                      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(batch)
+{
+    TransportNetwork network{};
+    bool ok{false};
+
+    Station station_0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station_1{
+        "station_001",
+        "Station Name 1",
+    };
+    ok = true;
+    ok &= network.AddStation(station_0);
+    ok &= network.AddStation(station_1);
+    BOOST_REQUIRE(ok);
+
+    using EventType = PassengerEvent::Type;
+    const std::vector<PassengerEvent> events{
+        {station_0.id, EventType::In},  {station_0.id, EventType::In},
+        {"station_42", EventType::In},  {station_1.id, EventType::Out},
+        {station_0.id, EventType::Out}, {station_0.id, static_cast<EventType>(42)},
+        {station_1.id, EventType::In},  {station_1.id, EventType::In},
+    };
+    auto report{network.RecordPassengerEvents(events)};
+    BOOST_CHECK_EQUAL(report.n_recorded, 6);
+    BOOST_CHECK(report.rejected == std::vector<std::size_t>({2, 5}));
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_0.id), 1);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_1.id), 1);
+
+    // Interleaved stations, some of them with IDs that only differ at the front.
+    Station station_2{
+        "other___000",
+        "Station Name 2",
+    };
+    ok = network.AddStation(station_2);
+    BOOST_REQUIRE(ok);
+    const std::vector<PassengerEvent> interleaved_events{
+        {station_0.id, EventType::In}, {station_1.id, EventType::In},
+        {station_2.id, EventType::In}, {station_0.id, EventType::In},
+        {"unknown_000", EventType::In}, {station_1.id, EventType::In},
+        {station_2.id, EventType::In}, {station_0.id, EventType::In},
+    };
+    report = network.RecordPassengerEvents(interleaved_events);
+    BOOST_CHECK_EQUAL(report.n_recorded, 7);
+    BOOST_CHECK(report.rejected == std::vector<std::size_t>({4}));
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_0.id), 4);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_1.id), 3);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_2.id), 2);
+
+    // An empty batch records nothing.
+    report = network.RecordPassengerEvents({});
+    BOOST_CHECK_EQUAL(report.n_recorded, 0);
+    BOOST_CHECK(report.rejected.empty());
+}
+
+BOOST_AUTO_TEST_CASE(concurrent)
+{
+    TransportNetwork network{};
+    bool ok{false};
+
+    Station station_0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station_1{
+        "station_001",
+        "Station Name 1",
+    };
+    ok = true;
+    ok &= network.AddStation(station_0);
+    ok &= network.AddStation(station_1);
+    BOOST_REQUIRE(ok);
+
+    // Each thread records the same events. Passengers enter station_0 and leave
+    // station_1.
+    constexpr int n_threads{4};
+    constexpr long long int n_events{10000};
+    std::vector<std::thread> threads{};
+    for (int index = 0; index < n_threads; index++) {
+        threads.emplace_back([&network, &station_0, &station_1]() {
+            using EventType = PassengerEvent::Type;
+            const auto handle_1{network.GetStationHandle(station_1.id)};
+            for (long long int event = 0; event < n_events; event++) {
+                network.RecordPassengerEvent({station_0.id, EventType::In});
+                network.RecordPassengerEvent(handle_1, EventType::Out);
+                network.GetPassengerCount(station_0.id);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_0.id), n_threads * n_events);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_1.id), -(n_threads * n_events));
+}
+
 BOOST_AUTO_TEST_SUITE_END();  // PassengerEvents
 
 BOOST_AUTO_TEST_SUITE(GetRoutesServingStation);
@@ -324,6 +472,57 @@ BOOST_AUTO_TEST_CASE(basic)
     BOOST_CHECK_EQUAL(routes.size(), 0);
 }
 
+BOOST_AUTO_TEST_CASE(loop_route)
+{
+    TransportNetwork network{};
+    bool ok{false};
+
+    // route_0: 0 ---> 1 ---> 0
+    // route_1: 1 ---> 2
+    Station station_0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station_1{
+        "station_001",
+        "Station Name 1",
+    };
+    Station station_2{
+        "station_002",
+        "Station Name 2",
+    };
+    Route route_0{
+        "route_000",   "inbound",     "line_000", "station_000",
+        "station_000", {"station_000", "station_001", "station_000"},
+    };
+    Route route_1{
+        "route_001",   "inbound",     "line_000",
+        "station_001", "station_002", {"station_001", "station_002"},
+    };
+    Line line{
+        "line_000",
+        "Line Name",
+        {route_0, route_1},
+    };
+    ok = true;
+    ok &= network.AddStation(station_0);
+    ok &= network.AddStation(station_1);
+    ok &= network.AddStation(station_2);
+    BOOST_REQUIRE(ok);
+    ok = network.AddLine(line);
+    BOOST_REQUIRE(ok);
+
+    // Each route is listed once.
+    const auto& routes_0{network.GetRoutesServingStation(station_0.id)};
+    BOOST_CHECK(routes_0 == std::vector<Id>({route_0.id}));
+    const auto& routes_1{network.GetRoutesServingStation(station_1.id)};
+    BOOST_CHECK(routes_1 == std::vector<Id>({route_0.id, route_1.id}));
+
+    // The list is not rebuilt on each call.
+    BOOST_CHECK(&network.GetRoutesServingStation(station_1.id) == &routes_1);
+    BOOST_CHECK(network.GetRoutesServingStation("station_42").empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END();  // GetRoutesServingStation
 
 BOOST_AUTO_TEST_SUITE(TravelTime);
@@ -479,8 +678,384 @@ BOOST_AUTO_TEST_CASE(over_route)
         network.GetTravelTime(line.id, route_0.id, station_1.id, station_1.id), 0);
 }
 
+BOOST_AUTO_TEST_CASE(over_route_after_update)
+{
+    TransportNetwork network{};
+    bool ok{false};
+
+    // route_0: 0 ---> 1 ---> 2 ---> 3
+    Route route_0{
+        "route_000",   "inbound",
+        "line_000",    "station_000",
+        "station_003", {"station_000", "station_001", "station_002", "station_003"},
+    };
+    ok = true;
+    for (const auto& stop : route_0.stops) {
+        ok &= network.AddStation({stop, "Station Name"});
+    }
+    ok &= network.AddLine({"line_000", "Line Name", {route_0}});
+    ok &= network.SetTravelTime("station_000", "station_001", 1);
+    ok &= network.SetTravelTime("station_001", "station_002", 2);
+    ok &= network.SetTravelTime("station_002", "station_003", 3);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_000", "station_003"),
+        1 + 2 + 3);
+
+    // Changing a travel time in the middle of the route updates all the journeys
+    // going through it, and only those.
+    ok = network.SetTravelTime("station_002", "station_001", 10);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_000", "station_003"),
+        1 + 10 + 3);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_001", "station_002"), 10);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_000", "station_001"), 1);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_002", "station_003"), 3);
+
+    // Stations that are not on the route.
+    ok = network.AddStation({"station_004", "Station Name"});
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_000", "station_004"), 0);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_000", "station_42"), 0);
+}
+
+BOOST_AUTO_TEST_CASE(over_loop_route)
+{
+    TransportNetwork network{};
+    bool ok{false};
+
+    // route_0: 0 ---> 1 ---> 2 ---> 0 ---> 3
+    Route route_0{
+        "route_000",
+        "inbound",
+        "line_000",
+        "station_000",
+        "station_003",
+        {"station_000", "station_001", "station_002", "station_000", "station_003"},
+    };
+    ok = true;
+    for (const auto& stop : {"station_000", "station_001", "station_002",
+                             "station_003"}) {
+        ok &= network.AddStation({stop, "Station Name"});
+    }
+    ok &= network.AddLine({"line_000", "Line Name", {route_0}});
+    ok &= network.SetTravelTime("station_000", "station_001", 1);
+    ok &= network.SetTravelTime("station_001", "station_002", 2);
+    ok &= network.SetTravelTime("station_002", "station_000", 3);
+    ok &= network.SetTravelTime("station_000", "station_003", 100);
+    BOOST_REQUIRE(ok);
+
+    // Only the stops after the second visit to station_000 are shifted by the last
+    // edge.
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_000", "station_001"), 1);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_000", "station_002"),
+        1 + 2);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_001", "station_000"),
+        2 + 3);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_000", "station_003"),
+        100);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_001", "station_003"),
+        2 + 3 + 100);
+    BOOST_CHECK_EQUAL(
+        network.GetFastestTravelRoute("station_000", "station_001").total_travel_time, 1);
+    BOOST_CHECK_EQUAL(
+        network.GetFastestTravelRoute("station_000", "station_003").total_travel_time,
+        100);
+
+    // Updating the first edge does not shift the stops it does not lead to.
+    ok = network.SetTravelTime("station_000", "station_001", 10);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_000", "station_001"), 10);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_001", "station_003"),
+        2 + 3 + 100);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_000", "station_003"),
+        100);
+}
+
 BOOST_AUTO_TEST_SUITE_END();  // TravelTime
 
+BOOST_AUTO_TEST_SUITE(GetFastestTravelRoute);
+
+// Two lines sharing stations 1 and 3.
+// route_0 (line_000): 0 ---> 1 ---> 2 ---> 3
+// route_1 (line_001):        1 ---> 3
+// Plus a station served by no routes: 4.
+static TransportNetwork MakeTwoLinesNetwork()
+{
+    TransportNetwork network{};
+    bool ok{true};
+    for (const auto& id : {"station_000", "station_001", "station_002", "station_003",
+                           "station_004"}) {
+        ok &= network.AddStation({id, "Station Name"});
+    }
+    BOOST_REQUIRE(ok);
+
+    Route route_0{
+        "route_000",   "inbound",
+        "line_000",    "station_000",
+        "station_003", {"station_000", "station_001", "station_002", "station_003"},
+    };
+    Route route_1{
+        "route_001",   "inbound",     "line_001",
+        "station_001", "station_003", {"station_001", "station_003"},
+    };
+    ok &= network.AddLine({"line_000", "Line Name 0", {route_0}});
+    ok &= network.AddLine({"line_001", "Line Name 1", {route_1}});
+    ok &= network.SetTravelTime("station_000", "station_001", 1);
+    ok &= network.SetTravelTime("station_001", "station_002", 2);
+    ok &= network.SetTravelTime("station_002", "station_003", 2);
+    ok &= network.SetTravelTime("station_001", "station_003", 1);
+    BOOST_REQUIRE(ok);
+    return network;
+}
+
+BOOST_AUTO_TEST_CASE(changes_line_when_faster)
+{
+    const auto network{MakeTwoLinesNetwork()};
+
+    const auto travel_route{network.GetFastestTravelRoute("station_000", "station_003")};
+    BOOST_CHECK_EQUAL(travel_route.start_station_id, "station_000");
+    BOOST_CHECK_EQUAL(travel_route.end_station_id, "station_003");
+    BOOST_CHECK_EQUAL(travel_route.total_travel_time, 1 + 1);
+    BOOST_REQUIRE_EQUAL(travel_route.steps.size(), 2);
+    BOOST_CHECK_EQUAL(travel_route.steps[0].start_station_id, "station_000");
+    BOOST_CHECK_EQUAL(travel_route.steps[0].end_station_id, "station_001");
+    BOOST_CHECK_EQUAL(travel_route.steps[0].line_id, "line_000");
+    BOOST_CHECK_EQUAL(travel_route.steps[0].route_id, "route_000");
+    BOOST_CHECK_EQUAL(travel_route.steps[0].travel_time, 1);
+    BOOST_CHECK_EQUAL(travel_route.steps[1].start_station_id, "station_001");
+    BOOST_CHECK_EQUAL(travel_route.steps[1].end_station_id, "station_003");
+    BOOST_CHECK_EQUAL(travel_route.steps[1].line_id, "line_001");
+    BOOST_CHECK_EQUAL(travel_route.steps[1].route_id, "route_001");
+    BOOST_CHECK_EQUAL(travel_route.steps[1].travel_time, 1);
+}
+
+BOOST_AUTO_TEST_CASE(line_change_penalty)
+{
+    const auto network{MakeTwoLinesNetwork()};
+
+    // Changing line costs more than staying on route_0.
+    const auto travel_route{
+        network.GetFastestTravelRoute("station_000", "station_003", 10)};
+    BOOST_CHECK_EQUAL(travel_route.total_travel_time, 1 + 2 + 2);
+    BOOST_REQUIRE_EQUAL(travel_route.steps.size(), 3);
+    for (const auto& step : travel_route.steps) {
+        BOOST_CHECK_EQUAL(step.route_id, "route_000");
+    }
+
+    // A cheap change is still worth it, and its penalty is part of the total.
+    const auto cheap_change{
+        network.GetFastestTravelRoute("station_000", "station_003", 1)};
+    BOOST_CHECK_EQUAL(cheap_change.total_travel_time, 1 + 1 + 1);
+    BOOST_CHECK_EQUAL(cheap_change.steps.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(no_travel_route)
+{
+    const auto network{MakeTwoLinesNetwork()};
+    TravelRoute travel_route{};
+
+    // Routes only run in one direction.
+    travel_route = network.GetFastestTravelRoute("station_003", "station_000");
+    BOOST_CHECK_EQUAL(travel_route.total_travel_time, 0);
+    BOOST_CHECK(travel_route.steps.empty());
+
+    // No routes serve station 4.
+    travel_route = network.GetFastestTravelRoute("station_000", "station_004");
+    BOOST_CHECK(travel_route.steps.empty());
+
+    // Same station.
+    travel_route = network.GetFastestTravelRoute("station_001", "station_001");
+    BOOST_CHECK_EQUAL(travel_route.start_station_id, "station_001");
+    BOOST_CHECK_EQUAL(travel_route.total_travel_time, 0);
+    BOOST_CHECK(travel_route.steps.empty());
+
+    // Unknown station.
+    travel_route = network.GetFastestTravelRoute("station_000", "station_42");
+    BOOST_CHECK(travel_route.start_station_id.empty());
+    BOOST_CHECK(travel_route.steps.empty());
+}
+
+BOOST_AUTO_TEST_CASE(network_layout)
+{
+    TransportNetwork network{};
+    auto ok{network.FromJson(NetworkMonitor::ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+
+    const auto travel_route{network.GetFastestTravelRoute("station_000", "station_268")};
+    BOOST_REQUIRE(!travel_route.steps.empty());
+    BOOST_CHECK_EQUAL(travel_route.total_travel_time, 34);
+
+    // The steps are chained from start to end and add up to the total.
+    unsigned int total_travel_time{0};
+    Id current_station{travel_route.start_station_id};
+    for (const auto& step : travel_route.steps) {
+        BOOST_REQUIRE_EQUAL(step.start_station_id, current_station);
+        BOOST_CHECK_EQUAL(
+            step.travel_time,
+            network.GetTravelTime(step.start_station_id, step.end_station_id));
+        total_travel_time += step.travel_time;
+        current_station = step.end_station_id;
+    }
+    BOOST_CHECK_EQUAL(current_station, "station_268");
+    BOOST_CHECK_EQUAL(total_travel_time, travel_route.total_travel_time);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // GetFastestTravelRoute
+
+BOOST_AUTO_TEST_SUITE(Copy);
+
+BOOST_AUTO_TEST_CASE(copy_does_not_share_state)
+{
+    TransportNetwork network{};
+    bool ok{false};
+
+    // route_0: 0 ---> 1
+    Station station_0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station_1{
+        "station_001",
+        "Station Name 1",
+    };
+    Route route_0{
+        "route_000",   "inbound",     "line_000",
+        "station_000", "station_001", {"station_000", "station_001"},
+    };
+    Line line{
+        "line_000",
+        "Line Name",
+        {route_0},
+    };
+    ok = true;
+    ok &= network.AddStation(station_0);
+    ok &= network.AddStation(station_1);
+    BOOST_REQUIRE(ok);
+    ok = network.AddLine(line);
+    BOOST_REQUIRE(ok);
+    ok = network.SetTravelTime(station_0.id, station_1.id, 1);
+    BOOST_REQUIRE(ok);
+
+    TransportNetwork copy{network};
+
+    // Changes to the original do not leak into the copy.
+    ok = network.SetTravelTime(station_0.id, station_1.id, 5);
+    BOOST_REQUIRE(ok);
+    ok = network.RecordPassengerEvent({station_0.id, PassengerEvent::Type::In});
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(network.GetTravelTime(station_0.id, station_1.id), 5);
+    BOOST_CHECK_EQUAL(copy.GetTravelTime(station_0.id, station_1.id), 1);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_0.id), 1);
+    BOOST_CHECK_EQUAL(copy.GetPassengerCount(station_0.id), 0);
+}
+
+BOOST_AUTO_TEST_CASE(layout_changes_are_not_shared)
+{
+    TransportNetwork network{};
+    bool ok{false};
+
+    Station station_0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station_1{
+        "station_001",
+        "Station Name 1",
+    };
+    ok = network.AddStation(station_0);
+    BOOST_REQUIRE(ok);
+
+    TransportNetwork copy{network};
+
+    // The copy gets its own layout as soon as it changes it.
+    Route route_0{
+        "route_000",   "inbound",     "line_000",
+        "station_000", "station_001", {"station_000", "station_001"},
+    };
+    Line line{
+        "line_000",
+        "Line Name",
+        {route_0},
+    };
+    ok = copy.AddStation(station_1);
+    BOOST_REQUIRE(ok);
+    ok = copy.AddLine(line);
+    BOOST_REQUIRE(ok);
+    ok = copy.SetTravelTime(station_0.id, station_1.id, 1);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(copy.GetRoutesServingStation(station_0.id).size(), 1);
+    BOOST_CHECK_EQUAL(copy.GetTravelTime(station_0.id, station_1.id), 1);
+
+    BOOST_CHECK(network.GetStationHandle(station_1.id) ==
+                TransportNetwork::invalid_station_handle);
+    BOOST_CHECK(network.GetRoutesServingStation(station_0.id).empty());
+
+    // The original can still grow on its own.
+    ok = network.AddStation(station_1);
+    BOOST_REQUIRE(ok);
+    ok = network.AddLine(line);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(network.GetTravelTime(station_0.id, station_1.id), 0);
+}
+
+BOOST_AUTO_TEST_CASE(moved_network_is_reusable)
+{
+    TransportNetwork network{};
+    bool ok{false};
+
+    Station station_0{
+        "station_000",
+        "Station Name 0",
+    };
+    Station station_1{
+        "station_001",
+        "Station Name 1",
+    };
+    ok = network.AddStation(station_0);
+    BOOST_REQUIRE(ok);
+    ok = network.RecordPassengerEvent({station_0.id, PassengerEvent::Type::In});
+    BOOST_REQUIRE(ok);
+
+    TransportNetwork moved{std::move(network)};
+    BOOST_CHECK_EQUAL(moved.GetPassengerCount(station_0.id), 1);
+
+    // The moved-from network is empty, and grows again on its own.
+    BOOST_CHECK(network.GetStationHandle(station_0.id) ==
+                TransportNetwork::invalid_station_handle);
+    ok = network.AddStation(station_1);
+    BOOST_REQUIRE(ok);
+    ok = network.RecordPassengerEvent({station_1.id, PassengerEvent::Type::In});
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_1.id), 1);
+
+    // Same after a move assignment.
+    TransportNetwork assigned{};
+    assigned = std::move(network);
+    BOOST_CHECK_EQUAL(assigned.GetPassengerCount(station_1.id), 1);
+    ok = network.AddStation(station_0);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(network.GetPassengerCount(station_0.id), 0);
+    BOOST_CHECK(network.GetStationHandle(station_1.id) ==
+                TransportNetwork::invalid_station_handle);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // Copy
+
 BOOST_AUTO_TEST_SUITE(FromJson);
 
 std::vector<Id> GetSortedIds(std::vector<Id>& routes)
@@ -592,6 +1167,334 @@ BOOST_AUTO_TEST_CASE(fail_on_bad_travel_times)
 
 BOOST_AUTO_TEST_SUITE_END();  // FromJson
 
+BOOST_AUTO_TEST_SUITE(FromJsonStream);
+
+BOOST_AUTO_TEST_CASE(from_json_travel_times)
+{
+    auto test_file_path{std::filesystem::path(TESTS_RESOURCES_DIR) /
+                        "from_json_travel_times.json"};
+
+    TransportNetwork network{};
+    auto ok{network.FromJsonFile(test_file_path)};
+    BOOST_REQUIRE(ok);
+
+    BOOST_CHECK_EQUAL(network.GetTravelTime("station_0", "station_1"), 1);
+    BOOST_CHECK_EQUAL(network.GetTravelTime("station_1", "station_0"), 1);
+    BOOST_CHECK_EQUAL(network.GetTravelTime("station_1", "station_2"), 2);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_0", "route_0", "station_0", "station_2"), 1 + 2);
+}
+
+BOOST_AUTO_TEST_CASE(any_section_order)
+{
+    // Travel times first, then stations, then lines.
+    std::istringstream source{R"({
+        "travel_times": [
+            {"start_station_id": "station_0", "end_station_id": "station_1",
+             "travel_time": 3}
+        ],
+        "stations": [
+            {"station_id": "station_0", "name": "Station 0 Name"},
+            {"station_id": "station_1", "name": "Station 1 Name"}
+        ],
+        "lines": [
+            {"line_id": "line_0", "name": "Line 0 Name", "routes": [
+                {"route_id": "route_0", "direction": "inbound",
+                 "route_stops": ["station_0", "station_1"]}
+            ]}
+        ]
+    })"};
+
+    TransportNetwork network{};
+    auto ok{network.FromJsonStream(source)};
+    BOOST_REQUIRE(ok);
+
+    BOOST_CHECK_EQUAL(network.GetTravelTime("station_0", "station_1"), 3);
+    auto routes{network.GetRoutesServingStation("station_0")};
+    BOOST_REQUIRE_EQUAL(routes.size(), 1);
+    BOOST_CHECK_EQUAL(routes[0], "route_0");
+}
+
+BOOST_AUTO_TEST_CASE(same_as_from_json)
+{
+    TransportNetwork expected{};
+    auto ok{expected.FromJson(NetworkMonitor::ParseJsonFile(TESTS_NETWORK_LAYOUT_JSON))};
+    BOOST_REQUIRE(ok);
+
+    TransportNetwork network{};
+    ok = network.FromJsonFile(TESTS_NETWORK_LAYOUT_JSON);
+    BOOST_REQUIRE(ok);
+
+    for (const auto& station : {"station_000", "station_123", "station_268"}) {
+        auto routes{network.GetRoutesServingStation(station)};
+        auto expected_routes{expected.GetRoutesServingStation(station)};
+        BOOST_CHECK(FromJson::GetSortedIds(routes) ==
+                    FromJson::GetSortedIds(expected_routes));
+    }
+    BOOST_CHECK_EQUAL(
+        network.GetFastestTravelRoute("station_000", "station_268").total_travel_time,
+        expected.GetFastestTravelRoute("station_000", "station_268").total_travel_time);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_unknown_station)
+{
+    std::istringstream source{R"({
+        "stations": [{"station_id": "station_0", "name": "Station 0 Name"}],
+        "lines": [
+            {"line_id": "line_0", "name": "Line 0 Name", "routes": [
+                {"route_id": "route_0", "route_stops": ["station_0", "station_1"]}
+            ]}
+        ],
+        "travel_times": []
+    })"};
+
+    TransportNetwork network{};
+    BOOST_CHECK_THROW(network.FromJsonStream(source), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_duplicate_station)
+{
+    std::istringstream source{R"({
+        "stations": [
+            {"station_id": "station_0", "name": "Station 0 Name"},
+            {"station_id": "station_0", "name": "Station 0 Name"}
+        ],
+        "lines": [],
+        "travel_times": []
+    })"};
+
+    TransportNetwork network{};
+    BOOST_CHECK_THROW(network.FromJsonStream(source), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_missing_section)
+{
+    std::istringstream source{R"({"stations": [], "lines": []})"};
+
+    TransportNetwork network{};
+    BOOST_CHECK_THROW(network.FromJsonStream(source), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_bad_json)
+{
+    std::istringstream source{R"({"stations": [)"};
+
+    TransportNetwork network{};
+    BOOST_CHECK_THROW(network.FromJsonStream(source), nlohmann::json::parse_error);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_missing_file)
+{
+    TransportNetwork network{};
+    BOOST_CHECK_THROW(network.FromJsonFile(std::filesystem::path(TESTS_RESOURCES_DIR) /
+                                           "does_not_exist.json"),
+                      std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_bad_travel_times)
+{
+    const auto test_file_path =
+        std::filesystem::path(TESTS_RESOURCES_DIR) / "from_json_bad_travel_times.json";
+
+    TransportNetwork network{};
+    auto ok{network.FromJsonFile(test_file_path)};
+    BOOST_REQUIRE(!ok);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // FromJsonStream
+
+BOOST_AUTO_TEST_SUITE(FromJsonDownload);
+
+BOOST_AUTO_TEST_CASE(parses_and_caches_layout)
+{
+    const auto file_url{"file://" +
+                        std::filesystem::absolute(TESTS_NETWORK_LAYOUT_JSON).string()};
+    const auto cache{std::filesystem::temp_directory_path() /
+                     "network-layout-cache.json"};
+    std::filesystem::remove(cache);
+
+    TransportNetwork expected{};
+    auto ok{expected.FromJsonFile(TESTS_NETWORK_LAYOUT_JSON)};
+    BOOST_REQUIRE(ok);
+
+    NetworkMonitor::FileDownloader downloader{};
+    TransportNetwork network{};
+    ok = network.FromJsonDownload(downloader, file_url, cache);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK(std::filesystem::exists(cache));
+    BOOST_CHECK_EQUAL(std::filesystem::file_size(cache),
+                      std::filesystem::file_size(TESTS_NETWORK_LAYOUT_JSON));
+    BOOST_CHECK_EQUAL(
+        network.GetFastestTravelRoute("station_000", "station_268").total_travel_time,
+        expected.GetFastestTravelRoute("station_000", "station_268").total_travel_time);
+
+    // The layout has not changed: it is loaded from the cache.
+    TransportNetwork cached{};
+    ok = cached.FromJsonDownload(downloader, file_url, cache);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(
+        cached.GetFastestTravelRoute("station_000", "station_268").total_travel_time,
+        expected.GetFastestTravelRoute("station_000", "station_268").total_travel_time);
+
+    // Clean up.
+    std::filesystem::remove(cache);
+}
+
+BOOST_AUTO_TEST_CASE(bad_travel_times)
+{
+    const auto file_url{"file://" + (std::filesystem::absolute(TESTS_RESOURCES_DIR) /
+                                     "from_json_bad_travel_times.json")
+                                        .string()};
+
+    NetworkMonitor::FileDownloader downloader{};
+    TransportNetwork network{};
+    auto ok{network.FromJsonDownload(downloader, file_url)};
+    BOOST_CHECK(!ok);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_missing_file)
+{
+    const auto missing{std::filesystem::temp_directory_path() /
+                       "network-monitor-missing.json"};
+    std::filesystem::remove(missing);
+
+    NetworkMonitor::FileDownloader downloader{};
+    TransportNetwork network{};
+    BOOST_CHECK_THROW(
+        network.FromJsonDownload(downloader, "file://" + missing.string()),
+        std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // FromJsonDownload
+
+BOOST_AUTO_TEST_SUITE(Snapshot);
+
+BOOST_AUTO_TEST_CASE(round_trip)
+{
+    TransportNetwork expected{};
+    auto ok{expected.FromJsonFile(TESTS_NETWORK_LAYOUT_JSON)};
+    BOOST_REQUIRE(ok);
+    ok = expected.RecordPassengerEvent({"station_000", PassengerEvent::Type::In});
+    BOOST_REQUIRE(ok);
+
+    const auto snapshot{std::filesystem::temp_directory_path() /
+                        "network-layout-round-trip.snapshot"};
+    ok = expected.SaveSnapshot(snapshot);
+    BOOST_REQUIRE(ok);
+
+    TransportNetwork network{};
+    ok = network.LoadSnapshot(snapshot);
+    std::filesystem::remove(snapshot);
+    BOOST_REQUIRE(ok);
+
+    for (const auto& station : {"station_000", "station_123", "station_268"}) {
+        auto routes{network.GetRoutesServingStation(station)};
+        auto expected_routes{expected.GetRoutesServingStation(station)};
+        BOOST_CHECK(FromJson::GetSortedIds(routes) ==
+                    FromJson::GetSortedIds(expected_routes));
+    }
+    const auto travel_route{network.GetFastestTravelRoute("station_000", "station_268")};
+    BOOST_CHECK_EQUAL(travel_route.total_travel_time, 34);
+    for (const auto& step : travel_route.steps) {
+        BOOST_CHECK_EQUAL(
+            network.GetTravelTime(step.start_station_id, step.end_station_id),
+            expected.GetTravelTime(step.start_station_id, step.end_station_id));
+        BOOST_CHECK_EQUAL(network.GetTravelTime(step.line_id, step.route_id,
+                                                travel_route.start_station_id,
+                                                step.end_station_id),
+                          expected.GetTravelTime(step.line_id, step.route_id,
+                                                 travel_route.start_station_id,
+                                                 step.end_station_id));
+    }
+
+    // Passenger counts are not part of the snapshot.
+    BOOST_CHECK_EQUAL(network.GetPassengerCount("station_000"), 0);
+}
+
+BOOST_AUTO_TEST_CASE(loop_route)
+{
+    TransportNetwork expected{};
+    bool ok{true};
+    for (const auto& stop : {"station_000", "station_001", "station_002"}) {
+        ok &= expected.AddStation({stop, "Station Name"});
+    }
+    ok &= expected.AddLine({
+        "line_000",
+        "Line Name",
+        {{"route_000",
+          "inbound",
+          "line_000",
+          "station_000",
+          "station_002",
+          {"station_000", "station_001", "station_000", "station_002"}}},
+    });
+    ok &= expected.SetTravelTime("station_000", "station_001", 1);
+    ok &= expected.SetTravelTime("station_000", "station_002", 5);
+    BOOST_REQUIRE(ok);
+
+    const auto snapshot{std::filesystem::temp_directory_path() /
+                        "network-layout-loop-route.snapshot"};
+    ok = expected.SaveSnapshot(snapshot);
+    BOOST_REQUIRE(ok);
+
+    TransportNetwork network{};
+    ok = network.LoadSnapshot(snapshot);
+    std::filesystem::remove(snapshot);
+    BOOST_REQUIRE(ok);
+
+    // The loaded edges still know which stop they leave.
+    ok = network.SetTravelTime("station_000", "station_002", 7);
+    BOOST_REQUIRE(ok);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_000", "station_001"), 1);
+    BOOST_CHECK_EQUAL(
+        network.GetTravelTime("line_000", "route_000", "station_001", "station_002"),
+        1 + 7);
+}
+
+BOOST_AUTO_TEST_CASE(missing_file)
+{
+    TransportNetwork network{};
+    auto ok{network.LoadSnapshot(std::filesystem::path(TESTS_RESOURCES_DIR) /
+                                 "does_not_exist.snapshot")};
+    BOOST_CHECK(!ok);
+}
+
+BOOST_AUTO_TEST_CASE(fail_on_corrupted_file)
+{
+    TransportNetwork saved{};
+    auto ok{saved.FromJsonFile(std::filesystem::path(TESTS_RESOURCES_DIR) /
+                               "from_json_travel_times.json")};
+    BOOST_REQUIRE(ok);
+    const auto snapshot{std::filesystem::temp_directory_path() /
+                        "network-layout-corrupted.snapshot"};
+    ok = saved.SaveSnapshot(snapshot);
+    BOOST_REQUIRE(ok);
+
+    // Flip one byte of the payload.
+    {
+        std::fstream file{snapshot, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekg(-1, std::ios::end);
+        const auto byte{static_cast<char>(file.get())};
+        file.seekp(-1, std::ios::end);
+        file.put(static_cast<char>(byte ^ 0x01));
+    }
+
+    TransportNetwork network{};
+    Station station{"station_42", "Station 42 Name"};
+    ok = network.AddStation(station);
+    BOOST_REQUIRE(ok);
+    ok = network.LoadSnapshot(snapshot);
+    std::filesystem::remove(snapshot);
+    BOOST_CHECK(!ok);
+
+    // The network is left untouched.
+    BOOST_CHECK_EQUAL(network.GetPassengerCount("station_42"), 0);
+    BOOST_CHECK_THROW(network.GetPassengerCount("station_0"), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // Snapshot
+
 BOOST_AUTO_TEST_SUITE_END();  // class_TransportNetwork
 
 BOOST_AUTO_TEST_SUITE_END();  // websocket_client
\ No newline at end of file
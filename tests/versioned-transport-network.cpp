@@ -0,0 +1,169 @@
+#include <atomic>
+#include <boost/test/unit_test.hpp>
+#include <network-monitor/transport-network.hpp>
+#include <network-monitor/versioned-transport-network.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using NetworkMonitor::Line;
+using NetworkMonitor::PassengerEvent;
+using NetworkMonitor::Route;
+using NetworkMonitor::Station;
+using NetworkMonitor::TransportNetwork;
+using NetworkMonitor::VersionedTransportNetwork;
+
+BOOST_AUTO_TEST_SUITE(network_monitor);
+
+BOOST_AUTO_TEST_SUITE(class_VersionedTransportNetwork);
+
+namespace {
+
+// route_0: 0 ---> 1
+TransportNetwork MakeNetwork()
+{
+    TransportNetwork network{};
+    bool ok{true};
+    ok &= network.AddStation({"station_000", "Station Name 0"});
+    ok &= network.AddStation({"station_001", "Station Name 1"});
+    Route route_0{
+        "route_000",   "inbound",     "line_000",
+        "station_000", "station_001", {"station_000", "station_001"},
+    };
+    ok &= network.AddLine({"line_000", "Line Name", {route_0}});
+    ok &= network.SetTravelTime("station_000", "station_001", 1);
+    BOOST_REQUIRE(ok);
+    return network;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(initial_version)
+{
+    VersionedTransportNetwork empty{};
+    BOOST_CHECK_EQUAL(empty.GetSnapshot()->number, 0);
+    BOOST_CHECK(empty.GetSnapshot()->network.GetStationHandle("station_000") ==
+                TransportNetwork::invalid_station_handle);
+
+    VersionedTransportNetwork versions{MakeNetwork()};
+    const auto snapshot{versions.GetSnapshot()};
+    BOOST_CHECK_EQUAL(snapshot->number, 0);
+    BOOST_CHECK_EQUAL(snapshot->network.GetTravelTime("station_000", "station_001"), 1);
+}
+
+BOOST_AUTO_TEST_CASE(publish)
+{
+    VersionedTransportNetwork versions{MakeNetwork()};
+    const auto old_snapshot{versions.GetSnapshot()};
+
+    auto number{versions.Publish([](TransportNetwork& network) {
+        network.SetTravelTime("station_000", "station_001", 5);
+        network.RecordPassengerEvent({"station_000", PassengerEvent::Type::In});
+    })};
+    BOOST_CHECK_EQUAL(number, 1);
+
+    // The new version has the changes.
+    const auto snapshot{versions.GetSnapshot()};
+    BOOST_CHECK_EQUAL(snapshot->number, 1);
+    BOOST_CHECK_EQUAL(snapshot->network.GetTravelTime("station_000", "station_001"), 5);
+    BOOST_CHECK_EQUAL(snapshot->network.GetPassengerCount("station_000"), 1);
+
+    // Readers of the old version do not see them.
+    BOOST_CHECK_EQUAL(old_snapshot->number, 0);
+    BOOST_CHECK_EQUAL(
+        old_snapshot->network.GetTravelTime("station_000", "station_001"), 1);
+    BOOST_CHECK_EQUAL(old_snapshot->network.GetPassengerCount("station_000"), 0);
+}
+
+BOOST_AUTO_TEST_CASE(failed_update)
+{
+    VersionedTransportNetwork versions{MakeNetwork()};
+
+    const auto update{[](TransportNetwork& network) {
+        network.SetTravelTime("station_000", "station_001", 5);
+        throw std::runtime_error("Update failed");
+    }};
+    BOOST_CHECK_THROW(versions.Publish(update), std::runtime_error);
+
+    const auto snapshot{versions.GetSnapshot()};
+    BOOST_CHECK_EQUAL(snapshot->number, 0);
+    BOOST_CHECK_EQUAL(snapshot->network.GetTravelTime("station_000", "station_001"), 1);
+}
+
+BOOST_AUTO_TEST_CASE(publish_spans_chunks)
+{
+    // Enough stations for the passenger counts to span several chunks.
+    TransportNetwork network{};
+    constexpr int n_stations{600};
+    for (int station = 0; station < n_stations; station++) {
+        BOOST_REQUIRE(network.AddStation({"station_" + std::to_string(station), "Name"}));
+    }
+    VersionedTransportNetwork versions{std::move(network)};
+
+    using EventType = PassengerEvent::Type;
+    versions.Publish([](TransportNetwork& network) {
+        network.RecordPassengerEvents({{"station_0", EventType::In},
+                                       {"station_599", EventType::In}});
+    });
+    const auto first_snapshot{versions.GetSnapshot()};
+    versions.Publish([](TransportNetwork& network) {
+        network.RecordPassengerEvent({"station_300", EventType::Out});
+        network.RecordPassengerEvent({"station_599", EventType::In});
+    });
+    const auto second_snapshot{versions.GetSnapshot()};
+
+    BOOST_CHECK_EQUAL(first_snapshot->network.GetPassengerCount("station_0"), 1);
+    BOOST_CHECK_EQUAL(first_snapshot->network.GetPassengerCount("station_300"), 0);
+    BOOST_CHECK_EQUAL(first_snapshot->network.GetPassengerCount("station_599"), 1);
+    BOOST_CHECK_EQUAL(second_snapshot->network.GetPassengerCount("station_0"), 1);
+    BOOST_CHECK_EQUAL(second_snapshot->network.GetPassengerCount("station_300"), -1);
+    BOOST_CHECK_EQUAL(second_snapshot->network.GetPassengerCount("station_599"), 2);
+
+    // A plain copy of a version does not share its counters with the version.
+    auto copy{second_snapshot->network};
+    BOOST_CHECK(copy.RecordPassengerEvent({"station_0", EventType::In}));
+    BOOST_CHECK_EQUAL(copy.GetPassengerCount("station_0"), 2);
+    BOOST_CHECK_EQUAL(second_snapshot->network.GetPassengerCount("station_0"), 1);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_readers)
+{
+    VersionedTransportNetwork versions{MakeNetwork()};
+
+    // Version `n` has a travel time of `n + 1`: readers must never see a version
+    // with another travel time.
+    constexpr unsigned int n_versions{200};
+    std::atomic<bool> done{false};
+    std::atomic<unsigned int> n_inconsistent{0};
+    std::vector<std::thread> readers{};
+    for (int index = 0; index < 3; index++) {
+        readers.emplace_back([&versions, &done, &n_inconsistent]() {
+            while (!done) {
+                const auto snapshot{versions.GetSnapshot()};
+                const auto travel_time{
+                    snapshot->network.GetTravelTime("station_000", "station_001")};
+                if (travel_time != snapshot->number + 1) {
+                    n_inconsistent++;
+                }
+            }
+        });
+    }
+    for (unsigned int version = 1; version <= n_versions; version++) {
+        versions.Publish([version](TransportNetwork& network) {
+            network.SetTravelTime("station_000", "station_001", version + 1);
+        });
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    BOOST_CHECK_EQUAL(n_inconsistent, 0);
+    BOOST_CHECK_EQUAL(versions.GetSnapshot()->number, n_versions);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // class_VersionedTransportNetwork
+
+BOOST_AUTO_TEST_SUITE_END();  // network_monitor
@@ -1,6 +1,7 @@
 #include "websocket-client-mock.hpp"
 
 #include "network-monitor/stomp-frame-builder.hpp"
+#include "network-monitor/stomp-frame-decoder.hpp"
 
 using namespace NetworkMonitor;
 
@@ -14,6 +15,8 @@ inline std::function<void(const std::string&)> WebSocketClientMock::respond_to_s
 inline std::string WebSocketClientMockForStomp::username{};
 inline std::string WebSocketClientMockForStomp::password{};
 inline std::string WebSocketClientMockForStomp::endpoint{};
+inline std::string WebSocketClientMockForStomp::heart_beat{};
+inline std::string WebSocketClientMockForStomp::connect_heart_beat{};
 
 WebSocketClientMock::WebSocketClientMock(const std::string& url,
                                          const std::string& endpoint,
@@ -30,6 +33,7 @@ void WebSocketClientMock::Connect(
     std::function<void(boost::system::error_code, std::string&&)> on_message_callback,
     std::function<void(boost::system::error_code)> on_disconnected_callback)
 {
+    closed_ = false;
     if (connect_error_code.failed()) {
         connected_ = false;
     } else {
@@ -49,6 +53,21 @@ void WebSocketClientMock::Connect(
     }
 }
 
+void WebSocketClientMock::ConnectWithMessageViews(
+    std::function<void(boost::system::error_code)> on_connected_callback,
+    std::function<void(boost::system::error_code, std::string_view)> on_message_callback,
+    std::function<void(boost::system::error_code)> on_disconnected_callback)
+{
+    Connect(std::move(on_connected_callback),
+            [on_message_callback = std::move(on_message_callback)](auto error,
+                                                                   auto&& message) {
+                if (on_message_callback) {
+                    on_message_callback(error, message);
+                }
+            },
+            std::move(on_disconnected_callback));
+}
+
 void WebSocketClientMock::Send(
     const std::string& message,
     std::function<void(boost::system::error_code)> on_sent_callback)
@@ -65,8 +84,9 @@ void WebSocketClientMock::Send(
     boost::asio::post(async_context_, [this, on_sent_callback, message]() {
         if (on_sent_callback) {
             on_sent_callback(send_error_code);
-            respond_to_send(message);
         }
+        // The server answers whether or not the client waits for the send.
+        respond_to_send(message);
     });
 }
 
@@ -75,7 +95,7 @@ void WebSocketClientMock::Close(
 {
     if (connected_) {
         connected_ = false;
-        // TODO: closed_ = true;
+        closed_ = true;
         trigger_disconnection = true;
         boost::asio::post(async_context_, [this, on_close_callback]() {
             if (on_close_callback) {
@@ -96,12 +116,19 @@ const std::string& WebSocketClientMock::GetServerUrl() const
     return server_url_;
 }
 
+boost::asio::strand<boost::asio::io_context::executor_type>
+WebSocketClientMock::GetExecutor() const
+{
+    return async_context_;
+}
+
 void WebSocketClientMock::MockIncomingMessages()
 {
     if (!connected_ || trigger_disconnection) {
         trigger_disconnection = false;
         boost::asio::post(async_context_, [this]() {
-            if (on_disconnected_callback_) {
+            // Like the WebSocketClient, the end of a closed connection is not reported.
+            if (on_disconnected_callback_ && !closed_) {
                 on_disconnected_callback_(boost::asio::error::operation_aborted);
             }
         });
@@ -133,8 +160,18 @@ WebSocketClientMockForStomp::WebSocketClientMockForStomp(
 
 void WebSocketClientMockForStomp::OnMessage(const std::string& message)
 {
-    StompError error;
-    StompFrame frame{error, message};
+    // A message may pack several frames. Heart-beats are skipped by the decoder.
+    StompFrameDecoder decoder{};
+    decoder.Push(message, [this](auto error, auto&& frame) { OnFrame(error, frame); });
+    if (decoder.GetPendingSize() != 0) {
+        // TODO: log
+        trigger_disconnection = true;
+    }
+}
+
+void WebSocketClientMockForStomp::OnFrame(StompError error,
+                                          const NetworkMonitor::StompFrame& frame)
+{
     if (error != StompError::Ok) {
         // TODO: log
         trigger_disconnection = true;
@@ -161,9 +198,11 @@ void WebSocketClientMockForStomp::OnMessage(const std::string& message)
 void WebSocketClientMockForStomp::HandleConnectMessage(
     const NetworkMonitor::StompFrame& frame)
 {
+    connect_heart_beat = frame.GetHeaderValue(StompHeader::HeartBeat);
     if (FrameIsValidConnect(frame)) {
         message_queue.push(
-            stomp_frame::MakeConnectedFrame(stomp_version, {}, {}, {}).ToString());
+            stomp_frame::MakeConnectedFrame(stomp_version, {}, {}, heart_beat)
+                .ToString());
     } else {
         message_queue.push(
             stomp_frame::MakeErrorFrame("Authentication failure", {}).ToString());
@@ -5,6 +5,7 @@
 #include <functional>
 #include <queue>
 #include <string>
+#include <string_view>
 
 #include "network-monitor/stomp-frame.hpp"
 
@@ -32,11 +33,17 @@ class WebSocketClientMock {
         std::function<void(boost::system::error_code)> on_connected_callback,
         std::function<void(boost::system::error_code, std::string&&)> on_message_callback,
         std::function<void(boost::system::error_code)> on_disconnected_callback);
+    void ConnectWithMessageViews(
+        std::function<void(boost::system::error_code)> on_connected_callback,
+        std::function<void(boost::system::error_code, std::string_view)>
+            on_message_callback,
+        std::function<void(boost::system::error_code)> on_disconnected_callback);
     void Send(const std::string& message,
               std::function<void(boost::system::error_code)> on_sent_callback = nullptr);
     void Close(
         std::function<void(boost::system::error_code)> on_close_callback = nullptr);
     const std::string& GetServerUrl() const;
+    boost::asio::strand<boost::asio::io_context::executor_type> GetExecutor() const;
 
    private:
     void MockIncomingMessages();
@@ -45,6 +52,7 @@ class WebSocketClientMock {
     const std::string server_url_;
 
     bool connected_{false};
+    bool closed_{false};
     std::function<void(boost::system::error_code, std::string&&)> on_message_callback_;
     std::function<void(boost::system::error_code)> on_disconnected_callback_;
 };
@@ -65,6 +73,16 @@ class WebSocketClientMockForStomp : public WebSocketClientMock {
      */
     static std::string endpoint;
 
+    /*! \brief `heart_beat` static member is the heart-beat header of the CONNECTED
+     *         frame. The mock never sends heart-beats itself.
+     */
+    static std::string heart_beat;
+
+    /*! \brief `connect_heart_beat` static member is the heart-beat header of the last
+     *         CONNECT frame received, empty if it had none.
+     */
+    static std::string connect_heart_beat;
+
     WebSocketClientMockForStomp(const std::string& url,
                                 const std::string& endpoint,
                                 const std::string& port,
@@ -75,6 +93,8 @@ class WebSocketClientMockForStomp : public WebSocketClientMock {
 
    private:
     void OnMessage(const std::string& message);
+    void OnFrame(NetworkMonitor::StompError error,
+                 const NetworkMonitor::StompFrame& frame);
     void HandleConnectMessage(const NetworkMonitor::StompFrame& frame);
     void HandleSubscribeMessage(const NetworkMonitor::StompFrame& frame);
 
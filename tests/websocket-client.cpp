@@ -6,6 +6,8 @@
 #include <filesystem>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "boost-mock.hpp"
 
@@ -370,6 +372,135 @@ BOOST_AUTO_TEST_CASE(no_handler, *timeout{1})
     BOOST_CHECK(timeout_occured);
 }
 
+BOOST_AUTO_TEST_CASE(message_views, *timeout{1})
+{
+    using WebsocketSocketStream = MockWebSocketStream<MockSslStream<MockTcpStream>>;
+
+    const std::string url{"some.echo-server.com"};
+    const std::string endpoint{"/"};
+    const std::string port{"443"};
+    const std::string expected_message{"Test message"};
+
+    boost::asio::ssl::context tls_context{boost::asio::ssl::context::tlsv12_client};
+    tls_context.load_verify_file(TESTS_CACERT_PEM);
+    boost::asio::io_context io_context{};
+
+    TestWebSocketClient client{url, endpoint, port, io_context, tls_context};
+
+    WebsocketSocketStream::read_buffer = expected_message;
+
+    bool called_on_message{false};
+
+    auto on_message{[&called_on_message, &expected_message, &client](
+                        auto error_code, std::string_view received_message) {
+        called_on_message = true;
+        BOOST_CHECK(!error_code);
+        BOOST_CHECK_EQUAL(expected_message, received_message);
+
+        client.Close();
+    }};
+
+    client.ConnectWithMessageViews(nullptr, on_message);
+    io_context.run();
+
+    BOOST_CHECK(called_on_message);
+}
+
+BOOST_AUTO_TEST_CASE(pooled_messages, *timeout{1})
+{
+    using WebsocketSocketStream = MockWebSocketStream<MockSslStream<MockTcpStream>>;
+
+    const std::string url{"some.echo-server.com"};
+    const std::string endpoint{"/"};
+    const std::string port{"443"};
+    const std::string first_message{"Test message"};
+    const std::string second_message{"Test message 2"};
+
+    boost::asio::ssl::context tls_context{boost::asio::ssl::context::tlsv12_client};
+    tls_context.load_verify_file(TESTS_CACERT_PEM);
+    boost::asio::io_context io_context{};
+
+    TestWebSocketClient client{url, endpoint, port, io_context, tls_context};
+
+    WebsocketSocketStream::read_buffer = first_message;
+
+    std::vector<std::string> received_messages{};
+    NetworkMonitor::MessageBufferPool::Buffer kept_buffer{};
+
+    auto on_message{[&](auto error_code, auto&& received_message) {
+        BOOST_CHECK(!error_code);
+        received_messages.push_back(*received_message);
+        if (received_messages.size() == 1) {
+            // The receiver owns the buffer and can keep it.
+            kept_buffer = std::move(received_message);
+            WebsocketSocketStream::read_buffer = second_message;
+        } else {
+            client.Close();
+        }
+    }};
+
+    client.ConnectWithPooledMessages(nullptr, on_message);
+    io_context.run();
+
+    BOOST_REQUIRE_EQUAL(received_messages.size(), 2);
+    BOOST_CHECK_EQUAL(received_messages[0], first_message);
+    BOOST_CHECK_EQUAL(received_messages[1], second_message);
+    BOOST_CHECK_EQUAL(*kept_buffer, first_message);
+    BOOST_CHECK_EQUAL(client.GetMessagePoolStats().misses, 2);
+    BOOST_CHECK_EQUAL(client.GetMessagePoolStats().free_buffers, 1);
+}
+
+BOOST_AUTO_TEST_CASE(disconnect_and_reconnect, *timeout{1})
+{
+    using WebsocketSocketStream = MockWebSocketStream<MockSslStream<MockTcpStream>>;
+
+    const std::string url{"some.echo-server.com"};
+    const std::string endpoint{"/"};
+    const std::string port{"443"};
+    const std::string expected_message{"Test message"};
+
+    boost::asio::ssl::context tls_context{boost::asio::ssl::context::tlsv12_client};
+    tls_context.load_verify_file(TESTS_CACERT_PEM);
+    boost::asio::io_context io_context{};
+
+    TestWebSocketClient client{url, endpoint, port, io_context, tls_context};
+
+    WebsocketSocketStream::read_error_code = boost::beast::websocket::error::closed;
+
+    int on_connect_calls{0};
+    bool called_on_disconnect{false};
+    bool called_on_message{false};
+
+    auto on_message{[&called_on_message, &expected_message, &client](
+                        auto error_code, auto&& received_message) {
+        called_on_message = true;
+        BOOST_CHECK(!error_code);
+        BOOST_CHECK_EQUAL(expected_message, received_message);
+        client.Close();
+    }};
+    auto on_connect{[&on_connect_calls](auto error_code) {
+        ++on_connect_calls;
+        BOOST_CHECK(!error_code);
+    }};
+    auto on_disconnect{[&](auto error_code) {
+        called_on_disconnect = true;
+        BOOST_CHECK(error_code == boost::beast::websocket::error::closed);
+
+        // The same client connects again, on a new stream.
+        WebsocketSocketStream::read_error_code = {};
+        WebsocketSocketStream::read_buffer = expected_message;
+        client.Connect();
+    }};
+
+    client.Connect(on_connect, on_message, on_disconnect);
+    io_context.run();
+
+    BOOST_CHECK_EQUAL(on_connect_calls, 2);
+    BOOST_CHECK(called_on_disconnect);
+    BOOST_CHECK(called_on_message);
+    BOOST_CHECK(!client.IsTlsSessionReused());
+}
+
 BOOST_AUTO_TEST_SUITE_END();  // onMessage
 
 BOOST_FIXTURE_TEST_SUITE(Send, WebSocketClientTestFixture);
@@ -476,6 +607,176 @@ BOOST_AUTO_TEST_CASE(fail, *timeout{1})
     BOOST_CHECK(called_on_connect);
 }
 
+BOOST_AUTO_TEST_CASE(queued_messages, *timeout{1})
+{
+    const std::string url{"some.echo-server.com"};
+    const std::string endpoint{"/"};
+    const std::string port{"443"};
+
+    boost::asio::ssl::context tls_context{boost::asio::ssl::context::tlsv12_client};
+    tls_context.load_verify_file(TESTS_CACERT_PEM);
+    boost::asio::io_context io_context{};
+
+    TestWebSocketClient client{url, endpoint, port, io_context, tls_context};
+
+    std::vector<int> sent_messages{};
+
+    auto on_connect{[&sent_messages, &client](auto error_code) {
+        BOOST_CHECK(!error_code.failed());
+
+        // The messages are temporaries: the client keeps them until they are sent.
+        for (int index{0}; index < 3; ++index) {
+            client.Send("Message " + std::to_string(index),
+                        [&sent_messages, &client, index](auto error_code) {
+                            BOOST_CHECK(!error_code.failed());
+                            sent_messages.push_back(index);
+                            if (sent_messages.size() == 3) {
+                                client.Close();
+                            }
+                        });
+        }
+
+        const auto stats{client.GetOutboundQueueStats()};
+        BOOST_CHECK_EQUAL(stats.queued_messages, 3);
+        BOOST_CHECK_EQUAL(stats.queued_bytes, 27);
+    }};
+
+    client.Connect(on_connect);
+    io_context.run();
+
+    BOOST_CHECK(sent_messages == std::vector<int>({0, 1, 2}));
+
+    const auto stats{client.GetOutboundQueueStats()};
+    BOOST_CHECK_EQUAL(stats.queued_messages, 0);
+    BOOST_CHECK_EQUAL(stats.queued_bytes, 0);
+    BOOST_CHECK_EQUAL(stats.sent_messages, 3);
+    BOOST_CHECK_EQUAL(stats.coalesced_messages, 0);
+}
+
+BOOST_AUTO_TEST_CASE(coalesced_messages, *timeout{1})
+{
+    const std::string url{"some.echo-server.com"};
+    const std::string endpoint{"/"};
+    const std::string port{"443"};
+
+    boost::asio::ssl::context tls_context{boost::asio::ssl::context::tlsv12_client};
+    tls_context.load_verify_file(TESTS_CACERT_PEM);
+    boost::asio::io_context io_context{};
+
+    NetworkMonitor::WebSocketClientOptions options{};
+    options.outbound_queue.coalesce_limit_bytes = 20;
+    TestWebSocketClient client{url, endpoint, port, io_context, tls_context, options};
+
+    std::vector<int> sent_messages{};
+
+    auto on_connect{[&sent_messages, &client](auto error_code) {
+        BOOST_CHECK(!error_code.failed());
+
+        // The first message is written alone, the next two together, the last one is
+        // too large to be merged with them.
+        for (const auto& message : {"0123456789", "0123456789", "0123456789",
+                                    "0123456789012345678901234"}) {
+            client.Send(message, [&sent_messages, &client](auto error_code) {
+                BOOST_CHECK(!error_code.failed());
+                sent_messages.push_back(0);
+                if (sent_messages.size() == 4) {
+                    client.Close();
+                }
+            });
+        }
+    }};
+
+    client.Connect(on_connect);
+    io_context.run();
+
+    BOOST_CHECK_EQUAL(sent_messages.size(), 4);
+
+    const auto stats{client.GetOutboundQueueStats()};
+    BOOST_CHECK_EQUAL(stats.queued_messages, 0);
+    BOOST_CHECK_EQUAL(stats.sent_messages, 4);
+    BOOST_CHECK_EQUAL(stats.coalesced_messages, 2);
+}
+
+BOOST_AUTO_TEST_CASE(back_pressure, *timeout{1})
+{
+    const std::string url{"some.echo-server.com"};
+    const std::string endpoint{"/"};
+    const std::string port{"443"};
+
+    boost::asio::ssl::context tls_context{boost::asio::ssl::context::tlsv12_client};
+    tls_context.load_verify_file(TESTS_CACERT_PEM);
+    boost::asio::io_context io_context{};
+
+    NetworkMonitor::WebSocketClientOptions options{};
+    options.outbound_queue.high_water_mark_bytes = 16;
+    TestWebSocketClient client{url, endpoint, port, io_context, tls_context, options};
+
+    // Nothing is written before the io_context runs.
+    BOOST_CHECK(client.Send("0123456789"));
+    BOOST_CHECK(!client.Send("0123456789"));
+    BOOST_CHECK_EQUAL(client.GetOutboundQueueStats().queued_bytes, 20);
+
+    io_context.run();
+
+    // The writes fail without a connection, but they leave the queue.
+    BOOST_CHECK_EQUAL(client.GetOutboundQueueStats().queued_bytes, 0);
+    BOOST_CHECK(client.Send("0123456789"));
+}
+
+BOOST_AUTO_TEST_CASE(traffic_stats, *timeout{1})
+{
+    using WebsocketSocketStream = MockWebSocketStream<MockSslStream<MockTcpStream>>;
+
+    const std::string url{"some.echo-server.com"};
+    const std::string endpoint{"/"};
+    const std::string port{"443"};
+    const std::string message_to_send{"Test message"};
+    const std::string message_to_receive{"Received test message"};
+
+    boost::asio::ssl::context tls_context{boost::asio::ssl::context::tlsv12_client};
+    tls_context.load_verify_file(TESTS_CACERT_PEM);
+    boost::asio::io_context io_context{};
+
+    NetworkMonitor::WebSocketClientOptions options{};
+    options.compression.enabled = true;
+    options.compression.client_max_window_bits = 10;
+    options.compression.client_no_context_takeover = true;
+    options.compression.threshold_bytes = 64;
+    TestWebSocketClient client{url, endpoint, port, io_context, tls_context, options};
+
+    WebsocketSocketStream::read_buffer = message_to_receive;
+
+    int pending_events{2};
+    auto on_event{[&pending_events, &client]() {
+        if (--pending_events == 0) {
+            client.Close();
+        }
+    }};
+    auto on_connect{[&client, &message_to_send, &on_event](auto error_code) {
+        BOOST_CHECK(!error_code.failed());
+        client.Send(message_to_send, [&on_event](auto error_code) {
+            BOOST_CHECK(!error_code.failed());
+            on_event();
+        });
+    }};
+    auto on_message{[&on_event](auto error_code, auto&&) {
+        BOOST_CHECK(!error_code.failed());
+        on_event();
+    }};
+
+    client.Connect(on_connect, on_message);
+    io_context.run();
+
+    BOOST_CHECK_EQUAL(pending_events, 0);
+
+    // The mocked TLS stream exchanges nothing on the wire.
+    const auto stats{client.GetTrafficStats()};
+    BOOST_CHECK_EQUAL(stats.sent_message_bytes, message_to_send.size());
+    BOOST_CHECK_EQUAL(stats.received_message_bytes, message_to_receive.size());
+    BOOST_CHECK_EQUAL(stats.sent_wire_bytes, 0);
+    BOOST_CHECK_EQUAL(stats.received_wire_bytes, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();  // Send
 
 BOOST_FIXTURE_TEST_SUITE(Close, WebSocketClientTestFixture);
@@ -568,6 +869,79 @@ BOOST_AUTO_TEST_CASE(close_no_disconnect, *timeout{1})
 
 BOOST_AUTO_TEST_SUITE_END();  // Close
 
+#ifdef NETWORK_MONITOR_COROUTINES
+BOOST_FIXTURE_TEST_SUITE(Coroutines, WebSocketClientTestFixture);
+
+BOOST_AUTO_TEST_CASE(connect_and_receive, *timeout{1})
+{
+    const std::string url{"some.echo-server.com"};
+    const std::string endpoint{"/"};
+    const std::string port{"443"};
+
+    boost::asio::ssl::context tls_context{boost::asio::ssl::context::tlsv12_client};
+    tls_context.load_verify_file(TESTS_CACERT_PEM);
+    boost::asio::io_context io_context{};
+
+    TestWebSocketClient client{url, endpoint, port, io_context, tls_context};
+    using Stream = MockWebSocketStream<MockSslStream<MockTcpStream>>;
+    Stream::read_buffer = "Hello";
+
+    std::vector<std::string> messages{};
+    boost::system::error_code end_error{};
+    auto session{[&]() -> boost::asio::awaitable<void> {
+        const auto connect_error{co_await client.AsyncConnect()};
+        BOOST_REQUIRE(!connect_error);
+
+        auto [first_error, first]{co_await client.AsyncReceive()};
+        BOOST_CHECK(!first_error);
+        messages.emplace_back(first);
+
+        Stream::read_buffer = "World";
+        auto [second_error, second]{co_await client.AsyncReceive()};
+        BOOST_CHECK(!second_error);
+        messages.emplace_back(second);
+
+        client.Close();
+        auto [error, message]{co_await client.AsyncReceive()};
+        end_error = error;
+    }};
+    boost::asio::co_spawn(io_context, session, boost::asio::detached);
+    io_context.run();
+
+    const std::vector<std::string> expected_messages{"Hello", "World"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(messages.begin(), messages.end(),
+                                  expected_messages.begin(), expected_messages.end());
+    BOOST_CHECK(end_error == boost::asio::error::operation_aborted);
+}
+
+BOOST_AUTO_TEST_CASE(fail_connect, *timeout{1})
+{
+    const std::string url{"some.echo-server.com"};
+    const std::string endpoint{"/"};
+    const std::string port{"443"};
+
+    boost::asio::ssl::context tls_context{boost::asio::ssl::context::tlsv12_client};
+    tls_context.load_verify_file(TESTS_CACERT_PEM);
+    boost::asio::io_context io_context{};
+
+    MockSslStream<MockTcpStream>::handshake_error_code =
+        boost::asio::ssl::error::stream_truncated;
+
+    TestWebSocketClient client{url, endpoint, port, io_context, tls_context};
+
+    boost::system::error_code connect_error{};
+    auto session{[&]() -> boost::asio::awaitable<void> {
+        connect_error = co_await client.AsyncConnect();
+    }};
+    boost::asio::co_spawn(io_context, session, boost::asio::detached);
+    io_context.run();
+
+    BOOST_CHECK_EQUAL(connect_error, MockSslStream<MockTcpStream>::handshake_error_code);
+}
+
+BOOST_AUTO_TEST_SUITE_END();  // Coroutines
+#endif
+
 BOOST_AUTO_TEST_SUITE(live);
 
 BOOST_AUTO_TEST_CASE(echo, *timeout{20})